@@ -0,0 +1,193 @@
+/*
+    Cost of the watchdog daemon per supervised client.
+
+    For every client count a fresh ./wd_daemon.out is started on its own
+    table, the clients are slots claimed by this process on behalf of one
+    sleeping child, beaten every BEAT_PERIOD_NS as WDStart clients would.
+    After the daemon discovered them all, it is sampled for MEASURE_SEC:
+        cpu_pct        - daemon CPU over the window
+        ns_per_check   - daemon CPU per client check (one per client interval)
+        rss_kb         - daemon resident set at the end
+        bytes_per_client - resident growth over the empty daemon, per client
+                           (mostly the command line and environment kept for
+                           the restart)
+
+    Run from the directory of wd_daemon.out.
+    usage: ./bench_daemon.out [n1 n2 ...]   (default 100 1000 10000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>     /* fprintf, fopen, fscanf */
+#include <stdlib.h>    /* strtoul */
+#include <stdint.h>    /* uint64_t */
+#include <string.h>    /* strncmp */
+#include <signal.h>    /* kill, SIGTERM, SIGKILL */
+#include <fcntl.h>     /* open, O_WRONLY */
+#include <unistd.h>    /* fork, execl, dup2 */
+#include <time.h>      /* clock_gettime, clock_nanosleep */
+#include <sys/wait.h>  /* waitpid */
+
+#include "wd_common.h"
+#include "wd_table.h"
+
+#define BENCH_TABLE "/wd_daemon_bench"
+#define BEAT_PERIOD_NS (100000000L)
+#define WARMUP_SEC (2)
+#define MEASURE_SEC (5)
+#define CLIENT_INTERVAL_SEC (1)
+#define CLIENT_TOLERANCE (3)
+#define ATTACH_TRIES (200)
+#define NSEC_PER_SEC (1000000000L)
+
+static pid_t Spawn(const char* path, const char* arg)
+{
+    pid_t pid = fork();
+    int null_fd = -1;
+
+    if (0 == pid)
+    {
+        null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        execlp(path, path, arg, (char*)NULL);
+        _exit(1);
+    }
+
+    return pid;
+}
+
+/* ns the process spent on a CPU */
+static uint64_t CpuNs(pid_t pid)
+{
+    char path[BUFFER_LEN];
+    unsigned long long ns = 0;
+    FILE* file = NULL;
+
+    sprintf(path, "/proc/%d/schedstat", pid);
+    file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return 0;
+    }
+    if (1 != fscanf(file, "%llu", &ns))
+    {
+        ns = 0;
+    }
+    fclose(file);
+
+    return ns;
+}
+
+static size_t RssKb(pid_t pid)
+{
+    char path[BUFFER_LEN];
+    char line[256];
+    size_t kb = 0;
+    FILE* file = NULL;
+
+    sprintf(path, "/proc/%d/status", pid);
+    file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return 0;
+    }
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (0 == strncmp(line, "VmRSS:", 6))
+        {
+            sscanf(line + 6, "%lu", &kb);
+        }
+    }
+    fclose(file);
+
+    return kb;
+}
+
+static void Sleep(long ns)
+{
+    struct timespec period = {ns / NSEC_PER_SEC, ns % NSEC_PER_SEC};
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+}
+
+static void BeatFor(table_t* table, const int* slots, size_t n, int seconds)
+{
+    int rounds = (int)(seconds * (NSEC_PER_SEC / BEAT_PERIOD_NS));
+    size_t i = 0;
+
+    while (rounds-- > 0)
+    {
+        for (i = 0; i < n; ++i)
+        {
+            TableBeat(table, slots[i]);
+        }
+        Sleep(BEAT_PERIOD_NS);
+    }
+}
+
+static void BenchClients(size_t n)
+{
+    pid_t sleeper = Spawn("sleep", "1000");
+    pid_t daemon = Spawn(DAEMON_PROCESS, BENCH_TABLE);
+    int* slots = (int*)malloc(n * sizeof(int));
+    uint32_t generation = 0;
+    table_t* table = NULL;
+    size_t rss_empty = 0;
+    size_t rss = 0;
+    uint64_t cpu = 0;
+    size_t i = 0;
+    int tries = 0;
+
+    for (tries = 0; NULL == table && tries < ATTACH_TRIES; ++tries)
+    {
+        Sleep(NSEC_PER_SEC / 100);
+        table = TableOpen(BENCH_TABLE, FALSE);
+    }
+
+    if (NULL == table || NULL == slots)
+    {
+        fprintf(stderr, "failed to attach to %s\n", DAEMON_PROCESS);
+        kill(daemon, SIGKILL);
+        kill(sleeper, SIGKILL);
+        free(slots);
+        return;
+    }
+
+    Sleep(NSEC_PER_SEC / 2);
+    rss_empty = RssKb(daemon);
+
+    for (i = 0; i < n; ++i)
+    {
+        slots[i] = TableClaim(table, sleeper, (uint64_t)CLIENT_INTERVAL_SEC * NSEC_PER_SEC, CLIENT_TOLERANCE, &generation);
+    }
+
+    BeatFor(table, slots, n, WARMUP_SEC);
+    cpu = CpuNs(daemon);
+    BeatFor(table, slots, n, MEASURE_SEC);
+    cpu = CpuNs(daemon) - cpu;
+    rss = RssKb(daemon);
+
+    fprintf(stderr, "daemon clients=%lu cpu_pct=%.3f ns_per_check=%.1f rss_kb=%lu bytes_per_client=%.1f\n",
+            n, 100.0 * cpu / ((double)MEASURE_SEC * NSEC_PER_SEC),
+            (double)cpu / (n * (MEASURE_SEC / CLIENT_INTERVAL_SEC)), rss,
+            (rss > rss_empty) ? 1024.0 * (rss - rss_empty) / n : 0.0);
+
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+    kill(sleeper, SIGKILL);
+    waitpid(sleeper, NULL, 0);
+    TableClose(table, NULL);
+    free(slots);
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {100, 1000, 10000};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t i = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        BenchClients((argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i]);
+    }
+
+    return 0;
+}
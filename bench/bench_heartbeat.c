@@ -0,0 +1,227 @@
+/*
+    Per-heartbeat cost of the ping transports between two processes.
+
+    signal   - kill(SIGUSR1) to a child blocked in read(), HandleSignal wakes
+               the eventfd CheckPingResponse waits on
+    shm      - HeartbeatBeat into the shared region while the child is blocked
+               in read() and never looks, a check is a plain load
+    shm-wait - HeartbeatBeat while the child is parked in HeartbeatWait, every
+               beat also pays the futex wake
+
+    The sender paces beats PERIOD_NS apart, as a watchdog would, only faster.
+        send_ns     - sender wall time inside the send call
+        recv_cpu_ns - receiver CPU time per beat it saw
+        seen        - beats the receiver noticed (signals coalesce)
+        interrupted - receiver syscalls broken by EINTR
+    beat_and_check_ns is a HeartbeatBeat plus a HeartbeatWait that finds it.
+
+    usage: ./bench_heartbeat.out [beats]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>        /* fprintf, sprintf */
+#include <stdlib.h>       /* atoi */
+#include <stdint.h>       /* uint64_t */
+#include <signal.h>       /* sigaction, kill, SIGUSR1 */
+#include <errno.h>        /* errno, EINTR */
+#include <unistd.h>       /* fork, pipe, read, write */
+#include <time.h>         /* clock_gettime, clock_nanosleep */
+#include <sys/resource.h> /* struct rusage */
+#include <sys/wait.h>     /* wait4 */
+
+#include "wd_common.h"
+#include "wd_heartbeat.h"
+
+#define DEFAULT_BEATS (20000)
+#define PERIOD_NS (50000L)
+#define CHECKS (1000000)
+#define SETTLE_NS (10000000L)
+#define NSEC_PER_SEC (1000000000L)
+#define REGION_NAME "/wd_heartbeat_bench_%d"
+
+typedef enum transport
+{
+    TRANSPORT_SIGNAL,
+    TRANSPORT_SHM,
+    TRANSPORT_SHM_WAIT
+} transport_t;
+
+typedef struct receiver_result
+{
+    uint64_t seen;
+    uint64_t interrupted;
+} receiver_result_t;
+
+static const char* transport_names[] = {"signal", "shm", "shm-wait"};
+static volatile sig_atomic_t handled = 0;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t RusageNs(const struct rusage* usage)
+{
+    return (uint64_t)(usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * NSEC_PER_SEC +
+           (uint64_t)(usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) * 1000;
+}
+
+static void CountSignal(int sig)
+{
+    ++handled;
+    HandleSignal(sig);
+}
+
+static void Receiver(transport_t transport, heartbeat_t* heartbeat, int beats, int block_fd, int result_fd)
+{
+    receiver_result_t result = {0};
+    uint32_t seen = 0;
+    char byte = 0;
+
+    if (TRANSPORT_SHM_WAIT == transport)
+    {
+        while ((uint32_t)beats != seen && HeartbeatWait(heartbeat, HEARTBEAT_USER, &seen, 1))
+        {
+        }
+    }
+    else
+    {
+        while (0 != read(block_fd, &byte, 1))
+        {
+            result.interrupted += (EINTR == errno);
+        }
+    }
+
+    /* a zero interval check only reads the counter */
+    HeartbeatWait(heartbeat, HEARTBEAT_USER, &seen, 0);
+    result.seen = (TRANSPORT_SIGNAL == transport) ? (uint64_t)handled : seen;
+
+    _exit(sizeof(result) == write(result_fd, &result, sizeof(result)) ? 0 : 1);
+}
+
+static void RunTransport(transport_t transport, heartbeat_t* heartbeat, int beats)
+{
+    receiver_result_t result = {0};
+    struct rusage usage = {0};
+    struct timespec next = {0};
+    int block_fds[2];
+    int result_fds[2];
+    uint64_t send_ns = 0;
+    uint64_t start = 0;
+    pid_t child = 0;
+    int status = 0;
+    int i = 0;
+
+    if (0 != pipe(block_fds) || 0 != pipe(result_fds))
+    {
+        return;
+    }
+
+    child = fork();
+    if (0 == child)
+    {
+        close(block_fds[1]);
+        close(result_fds[0]);
+        Receiver(transport, heartbeat, beats, block_fds[0], result_fds[1]);
+    }
+    close(block_fds[0]);
+    close(result_fds[1]);
+
+    /* let the child park before the first beat */
+    next.tv_nsec = SETTLE_NS;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &next, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (i = 0; i < beats; ++i)
+    {
+        next.tv_nsec += PERIOD_NS;
+        if (next.tv_nsec >= NSEC_PER_SEC)
+        {
+            next.tv_nsec -= NSEC_PER_SEC;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        start = NowNs();
+        if (TRANSPORT_SIGNAL == transport)
+        {
+            kill(child, SIGUSR1);
+        }
+        else
+        {
+            HeartbeatBeat(heartbeat, HEARTBEAT_USER);
+        }
+        send_ns += NowNs() - start;
+    }
+
+    close(block_fds[1]);
+    if (sizeof(result) != read(result_fds[0], &result, sizeof(result)))
+    {
+        result.seen = 0;
+    }
+    close(result_fds[0]);
+    wait4(child, &status, 0, &usage);
+
+    fprintf(stderr, "%-10s beats=%d send_ns=%.1f recv_cpu_ns=%.1f seen=%lu interrupted=%lu\n",
+            transport_names[transport], beats, (double)send_ns / beats,
+            (0 == result.seen) ? 0.0 : (double)RusageNs(&usage) / result.seen,
+            result.seen, result.interrupted);
+}
+
+static void RunCheck(heartbeat_t* heartbeat)
+{
+    uint32_t seen = 0;
+    uint64_t start = 0;
+    int i = 0;
+
+    HeartbeatWait(heartbeat, HEARTBEAT_WATCHDOG, &seen, 0);
+
+    start = NowNs();
+    for (i = 0; i < CHECKS; ++i)
+    {
+        HeartbeatBeat(heartbeat, HEARTBEAT_WATCHDOG);
+        HeartbeatWait(heartbeat, HEARTBEAT_WATCHDOG, &seen, 0);
+    }
+    fprintf(stderr, "%-10s checks=%d beat_and_check_ns=%.1f\n", "shm", CHECKS, (double)(NowNs() - start) / CHECKS);
+}
+
+int main(int argc, char** argv)
+{
+    int beats = (argc > 1) ? atoi(argv[1]) : DEFAULT_BEATS;
+    char name[BUFFER_LEN];
+    heartbeat_t* heartbeat = NULL;
+    transport_t transport = TRANSPORT_SIGNAL;
+    struct sigaction action = {0};
+
+    sprintf(name, REGION_NAME, getpid());
+    heartbeat = HeartbeatOpen(name, TRUE);
+    if (SUCCESS != SetupPingEvent() || NULL == heartbeat)
+    {
+        fprintf(stderr, "failed to setup ping event or heartbeat region\n");
+        return 1;
+    }
+
+    /* inherited by the receivers, no SA_RESTART - every ping breaks the read like in the application */
+    action.sa_handler = CountSignal;
+    sigaction(SIGUSR1, &action, NULL);
+
+    for (transport = TRANSPORT_SIGNAL; transport <= TRANSPORT_SHM_WAIT; ++transport)
+    {
+        /* fresh counters - shm-wait stops at the beat count */
+        HeartbeatClose(heartbeat, name);
+        heartbeat = HeartbeatOpen(name, TRUE);
+        if (NULL == heartbeat)
+        {
+            return 1;
+        }
+        RunTransport(transport, heartbeat, beats);
+    }
+    RunCheck(heartbeat);
+
+    HeartbeatClose(heartbeat, name);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+    Cost of a hot-path log call, the flight log against stdio.
+
+    off     - WD_LOG below the level, the one compare
+    ring    - WD_LOG into the ring of the thread
+    printf  - the printf the monitor tasks made before, into a pipe a reader
+              drains - a terminal or a full pipe only make it slower
+        ns_per_call - mean over the calls
+
+    usage: ./bench_log.out [calls]   (default 1000000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>    /* printf, fprintf, sprintf */
+#include <stdlib.h>   /* atoi, mkdtemp */
+#include <stdint.h>   /* uint64_t */
+#include <unistd.h>   /* pipe, dup2, fork, read */
+#include <time.h>     /* clock_gettime */
+#include <sys/wait.h> /* waitpid */
+
+#include "wd_common.h"
+#include "wd_log.h"
+
+#define DEFAULT_CALLS (1000000)
+#define NSEC_PER_SEC (1000000000L)
+#define DRAIN_LEN (4096)
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static void Report(const char* mode, uint64_t ns, int calls)
+{
+    fprintf(stderr, "log mode=%s calls=%d ns_per_call=%.1f\n", mode, calls, (double)ns / calls);
+}
+
+static uint64_t RunLog(int calls)
+{
+    uint64_t start = NowNs();
+    int i = 0;
+
+    for (i = 0; i < calls; ++i)
+    {
+        WD_LOG(LOG_DEBUG, LOG_WINDOW_MISSED, i, 0);
+    }
+
+    return NowNs() - start;
+}
+
+static uint64_t RunPrintf(int calls)
+{
+    char drain[DRAIN_LEN];
+    uint64_t start = 0;
+    int fds[2] = {-1, -1};
+    pid_t reader = 0;
+    int i = 0;
+
+    if (0 != pipe(fds))
+    {
+        return 0;
+    }
+
+    reader = fork();
+    if (0 == reader)
+    {
+        close(fds[1]);
+        while (0 < read(fds[0], drain, sizeof(drain)))
+        {
+        }
+        _exit(0);
+    }
+    close(fds[0]);
+    fflush(stdout);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+
+    start = NowNs();
+    for (i = 0; i < calls; ++i)
+    {
+        printf("[%s] No response from %s. Remaining tolerance: %d\n", "User", "User", i);
+    }
+    fflush(stdout);
+    start = NowNs() - start;
+
+    close(STDOUT_FILENO);
+    waitpid(reader, NULL, 0);
+
+    return start;
+}
+
+int main(int argc, char** argv)
+{
+    int calls = (argc > 1) ? atoi(argv[1]) : DEFAULT_CALLS;
+    char dir[] = "/tmp/bench_log_XXXXXX";
+    char prefix[sizeof(dir) + sizeof("/log")];
+
+    if (calls <= 0)
+    {
+        calls = DEFAULT_CALLS;
+    }
+
+    Report("off", RunLog(calls), calls);
+
+    if (NULL == mkdtemp(dir))
+    {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    sprintf(prefix, "%s/log", dir);
+    if (SUCCESS != LogOpen(prefix, FALSE, LOG_DEBUG))
+    {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    fprintf(stderr, "log in %s\n", dir);
+    Report("ring", RunLog(calls), calls);
+
+    Report("printf", RunPrintf(calls), calls);
+
+    return 0;
+}
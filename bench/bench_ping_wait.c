@@ -0,0 +1,136 @@
+/*
+    Idle CPU of a watched process while it waits for pings.
+    Compares the legacy busy-wait check loop with CheckPingResponse.
+
+    usage: ./bench_ping_wait.out [checks]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>     /* printf */
+#include <stdlib.h>    /* atoi */
+#include <signal.h>    /* sigaction, kill, SIGUSR1 */
+#include <pthread.h>   /* pthread_create, pthread_join */
+#include <stdatomic.h> /* atomic_int */
+#include <unistd.h>    /* getpid */
+#include <time.h>      /* clock_gettime, clock_nanosleep */
+
+#include "wd_common.h"
+
+#define DEFAULT_CHECKS (5)
+#define INTERVAL (1)
+#define PING_PERIOD_NS (900000000L)
+#define NSEC_PER_SEC (1000000000L)
+
+typedef int (*check_func_t)(void* args);
+
+static atomic_int legacy_flag = FALSE;
+static atomic_int pinger_running = FALSE;
+
+static void LegacyHandleSignal(int sig)
+{
+    (void)sig;
+    atomic_store(&legacy_flag, TRUE);
+}
+
+/* the check loop as it was before the blocking wait */
+static int LegacyCheckPingResponse(void* args)
+{
+    watchdog_data_t* data = (watchdog_data_t*)args;
+    time_t start = time(NULL);
+    int tolerance = data->tolerance;
+
+    do
+    {
+        if (TRUE == legacy_flag)
+        {
+            atomic_store(&legacy_flag, FALSE);
+            break;
+        }
+        else if (difftime(time(NULL), start) >= (double)data->interval)
+        {
+            --tolerance;
+            start = time(NULL);
+        }
+    } while (tolerance > 0);
+
+    return CONTINUE;
+}
+
+static void* Pinger(void* args)
+{
+    struct timespec period = {0, PING_PERIOD_NS};
+    sigset_t mask;
+
+    (void)args;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+    while (atomic_load(&pinger_running))
+    {
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+        kill(getpid(), SIGUSR1);
+    }
+
+    return NULL;
+}
+
+static double ElapsedSec(const struct timespec* start, const struct timespec* end)
+{
+    return (double)(end->tv_sec - start->tv_sec) +
+           (double)(end->tv_nsec - start->tv_nsec) / NSEC_PER_SEC;
+}
+
+static void RunMode(const char* name, check_func_t check, void (*handler)(int), int checks)
+{
+    watchdog_data_t data = {0};
+    struct sigaction action = {0};
+    struct timespec wall_start, wall_end, cpu_start, cpu_end;
+    pthread_t pinger;
+    double wall = 0;
+    double cpu = 0;
+    int i = 0;
+
+    data.scheduler = SchedulerCreate();
+    data.interval = INTERVAL;
+    data.tolerance = 3;
+
+    action.sa_handler = handler;
+    sigaction(SIGUSR1, &action, NULL);
+
+    atomic_store(&pinger_running, TRUE);
+    pthread_create(&pinger, NULL, Pinger, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+    for (i = 0; i < checks; ++i)
+    {
+        check(&data);
+    }
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_end);
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+
+    atomic_store(&pinger_running, FALSE);
+    pthread_join(pinger, NULL);
+    SchedulerDestroy(data.scheduler);
+
+    wall = ElapsedSec(&wall_start, &wall_end);
+    cpu = ElapsedSec(&cpu_start, &cpu_end);
+    fprintf(stderr, "%-12s checks=%d wall_s=%.3f cpu_s=%.3f cpu_pct=%.2f\n",
+            name, checks, wall, cpu, 100.0 * cpu / wall);
+}
+
+int main(int argc, char** argv)
+{
+    int checks = (argc > 1) ? atoi(argv[1]) : DEFAULT_CHECKS;
+
+    if (SUCCESS != SetupPingEvent())
+    {
+        fprintf(stderr, "failed to setup ping event\n");
+        return 1;
+    }
+
+    RunMode("busy-wait", LegacyCheckPingResponse, LegacyHandleSignal, checks);
+    RunMode("blocking", CheckPingResponse, HandleSignal, checks);
+
+    return 0;
+}
@@ -0,0 +1,558 @@
+/*
+    Failure detection and recovery of the watchdog pair, end to end.
+
+    Every run starts ./user_wd.out in its own process group, waits until both
+    sides beat, waits a random part of an interval (so failures land at any
+    phase of the ping cycle) and injects one fault into one process:
+        kill - SIGKILL
+        stop - SIGSTOP, a hang that uses no CPU
+        busy - every thread of the process spins in place, a hang that burns
+               CPU and still looks alive to the kernel (ptrace, x86-64 only)
+    target user is user_wd.out, target wd is its active wd_process.out.
+    Measured from the injection:
+        detect_ms - until the other side acted on it: the user process reaped
+                    the old watchdog, or the watchdog exec'd the user process
+        resume_ms - until heartbeats flow both ways again, taken from the
+                    beat timestamps in the shared-memory region
+    A run that is not detected within DETECT_LIMIT_SEC counts as missed.
+
+    The pair runs with the environment of this process - WD_INTERVAL and
+    WD_TOLERANCE set the demo's interval and tolerance, WD_STANDBY_ENV a
+    warm standby. Needs the shared-memory transport (the default).
+
+    Run from the directory of user_wd.out and wd_process.out.
+    usage: ./bench_recovery.out [runs] [kill|stop|busy|all] [user|wd|all]
+           (default 5 all all)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>        /* fprintf, sprintf, fopen */
+#include <stdlib.h>       /* atoi, getenv, qsort, rand_r */
+#include <stdint.h>       /* uint64_t */
+#include <string.h>       /* strcmp, strrchr, memchr */
+#include <signal.h>       /* kill, SIGKILL, SIGSTOP */
+#include <fcntl.h>        /* open, O_RDONLY, O_WRONLY */
+#include <unistd.h>       /* fork, execl, setpgid, pread */
+#include <dirent.h>       /* opendir, readdir */
+#include <time.h>         /* clock_gettime, clock_nanosleep */
+#include <sys/stat.h>     /* stat */
+#include <sys/prctl.h>    /* prctl, PR_SET_CHILD_SUBREAPER */
+#include <sys/ptrace.h>   /* ptrace */
+#include <sys/user.h>     /* struct user_regs_struct */
+#include <sys/wait.h>     /* waitpid, __WALL */
+#include <sys/mman.h>     /* shm_unlink */
+
+#include "wd_common.h"
+#include "wd_heartbeat.h"
+
+#define DEFAULT_RUNS (5)
+#define DEFAULT_INTERVAL_SEC (1)
+#define DETECT_LIMIT_SEC (60)
+#define START_LIMIT_SEC (10)
+#define POLL_NS (1000000L)
+#define NSEC_PER_SEC (1000000000L)
+#define NSEC_PER_MSEC (1000000.0)
+#define PATH_LEN (64)
+#define LINE_LEN (512)
+#define SCAN_CHUNK (65536)
+#define RUN_SEED (42)
+
+typedef enum fault
+{
+    FAULT_KILL = 0,
+    FAULT_STOP,
+    FAULT_BUSY,
+    FAULTS
+} fault_t;
+
+typedef enum target
+{
+    TARGET_USER = 0,
+    TARGET_WD,
+    TARGETS
+} target_t;
+
+static const char* fault_names[FAULTS] = {"kill", "stop", "busy"};
+static const char* target_names[TARGETS] = {"user", "wd"};
+static unsigned int seed = RUN_SEED;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static void Sleep(long ns)
+{
+    struct timespec period = {ns / NSEC_PER_SEC, ns % NSEC_PER_SEC};
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+}
+
+static size_t IntervalSec(void)
+{
+    char* interval = getenv("WD_INTERVAL");
+
+    return (NULL != interval && 0 < atoi(interval)) ? (size_t)atoi(interval) : DEFAULT_INTERVAL_SEC;
+}
+
+/* comm, parent and thread count from /proc/<pid>/stat. FAIL if pid is gone */
+static int ReadStat(pid_t pid, char* comm, pid_t* ppid, long* threads)
+{
+    char path[PATH_LEN];
+    char line[LINE_LEN];
+    char* end = NULL;
+    char* open_paren = NULL;
+    FILE* file = NULL;
+    char state = 0;
+    int fields = 0;
+
+    sprintf(path, "/proc/%d/stat", pid);
+    file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return FAIL;
+    }
+    end = fgets(line, sizeof(line), file);
+    fclose(file);
+
+    /* the name may hold spaces and parens, it ends at the last ')' */
+    open_paren = (NULL == end) ? NULL : strchr(line, '(');
+    end = (NULL == end) ? NULL : strrchr(line, ')');
+    if (NULL == open_paren || NULL == end || end - open_paren - 1 >= PATH_LEN)
+    {
+        return FAIL;
+    }
+    memcpy(comm, open_paren + 1, end - open_paren - 1);
+    comm[end - open_paren - 1] = '\0';
+
+    /* state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt
+       utime stime cutime cstime priority nice num_threads */
+    fields = sscanf(end + 2, "%c %d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %ld",
+                    &state, ppid, threads);
+
+    return (3 == fields && 'Z' != state) ? SUCCESS : FAIL;
+}
+
+/* the watchdog of user - a parked spare has no peer watcher thread yet */
+static pid_t FindWatchdog(pid_t user)
+{
+    char comm[PATH_LEN];
+    struct dirent* entry = NULL;
+    DIR* proc = opendir("/proc");
+    pid_t found = 0;
+    pid_t ppid = 0;
+    pid_t pid = 0;
+    long threads = 0;
+
+    while (NULL != proc && NULL != (entry = readdir(proc)))
+    {
+        pid = atoi(entry->d_name);
+        if (0 < pid && SUCCESS == ReadStat(pid, comm, &ppid, &threads) && ppid == user &&
+            0 == strcmp(comm, "wd_process.out") && (0 == found || 1 < threads))
+        {
+            found = pid;
+        }
+    }
+    if (NULL != proc)
+    {
+        closedir(proc);
+    }
+
+    return found;
+}
+
+static int Exists(pid_t pid)
+{
+    char comm[PATH_LEN];
+    pid_t ppid = 0;
+    long threads = 0;
+
+    return SUCCESS == ReadStat(pid, comm, &ppid, &threads);
+}
+
+static int IsComm(pid_t pid, const char* name)
+{
+    char comm[PATH_LEN];
+    pid_t ppid = 0;
+    long threads = 0;
+
+    return SUCCESS == ReadStat(pid, comm, &ppid, &threads) && 0 == strcmp(comm, name);
+}
+
+/* the region of the pair whose user process is pid, NULL until it is created and sized */
+static heartbeat_t* OpenRegion(pid_t pid)
+{
+    char name[PATH_LEN];
+    char path[2 * PATH_LEN];
+    struct stat region = {0};
+
+    sprintf(name, "/wd_heartbeat_%d", pid);
+    sprintf(path, "/dev/shm%s", name);
+    if (0 != stat(path, &region) || 0 == region.st_size)
+    {
+        return NULL;
+    }
+
+    return HeartbeatOpen(name, FALSE);
+}
+
+/* the metrics page and kick table of the pair go with it - all are named after the first user process */
+static void UnlinkRegion(pid_t pid)
+{
+    char name[PATH_LEN];
+
+    sprintf(name, "/wd_heartbeat_%d", pid);
+    shm_unlink(name);
+    sprintf(name, "/wd_metrics_%d", pid);
+    shm_unlink(name);
+    sprintf(name, "/wd_kicks_%d", pid);
+    shm_unlink(name);
+}
+
+#if defined(__x86_64__)
+/* an address in pid's code holding EB FE - "jmp ." wherever it is found */
+static unsigned long long FindSpin(pid_t pid)
+{
+    static unsigned char chunk[SCAN_CHUNK];
+    char path[PATH_LEN];
+    char line[LINE_LEN];
+    char perms[8];
+    unsigned long long start = 0;
+    unsigned long long end = 0;
+    unsigned long long at = 0;
+    unsigned long long spin = 0;
+    unsigned char* hit = NULL;
+    ssize_t bytes = 0;
+    FILE* maps = NULL;
+    int mem = -1;
+
+    sprintf(path, "/proc/%d/maps", pid);
+    maps = fopen(path, "r");
+    sprintf(path, "/proc/%d/mem", pid);
+    mem = open(path, O_RDONLY);
+
+    while (NULL != maps && -1 != mem && 0 == spin && NULL != fgets(line, sizeof(line), maps))
+    {
+        if (3 != sscanf(line, "%llx-%llx %7s", &start, &end, perms) || 'x' != perms[2])
+        {
+            continue;
+        }
+
+        for (at = start; 0 == spin && at < end; at += SCAN_CHUNK - 1)
+        {
+            bytes = pread(mem, chunk, (end - at < SCAN_CHUNK) ? end - at : SCAN_CHUNK, (off_t)at);
+            hit = (bytes > 1) ? (unsigned char*)memchr(chunk, 0xEB, bytes - 1) : NULL;
+            while (NULL != hit && 0xFE != hit[1])
+            {
+                ++hit;
+                hit = (unsigned char*)memchr(hit, 0xEB, chunk + bytes - 1 - hit);
+            }
+            if (NULL != hit)
+            {
+                spin = at + (unsigned long long)(hit - chunk);
+            }
+        }
+    }
+
+    if (NULL != maps)
+    {
+        fclose(maps);
+    }
+    if (-1 != mem)
+    {
+        close(mem);
+    }
+
+    return spin;
+}
+
+/* every thread of pid is sent to spin forever, the code is left as it is */
+static int InjectBusy(pid_t pid)
+{
+    struct user_regs_struct regs;
+    char path[PATH_LEN];
+    struct dirent* entry = NULL;
+    unsigned long long spin = 0;
+    DIR* tasks = NULL;
+    pid_t tid = 0;
+    int status = FAIL;
+
+    sprintf(path, "/proc/%d/task", pid);
+    tasks = opendir(path);
+    while (NULL != tasks && NULL != (entry = readdir(tasks)))
+    {
+        tid = atoi(entry->d_name);
+        if (0 >= tid || 0 != ptrace(PTRACE_SEIZE, tid, NULL, NULL))
+        {
+            continue;
+        }
+
+        ptrace(PTRACE_INTERRUPT, tid, NULL, NULL);
+        waitpid(tid, NULL, __WALL);
+
+        if (0 == spin)
+        {
+            spin = FindSpin(pid);
+        }
+
+        if (0 != spin && 0 == ptrace(PTRACE_GETREGS, tid, NULL, &regs))
+        {
+            regs.rip = spin;
+            regs.orig_rax = (unsigned long long)-1; /* an interrupted syscall is not restarted */
+            if (0 == ptrace(PTRACE_SETREGS, tid, NULL, &regs))
+            {
+                status = SUCCESS;
+            }
+        }
+        ptrace(PTRACE_DETACH, tid, NULL, NULL);
+    }
+    if (NULL != tasks)
+    {
+        closedir(tasks);
+    }
+
+    return status;
+}
+#else
+static int InjectBusy(pid_t pid)
+{
+    (void)pid;
+    return FAIL;
+}
+#endif
+
+static int Inject(fault_t fault, pid_t pid)
+{
+    switch (fault)
+    {
+        case FAULT_KILL:
+            return (0 == kill(pid, SIGKILL)) ? SUCCESS : FAIL;
+        case FAULT_STOP:
+            return (0 == kill(pid, SIGSTOP)) ? SUCCESS : FAIL;
+        default:
+            return InjectBusy(pid);
+    }
+}
+
+static pid_t StartPair(void)
+{
+    pid_t pid = fork();
+    int null_fd = -1;
+
+    if (0 == pid)
+    {
+        /* the pair and whatever it revives share one group, killed at once */
+        setpgid(0, 0);
+        null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        execl(USER_PROCESS, USER_PROCESS, (char*)NULL);
+        _exit(1);
+    }
+    setpgid(pid, pid);
+
+    return pid;
+}
+
+static void StopPair(pid_t group, pid_t user, pid_t wd)
+{
+    kill(-group, SIGKILL);
+
+    /* a subreaper - orphans of the group are reaped here too */
+    while (0 < waitpid(-1, NULL, __WALL))
+    {
+    }
+
+    UnlinkRegion(user);
+    UnlinkRegion(wd);
+}
+
+/* 0 and both sides beating, or FAIL */
+static int WaitForBeats(heartbeat_t* region, uint64_t after, uint64_t limit_ns, uint64_t* resumed)
+{
+    uint64_t user = 0;
+    uint64_t wd = 0;
+
+    while (NowNs() < limit_ns)
+    {
+        user = HeartbeatLastNs(region, HEARTBEAT_USER);
+        wd = HeartbeatLastNs(region, HEARTBEAT_WATCHDOG);
+        if (user > after && wd > after)
+        {
+            *resumed = (user > wd) ? user : wd;
+            return SUCCESS;
+        }
+        Sleep(POLL_NS);
+    }
+
+    return FAIL;
+}
+
+/* detect and resume in ns, FAIL if the failure went unnoticed or the pair never came back */
+static int Run(fault_t fault, target_t target, uint64_t* detect, uint64_t* resume)
+{
+    heartbeat_t* region = NULL;
+    heartbeat_t* revived = NULL;
+    pid_t user = StartPair();
+    pid_t wd = 0;
+    uint64_t limit = NowNs() + (uint64_t)START_LIMIT_SEC * NSEC_PER_SEC;
+    uint64_t injected = 0;
+    uint64_t resumed = 0;
+    int status = FAIL;
+
+    while (NULL == region && NowNs() < limit)
+    {
+        Sleep(POLL_NS);
+        region = OpenRegion(user);
+    }
+    if (NULL == region || SUCCESS != WaitForBeats(region, 0, limit, &resumed) || 0 == (wd = FindWatchdog(user)))
+    {
+        fprintf(stderr, "recovery: the pair did not start\n");
+        StopPair(user, user, wd);
+        return FAIL;
+    }
+
+    Sleep((long)(rand_r(&seed) % (IntervalSec() * 1000)) * POLL_NS);
+
+    injected = NowNs();
+    if (SUCCESS != Inject(fault, (TARGET_USER == target) ? user : wd))
+    {
+        fprintf(stderr, "recovery: failed to inject %s\n", fault_names[fault]);
+        HeartbeatClose(region, NULL);
+        StopPair(user, user, wd);
+        return FAIL;
+    }
+
+    /* the user reaps a replaced watchdog, the watchdog becomes the new user process */
+    limit = injected + (uint64_t)DETECT_LIMIT_SEC * NSEC_PER_SEC;
+    while (NowNs() < limit && ((TARGET_WD == target) ? Exists(wd) : !IsComm(wd, "user_wd.out")))
+    {
+        Sleep(POLL_NS);
+    }
+    *detect = NowNs() - injected;
+
+    if (*detect < (uint64_t)DETECT_LIMIT_SEC * NSEC_PER_SEC)
+    {
+        /* a revived user process makes a new region, named by its pid - the old watchdog's */
+        while (TARGET_USER == target && NULL == revived && NowNs() < limit)
+        {
+            Sleep(POLL_NS);
+            revived = OpenRegion(wd);
+        }
+
+        if (SUCCESS == WaitForBeats((TARGET_USER == target) ? revived : region, injected, limit, &resumed))
+        {
+            *resume = resumed - injected;
+            status = SUCCESS;
+        }
+    }
+
+    if (NULL != revived)
+    {
+        HeartbeatClose(revived, NULL);
+    }
+    HeartbeatClose(region, NULL);
+    StopPair(user, user, wd);
+
+    return status;
+}
+
+static int CompareNs(const void* a, const void* b)
+{
+    uint64_t left = *(const uint64_t*)a;
+    uint64_t right = *(const uint64_t*)b;
+
+    return (left > right) - (left < right);
+}
+
+static void PrintDistribution(const char* name, uint64_t* samples, int count)
+{
+    if (0 == count)
+    {
+        fprintf(stderr, " %s=none", name);
+        return;
+    }
+
+    qsort(samples, count, sizeof(uint64_t), CompareNs);
+    fprintf(stderr, " %s p50=%.1f p90=%.1f max=%.1f", name, samples[count / 2] / NSEC_PER_MSEC,
+            samples[(count * 9) / 10] / NSEC_PER_MSEC, samples[count - 1] / NSEC_PER_MSEC);
+}
+
+static void Bench(fault_t fault, target_t target, int runs)
+{
+    uint64_t* detects = (uint64_t*)malloc(runs * sizeof(uint64_t));
+    uint64_t* resumes = (uint64_t*)malloc(runs * sizeof(uint64_t));
+    int recovered = 0;
+    int i = 0;
+
+    if (NULL == detects || NULL == resumes)
+    {
+        free(detects);
+        free(resumes);
+        return;
+    }
+
+    for (i = 0; i < runs; ++i)
+    {
+        if (SUCCESS == Run(fault, target, &detects[recovered], &resumes[recovered]))
+        {
+            ++recovered;
+        }
+    }
+
+    fprintf(stderr, "recovery fault=%s target=%s interval=%lu runs=%d recovered=%d", fault_names[fault],
+            target_names[target], IntervalSec(), runs, recovered);
+    PrintDistribution("detect_ms", detects, recovered);
+    PrintDistribution("resume_ms", resumes, recovered);
+    fprintf(stderr, "\n");
+
+    free(detects);
+    free(resumes);
+}
+
+static int Parse(const char* arg, const char** names, int count)
+{
+    int i = 0;
+
+    for (i = 0; NULL != arg && i < count; ++i)
+    {
+        if (0 == strcmp(arg, names[i]))
+        {
+            return i;
+        }
+    }
+
+    return -1; /* all */
+}
+
+int main(int argc, char** argv)
+{
+    int runs = (argc > 1) ? atoi(argv[1]) : DEFAULT_RUNS;
+    int only_fault = Parse((argc > 2) ? argv[2] : NULL, fault_names, FAULTS);
+    int only_target = Parse((argc > 3) ? argv[3] : NULL, target_names, TARGETS);
+    int fault = 0;
+    int target = 0;
+
+    if (runs <= 0)
+    {
+        runs = DEFAULT_RUNS;
+    }
+
+    /* orphaned watchdogs and revived user processes stay reapable */
+    prctl(PR_SET_CHILD_SUBREAPER, 1);
+
+    for (fault = 0; fault < FAULTS; ++fault)
+    {
+        for (target = 0; target < TARGETS; ++target)
+        {
+            if ((-1 == only_fault || fault == only_fault) && (-1 == only_target || target == only_target))
+            {
+                Bench((fault_t)fault, (target_t)target, runs);
+            }
+        }
+    }
+
+    return 0;
+}
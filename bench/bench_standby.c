@@ -0,0 +1,188 @@
+/*
+    Revive latency of the watchdog, cold and from a warm standby.
+
+    This process plays the user process of the pair. A revive is over once
+    the new wd_process.out finished the semaphore handshake - from there on
+    it monitors.
+        fork    - fork + exec of wd_process.out + its setup + handshake,
+                  what UserScheduler does without a spare
+        standby - ActivateStandby on a spare that already went through exec
+                  and setup + handshake
+    Every spare gets PARK_NS to park before the clock starts, as the next
+    spare is spawned right after a revive, long before it is needed.
+        p50_us, p99_us, max_us - over the rounds
+
+    Run from the directory of wd_process.out.
+    usage: ./bench_standby.out [rounds]   (default 50)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>      /* fprintf, sprintf */
+#include <stdlib.h>     /* atoi, malloc, qsort, setenv */
+#include <stdint.h>     /* uint64_t */
+#include <signal.h>     /* kill, SIGKILL */
+#include <fcntl.h>      /* open, fcntl, O_WRONLY */
+#include <unistd.h>     /* fork, execvp, dup2 */
+#include <time.h>       /* clock_gettime, clock_nanosleep */
+#include <sys/socket.h> /* socketpair */
+#include <sys/wait.h>   /* waitpid */
+
+#include "wd_common.h"
+
+#define DEFAULT_ROUNDS (50)
+#define PARK_NS (200000000L)
+#define NSEC_PER_SEC (1000000000L)
+
+static char* wd_args[] = {WD_PROCESS, "1", "3", NULL};
+static sem_t* wd_sem = NULL;
+static sem_t* user_sem = NULL;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static void Sleep(long ns)
+{
+    struct timespec period = {ns / NSEC_PER_SEC, ns % NSEC_PER_SEC};
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+}
+
+/* spare_fd is left open for exec, -1 for a plain watchdog */
+static pid_t SpawnWatchdog(int spare_fd)
+{
+    pid_t pid = fork();
+    int null_fd = -1;
+
+    if (0 == pid)
+    {
+        null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        if (-1 != spare_fd)
+        {
+            fcntl(spare_fd, F_SETFD, 0);
+        }
+        execvp(WD_PROCESS, wd_args);
+        _exit(1);
+    }
+
+    return pid;
+}
+
+static void Handshake(void)
+{
+    sem_post(wd_sem);
+    sem_wait(user_sem);
+}
+
+static void Reap(pid_t pid)
+{
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+
+    /* the killed watchdog may not have taken its post */
+    while (0 == sem_trywait(wd_sem))
+    {
+    }
+}
+
+static uint64_t ReviveCold(void)
+{
+    uint64_t start = NowNs();
+    pid_t pid = SpawnWatchdog(-1);
+    uint64_t ns = 0;
+
+    Handshake();
+    ns = NowNs() - start;
+    Reap(pid);
+
+    return ns;
+}
+
+static uint64_t ReviveWarm(void)
+{
+    char fd_str[MAX_PID_DIGITS];
+    int fds[2] = {-1, -1};
+    uint64_t start = 0;
+    uint64_t ns = 0;
+    pid_t pid = 0;
+
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+    {
+        return 0;
+    }
+
+    sprintf(fd_str, "%d", fds[1]);
+    setenv(STANDBY_FD_ENV, fd_str, TRUE);
+    pid = SpawnWatchdog(fds[1]);
+    unsetenv(STANDBY_FD_ENV);
+    close(fds[1]);
+    Sleep(PARK_NS);
+
+    start = NowNs();
+    ActivateStandby(fds[0]);
+    Handshake();
+    ns = NowNs() - start;
+
+    close(fds[0]);
+    Reap(pid);
+
+    return ns;
+}
+
+static int CompareNs(const void* a, const void* b)
+{
+    uint64_t left = *(const uint64_t*)a;
+    uint64_t right = *(const uint64_t*)b;
+
+    return (left > right) - (left < right);
+}
+
+static void Report(const char* mode, uint64_t* samples, int rounds)
+{
+    qsort(samples, rounds, sizeof(uint64_t), CompareNs);
+    fprintf(stderr, "standby mode=%s rounds=%d p50_us=%.1f p99_us=%.1f max_us=%.1f\n", mode, rounds,
+            samples[rounds / 2] / 1000.0, samples[(rounds * 99) / 100] / 1000.0, samples[rounds - 1] / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    int rounds = (argc > 1) ? atoi(argv[1]) : DEFAULT_ROUNDS;
+    uint64_t* cold = NULL;
+    uint64_t* warm = NULL;
+    int i = 0;
+
+    if (rounds <= 0)
+    {
+        rounds = DEFAULT_ROUNDS;
+    }
+
+    cold = (uint64_t*)malloc(rounds * sizeof(uint64_t));
+    warm = (uint64_t*)malloc(rounds * sizeof(uint64_t));
+    if (NULL == cold || NULL == warm || SUCCESS != SetupHeartbeat(FALSE) ||
+        SUCCESS != SetupSemaphores(&wd_sem, &user_sem, FALSE))
+    {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    /* interleaved - both modes see the same page cache and CPU state */
+    for (i = 0; i < rounds; ++i)
+    {
+        cold[i] = ReviveCold();
+        warm[i] = ReviveWarm();
+    }
+
+    Report("fork", cold, rounds);
+    Report("standby", warm, rounds);
+
+    CleanupResources(NULL, NULL, wd_sem, user_sem);
+    free(cold);
+    free(warm);
+
+    return 0;
+}
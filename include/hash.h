@@ -0,0 +1,95 @@
+/*
+    Version 1.0.0
+*/
+
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include <stddef.h> /* size_t */
+
+/*Description: This function hashes a key, the DS mixes the result again
+                so any spread of the bits will do.*/
+typedef size_t (*hash_func_t)(const void* key);
+/*Description: This function checks if data is stored under key.
+                Returns non-zero on a match.*/
+typedef int (*hash_is_match_t)(const void* data, const void* key);
+/*Description: type definition to the open addressing hash table ds.
+                Entries are {hash, data} pairs stored inline and probed
+                linearly, a removal shifts the following entries back so
+                there are no tombstones. Keys live inside the data.
+                Not thread safe.*/
+typedef struct hash hash_t;
+
+/*
+    Description:        Creates the DS.
+    Args:               hash_func - hashes a key.
+                        is_match - compares stored data to a key.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+hash_t* HashCreate(hash_func_t hash_func, hash_is_match_t is_match);
+
+/*
+    Description:        This function free all memory allocated by the DS,
+                        the stored data is not freed.
+    Args:               hash - pointer to the DS.
+    Return value:       None.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void HashDestroy(hash_t* hash);
+
+/*
+    Description:        Stores data under key. The key must not be in the
+                        DS already.
+    Args:               hash - pointer to the DS.
+                        key - key of the data.
+                        data - pointer to store, not NULL.
+    Return value:       0 on Success, 1 on allocation failure.
+    Time complexity:    Amortized O(1) average.
+    Space complexity:   Amortized O(1).
+*/
+int HashInsert(hash_t* hash, const void* key, void* data);
+
+/*
+    Description:        Removes the data stored under key.
+    Args:               hash - pointer to the DS.
+                        key - key of the data.
+    Return value:       The removed data, NULL if the key is not in the DS.
+    Time complexity:    O(1) average.
+    Space complexity:   O(1).
+*/
+void* HashRemove(hash_t* hash, const void* key);
+
+/*
+    Description:        Finds the data stored under key.
+    Args:               hash - pointer to the DS.
+                        key - key of the data.
+    Return value:       The data, NULL if the key is not in the DS.
+    Time complexity:    O(1) average.
+    Space complexity:   O(1).
+*/
+void* HashFind(const hash_t* hash, const void* key);
+
+/*
+    Description:        Makes room for count entries in total, inserts up to
+                        that size do not allocate.
+    Args:               hash - pointer to the DS.
+                        count - number of entries to hold.
+    Return value:       0 on Success, 1 on allocation failure.
+    Time complexity:    O(n) when the table grows, O(1) otherwise.
+    Space complexity:   O(count).
+*/
+int HashReserve(hash_t* hash, size_t count);
+
+/*
+    Description:        Returns the number of entries.
+    Args:               hash - pointer to the DS.
+    Return value:       Number of entries.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+size_t HashSize(const hash_t* hash);
+
+#endif /* __HASH_H__*/
@@ -1,5 +1,5 @@
 /*
-    Version 1.1.0
+    Version 1.4.0
 */
 
 #ifndef __HEAP_H__
@@ -15,6 +15,10 @@ typedef int (*heap_compare_func_t)(void*, void*);
                 It compares each item in the heap (data) with the params.
                 Case there's a match - 1 is returns, 0 otherwise.*/
 typedef int (*heap_is_match_t)(void* data, void* params);
+/*Description: This function stores the current index of data within the heap.
+                It is called every time an item is placed or moved, so the
+                item can later be removed by index (refer HeapRemoveAt).*/
+typedef void (*heap_set_index_t)(void* data, size_t index);
 /*Description: type definition to the the Heap ds.*/
 typedef struct heap heap_t; 
 
@@ -28,6 +32,32 @@ typedef struct heap heap_t;
 */
 heap_t* HeapCreate(heap_compare_func_t compare_func);
 
+/*
+    Description:        Creates the DS according to compare_func, every item
+                        is told its position through set_index.
+    Args:               compare_func - compare function.(refer heap_compare)
+                        set_index - index update function.(refer heap_set_index)
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+heap_t* HeapCreateIndexed(heap_compare_func_t compare_func, heap_set_index_t set_index);
+
+/*
+    Description:        Creates a d-ary DS - every node has up to arity
+                        children, stored next to each other. A wider node
+                        makes the tree shallower, HeapPop compares more
+                        siblings per level but walks fewer levels.
+                        HeapCreate/HeapCreateIndexed use arity 2.
+    Args:               compare_func - compare function.(refer heap_compare)
+                        set_index - index update function, may be NULL.
+                        arity - children per node, at least 2.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+heap_t* HeapCreateWithArity(heap_compare_func_t compare_func, heap_set_index_t set_index, size_t arity);
+
 /*
     Description:        This function free all memory allocated by the DS.
     Args:               Heap - pointer to the DS.
@@ -81,6 +111,39 @@ void HeapPop(heap_t* heap);
     Space complexity:   O(1).
 */
 void* HeapRemove(heap_t* heap, heap_is_match_t is_match, void* params);
+
+/*
+    Description:        This function finds a value according to param supplied.
+                        (Refer heap_is_match)
+    Return value:       Pointer to the found item on success, NULL otherwise.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+void* HeapFind(heap_t* heap, heap_is_match_t is_match, void* params);
+
+/*
+    Description:        This function removes the item stored at index.
+                        Case index is out of range - undefinied behaviour.
+    Args:               Heap - pointer to the ds.
+                        index - position of the item (refer heap_set_index).
+    Return value:       Pointer to the removed item.
+    Time complexity:    O(log(n)).
+    Space complexity:   O(1).
+*/
+void* HeapRemoveAt(heap_t* heap, size_t index);
+
+/*
+    Description:        Removes every item is_match returns 1 for and rebuilds
+                        the heap once. is_match may free the item it matches,
+                        the heap doesn't touch it again.
+    Args:               Heap - pointer to the ds.
+                        is_match - called once per item.
+                        params - passed to is_match as is.
+    Return value:       Number of removed items.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+size_t HeapRemoveIf(heap_t* heap, heap_is_match_t is_match, void* params);
 /*
     Description:        Returns if heap has no items within the Heap ds.
     Args:               Heap - pointer to the ds.
@@ -0,0 +1,63 @@
+/*
+    Version 1.0.0
+*/
+
+#ifndef __MPSC_H__
+#define __MPSC_H__
+
+#include <stdatomic.h> /* _Atomic */
+
+/*Description: type definition to the lock-free multi-producer single-consumer
+                queue ds. The queue is intrusive - it links nodes embedded in
+                the caller's elements and never allocates per element.*/
+typedef struct mpsc mpsc_t;
+/*Description: link embedded in a queued element, owned by the queue between
+                push and pop.*/
+typedef struct mpsc_node
+{
+    _Atomic(struct mpsc_node*) next;
+} mpsc_node_t;
+
+/*
+    Description:        Creates the DS.
+    Args:               None.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+mpsc_t* MPSCCreate(void);
+
+/*
+    Description:        This function free the memory allocated by the DS.
+                        Nodes still in the queue are not touched.
+    Args:               queue - pointer to the DS.
+    Return value:       None.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void MPSCDestroy(mpsc_t* queue);
+
+/*
+    Description:        Appends a node to the queue. Safe to call from any
+                        number of threads at once, never blocks.
+    Args:               queue - pointer to the DS.
+                        node - node embedded in the element to queue.
+    Return value:       None.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void MPSCPush(mpsc_t* queue, mpsc_node_t* node);
+
+/*
+    Description:        Removes the oldest node. Only one thread may pop.
+                        Case the queue is empty or the next push is half done -
+                        NULL is returned, the pushing thread is expected to
+                        notify the consumer after MPSCPush returns.
+    Args:               queue - pointer to the DS.
+    Return value:       Pointer to the removed node.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+mpsc_node_t* MPSCPop(mpsc_t* queue);
+
+#endif /* __MPSC_H__*/
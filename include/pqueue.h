@@ -6,6 +6,7 @@
 
 typedef struct pqueue pqueue_t;
 typedef int(*pq_comperator_t)(void*, void*);
+typedef void(*pq_set_index_t)(void*, size_t);
 
 /*
     Description: Creates a priority queue
@@ -16,6 +17,27 @@ typedef int(*pq_comperator_t)(void*, void*);
 */
 pqueue_t* PQCreate(pq_comperator_t comperator);
 
+/*
+    Description: Creates a priority queue that reports each element's position
+    Args: A comparator function to prioritize elements,
+          a function called with an element and its new position on every move
+    Return Value: A pointer to the created priority queue
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+pqueue_t* PQCreateIndexed(pq_comperator_t comperator, pq_set_index_t set_index);
+
+/*
+    Description: Creates a priority queue on a d-ary heap (refer HeapCreateWithArity)
+    Args: A comparator function to prioritize elements,
+          an index update function or NULL,
+          children per heap node (2 for a binary heap, 4 or 8 for shallower trees)
+    Return Value: A pointer to the created priority queue
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+pqueue_t* PQCreateWithArity(pq_comperator_t comperator, pq_set_index_t set_index, size_t arity);
+
 /*
     Description: Destroys a priority queue and frees all allocated memory
     Args: A pointer to the queue
@@ -80,6 +102,34 @@ size_t PQSize(const pqueue_t* queue);
 */
 void* PQErase(pqueue_t* queue, void* data, int (*IsMatch)(void*, void*));
 
+/*
+    Description: Finds the first element that matches data, without removing it
+    Args: A pointer to the priority queue, and a pointer to the data to match
+    Return Value: The matching element, NULL if not found
+    Time Complexity: O(n)
+    Space Complexity: O(1)
+*/
+void* PQFind(pqueue_t* queue, void* data, int (*IsMatch)(void*, void*));
+
+/*
+    Description: Removes the element at a position reported by PQCreateIndexed
+    Args: A pointer to the priority queue, and the position of the element
+    Return Value: The removed element
+    Time Complexity: O(log n)
+    Space Complexity: O(1)
+*/
+void* PQEraseAt(pqueue_t* queue, size_t index);
+
+/*
+    Description: Removes every element IsMatch returns 1 for, the queue is
+    		 rebuilt once. IsMatch may free the element it matches.
+    Args: A pointer to the priority queue, the match function, and a pointer passed to it
+    Return Value: Number of removed elements
+    Time Complexity: O(n)
+    Space Complexity: O(1)
+*/
+size_t PQEraseIf(pqueue_t* queue, int (*IsMatch)(void*, void*), void* data);
+
 /*
     Description: Clears all elements from the priority queue
     Args: A pointer to the priority queue
@@ -2,21 +2,60 @@
 #define __SCHEDULER_H__ 
 
 #include <stddef.h> /* include size_t */
+#include <stdint.h> /* uint32_t */
 #include "pqueue.h"
 #include "uid.h"
+#include "task.h" /* task_mode_t, task_overrun_t, task_lateness_t */
 
 typedef enum
 {
-    STOP = -3,
+    WORKERS_FAIL = -4,
+    STOP,
     ENQUEUE_FAIL,
     TIME_FAILURE,
     SUCCESSFULL_RUN
 } run_status_t;
 
+typedef enum
+{
+    SCHED_BACKEND_HEAP,   /* binary heap of inline {deadline, task}, exact deadlines, O(log n) reschedule */
+    SCHED_BACKEND_WHEEL,  /* hierarchical timing wheel, tick resolution, O(1) reschedule */
+    SCHED_BACKEND_PQUEUE  /* generic pqueue with a task comparator, as SCHED_BACKEND_HEAP but slower */
+} sched_backend_t;
+
+typedef struct scheduler_config
+{
+    sched_backend_t backend;
+    size_t wheel_tick_us; /* SCHED_BACKEND_WHEEL resolution, 0 for the default (1ms) */
+    size_t heap_arity;    /* SCHED_BACKEND_PQUEUE children per heap node, 0 for the default (4) */
+    int wait_when_empty;  /* non-zero - an empty run blocks for posted tasks until SchedulerStop */
+} scheduler_config_t;
+
 typedef struct scheduler scheduler_t;
 typedef int (*s_operation_t)(void* args);
 typedef void (*s_cleanup_op_t)(void* cleanup_args);
 
+typedef struct scheduler_task_desc
+{
+    s_operation_t operation;
+    void* args;
+    size_t interval_us;
+    s_cleanup_op_t cleanup_op;
+    void* cleanup_args;
+    task_mode_t mode;       /* zero - TASK_FIXED_DELAY */
+    task_overrun_t overrun; /* TASK_FIXED_RATE only */
+    task_stats_record_t* stats; /* NULL - no timing, else must outlive the task (see TaskStatsSnapshot) */
+} scheduler_task_desc_t;
+
+/* a slot of the scheduler's task table, the generation tells a reused slot apart */
+typedef struct sched_handle
+{
+    uint32_t slot;
+    uint32_t generation;
+} sched_handle_t;
+
+extern const sched_handle_t BadHandle;
+
 /*
     Description: Creates a new scheduler
     Args: None
@@ -26,6 +65,15 @@ typedef void (*s_cleanup_op_t)(void* cleanup_args);
 */
 scheduler_t* SchedulerCreate(void);
 
+/*
+    Description: Creates a new scheduler with a chosen task queue backend
+    Args: A pointer to the configuration, zero initialized fields take their defaults
+    Return Value: A pointer to the created scheduler
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+scheduler_t* SchedulerCreateWithConfig(const scheduler_config_t* config);
+
 /*
     Description: Destroys the scheduler and releases all associated resources
     Args: A pointer to the scheduler
@@ -51,16 +99,127 @@ void SchedulerDestroy(scheduler_t* scheduler);
 UID_t SchedulerAddTask(scheduler_t* scheduler, s_operation_t operation, void* args, size_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args);
 
 /*
-    Description: Removes a task from the scheduler based on its UID
+    Description: Adds a new task with a sub-second interval to the scheduler
+    Args: 
+        scheduler - A pointer to the scheduler
+        operation - The task operation to execute
+        args - Arguments for the task operation
+        interval_us - The time interval (in microseconds) between executions
+        cleanup_op - A cleanup function for the task
+        cleanup_args - Arguments for the cleanup function
+    Return Value: The unique identifier (UID) of the added task
+    Time Complexity: O(log n)
+    Space Complexity: O(1)
+*/
+UID_t SchedulerAddTaskUs(scheduler_t* scheduler, s_operation_t operation, void* args, size_t interval_us, s_cleanup_op_t cleanup_op, void* cleanup_args);
+
+/*
+    Description: Adds many tasks at once, the queue is built in one pass
+                 instead of one insert per task. Either all tasks are added
+                 or none of them. A description also picks the task's mode,
+                 fixed delay or fixed rate with an overrun policy, and may
+                 attach a stats record the task's runs are timed into.
+    Args: 
+        scheduler - A pointer to the scheduler
+        tasks - Array of task descriptions, intervals are in microseconds
+        count - Number of tasks in the array
+        task_ids - Array of count UIDs to fill, may be NULL
+    Return Value: 0 on Success, -1 otherwise
+    Time Complexity: O(n + count)
+    Space Complexity: O(count)
+*/
+int SchedulerAddTasks(scheduler_t* scheduler, const scheduler_task_desc_t* tasks, size_t count, UID_t* task_ids);
+
+/*
+    Description: Adds a task described as in SchedulerAddTasks and returns a
+                 handle to cancel it with SchedulerCancel
+    Args: 
+        scheduler - A pointer to the scheduler
+        task - The task description, the interval is in microseconds
+        task_id - Filled with the task's UID, may be NULL
+    Return Value: Handle of the task, BadHandle on failure
+    Time Complexity: O(log n)
+    Space Complexity: O(1)
+*/
+sched_handle_t SchedulerAddTaskHandle(scheduler_t* scheduler, const scheduler_task_desc_t* task, UID_t* task_id);
+
+/*
+    Description: Cancels a task by its handle. The cleanup function runs right
+                 away, or after the run if the task is the one running now.
+                 The task is only marked dead, the runner drops it once it
+                 is due, and the queue is purged in one pass when dead
+                 tasks are more than half of it. Call from the running
+                 thread, as SchedulerRemove.
+    Args: A pointer to the scheduler, The handle of the task
+    Return Value: 0 on Success, -1 if the handle is stale or already cancelled
+    Time Complexity: O(1), amortized
+    Space Complexity: O(1)
+*/
+int SchedulerCancel(scheduler_t* scheduler, sched_handle_t task);
+
+/*
+    Description: Adds a new task from any thread, also while the scheduler runs.
+                 The task is queued lock-free and the runner is woken up, it
+                 joins the scheduler before the runner's next sleep.
+    Args: 
+        scheduler - A pointer to the scheduler
+        operation - The task operation to execute
+        args - Arguments for the task operation
+        interval - The time interval (in seconds) between executions
+        cleanup_op - A cleanup function for the task
+        cleanup_args - Arguments for the cleanup function
+    Return Value: The unique identifier (UID) of the posted task
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+UID_t SchedulerPostTask(scheduler_t* scheduler, s_operation_t operation, void* args, size_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args);
+
+/*
+    Description: SchedulerPostTask with a sub-second interval
+    Args: As SchedulerPostTask, interval_us - The time interval (in microseconds) between executions
+    Return Value: The unique identifier (UID) of the posted task
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+UID_t SchedulerPostTaskUs(scheduler_t* scheduler, s_operation_t operation, void* args, size_t interval_us, s_cleanup_op_t cleanup_op, void* cleanup_args);
+
+/*
+    Description: Removes a task from any thread, also while the scheduler runs.
+                 Applied in order with posted tasks, before the runner's next sleep.
+    Args: A pointer to the scheduler, The UID of the task to remove
+    Return Value: 0 on success, non-zero if the request could not be allocated
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+int SchedulerPostRemove(scheduler_t* scheduler, UID_t task);
+
+/*
+    Description: Removes a task from the scheduler based on its UID, the
+                 task is looked up in the scheduler's UID index. A task that
+                 is running is dropped once its run ends.
     Args: A pointer to the scheduler, The UID of the task to remove
     Return Value: None
-    Time Complexity: O(n)
+    Time Complexity: O(log n), O(1) lookup on average
     Space Complexity: O(1)
 */
 void SchedulerRemove(scheduler_t* scheduler, UID_t task);
 
 /*
-    Description: Clears all tasks from the scheduler
+    Description: Reads how late the runs of a task started compared to their
+                 deadlines, and how many periods its overrun policy dropped.
+                 Call from the running thread, a task that is running right
+                 now is not found.
+    Args: A pointer to the scheduler, The UID of the task, Pointer to fill
+    Return Value: 0 on Success, -1 if the task is not in the scheduler
+    Time Complexity: O(1) on average
+    Space Complexity: O(1)
+*/
+int SchedulerGetLateness(scheduler_t* scheduler, UID_t task, task_lateness_t* lateness);
+
+/*
+    Description: Clears all tasks from the scheduler, the queue is emptied in
+                 one pass without reordering it per task. A task running now
+                 is dropped after its run.
     Args: A pointer to the scheduler
     Return Value: None
     Time Complexity: O(n)
@@ -69,7 +228,9 @@ void SchedulerRemove(scheduler_t* scheduler, UID_t task);
 void SchedulerClear(scheduler_t* scheduler);
 
 /*
-    Description: Runs the scheduler and executes tasks in the scheduled order
+    Description: Runs the scheduler and executes tasks in the scheduled order.
+                 Sleeps until the next deadline, a posted task or SchedulerStop.
+                 Returns once empty, unless configured with wait_when_empty.
     Args: A pointer to the scheduler
     Return Value: A status indicating the outcome of the run (SUCCESSFUL_RUN, STOP)
     Time Complexity: O(tasks)
@@ -78,7 +239,22 @@ void SchedulerClear(scheduler_t* scheduler);
 run_status_t SchedulerRun(scheduler_t* scheduler);
 
 /*
-    Description: Stops running the tasks in the scheduler
+    Description: Runs the scheduler on a pool of worker threads. The calling
+                 thread dispatches due tasks to per-worker deques in deadline
+                 order, each worker runs its share earliest first and idle
+                 workers steal the latest from busy ones. A task is re-armed only after its run
+                 finished, so it never runs concurrently with itself.
+                 While running, task operations may call SchedulerStop and
+                 the SchedulerPost functions only.
+    Args: A pointer to the scheduler, number of worker threads
+    Return Value: A status indicating the outcome of the run (SUCCESSFUL_RUN, STOP, WORKERS_FAIL)
+    Time Complexity: O(tasks)
+    Space Complexity: O(n_workers + tasks in flight)
+*/
+run_status_t SchedulerRunParallel(scheduler_t* scheduler, size_t n_workers);
+
+/*
+    Description: Stops running the tasks in the scheduler, safe to call from any thread
     Args: A pointer to the scheduler
     Return Value: None
     Time Complexity: O(1)
@@ -0,0 +1,65 @@
+/*
+    Version 1.0.0
+*/
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include <stddef.h> /* size_t */
+
+/*Description: type definition to the fixed size object pool ds.
+                Memory is taken from the system in chunks of objects, freed
+                objects are kept on a freelist and handed out again.
+                Not thread safe.*/
+typedef struct slab slab_t;
+
+/*
+    Description:        Creates the DS. No chunk is allocated until the first
+                        SlabAlloc.
+    Args:               object_size - size of every object in bytes.
+                        objects_per_chunk - objects taken from the system at once.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+slab_t* SlabCreate(size_t object_size, size_t objects_per_chunk);
+
+/*
+    Description:        This function free all memory allocated by the DS,
+                        including objects that were not returned.
+    Args:               slab - pointer to the DS.
+    Return value:       None.
+    Time complexity:    O(chunks).
+    Space complexity:   O(1).
+*/
+void SlabDestroy(slab_t* slab);
+
+/*
+    Description:        Hands out an object, memory is not initialized.
+    Args:               slab - pointer to the DS.
+    Return value:       Pointer to the object, NULL on allocation failure.
+    Time complexity:    O(1), O(objects_per_chunk) when a chunk is added.
+    Space complexity:   O(1), O(objects_per_chunk) when a chunk is added.
+*/
+void* SlabAlloc(slab_t* slab);
+
+/*
+    Description:        Returns an object to the DS.
+    Args:               slab - pointer to the DS.
+                        object - pointer returned by SlabAlloc of this slab.
+    Return value:       None.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void SlabFree(slab_t* slab, void* object);
+
+/*
+    Description:        Returns the number of chunks taken from the system.
+    Args:               slab - pointer to the DS.
+    Return value:       Number of chunks.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+size_t SlabChunks(const slab_t* slab);
+
+#endif /* __SLAB_H__*/
@@ -1,22 +1,84 @@
 #ifndef __TASK_H__
 #define __TASK_H__ 
 
+#include <stdint.h> /* uint64_t */
+#include <stdatomic.h> /* _Atomic */
 #include "uid.h"
+#include "slab.h"
+
+/* nanoseconds on CLOCK_MONOTONIC */
+typedef uint64_t task_time_t;
 
 typedef int (*operation_t)(void* args);
 typedef void (*cleanup_op_t)(void* cleanup_args);
 
+typedef enum
+{
+    TASK_FIXED_DELAY, /* next run is interval after the end of the last run */
+    TASK_FIXED_RATE   /* next run is interval after the last deadline, anchored to the first one */
+} task_mode_t;
+
+/* what a TASK_FIXED_RATE task does when a run ends after later deadlines already passed */
+typedef enum
+{
+    TASK_OVERRUN_SKIP,     /* drop the missed periods, wait for the next deadline in the future */
+    TASK_OVERRUN_COALESCE, /* run once right away for all missed periods, then back on the grid */
+    TASK_OVERRUN_CATCH_UP  /* run once per missed period, back to back */
+} task_overrun_t;
+
+typedef struct task_lateness
+{
+    uint64_t runs;
+    uint64_t skipped_periods; /* periods dropped by the overrun policy */
+    task_time_t last;         /* start of the last run minus its deadline */
+    task_time_t max;
+    task_time_t total;
+} task_lateness_t;
+
+/* bucket 0 - started less than 1us late, bucket i - [2^(i-1), 2^i) us, the last one is open ended */
+#define TASK_LATENESS_BUCKETS (24)
+
+typedef struct task_stats
+{
+    uint64_t runs;
+    uint64_t failures;        /* runs whose operation returned a negative value */
+    task_time_t exec_total;
+    task_time_t exec_max;
+    uint64_t lateness[TASK_LATENESS_BUCKETS];
+} task_stats_t;
+
+/* written by the thread running the task without locking, any thread reads it with TaskStatsSnapshot */
+typedef struct task_stats_record
+{
+    _Atomic(unsigned int) sequence; /* odd while a run is being recorded */
+    _Atomic(uint64_t) runs;
+    _Atomic(uint64_t) failures;
+    _Atomic(uint64_t) exec_total;
+    _Atomic(uint64_t) exec_max;
+    _Atomic(uint64_t) lateness[TASK_LATENESS_BUCKETS];
+} task_stats_record_t;
+
 typedef struct task
 {
     UID_t id;
-    time_t time_to_run;
-    size_t interval;
+    task_time_t time_to_run;
+    task_time_t interval;
     operation_t operation;
     void* args;
     cleanup_op_t cleanup_op;
     void* cleanup_args;
+    size_t queue_index;  /* position in a heap queue, kept up to date by the heap */
+    void* queue_node;    /* handle in a timing wheel queue */
+    slab_t* slab;        /* owner of the task's memory, NULL - malloc */
+    task_mode_t mode;
+    task_overrun_t overrun;
+    task_lateness_t lateness;
+    task_stats_record_t* stats; /* NULL - runs are not timed */
+    uint32_t slot;       /* entry in the owner's handle table, TASK_NO_SLOT - none */
 } task_t;
 
+#define TASK_NO_SLOT (UINT32_MAX)
+
 /*
     Description: Creates a new task with the given parameters
     Args: 
@@ -32,7 +94,37 @@ typedef struct task
 task_t* TaskCreate(operation_t operation, void* args, size_t interval, cleanup_op_t cleanup_op, void* cleanup_args);
 
 /*
-    Description: Destroys a task and releases all associated resources
+    Description: Creates a new task with an interval in nanoseconds
+    Args: 
+        operation - A function to perform the task's operation
+        args - Arguments to pass to the operation function
+        interval - Time interval (in nanoseconds) between executions
+        cleanup_op - A function to perform cleanup operations
+        cleanup_args - Arguments to pass to the cleanup function
+    Return Value: A pointer to the created task
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+task_t* TaskCreateNs(operation_t operation, void* args, task_time_t interval, cleanup_op_t cleanup_op, void* cleanup_args);
+
+/*
+    Description: Creates a new task in memory taken from a slab of task_t sized objects
+    Args: 
+        slab - The slab the task is allocated from, NULL to use malloc
+        operation - A function to perform the task's operation
+        args - Arguments to pass to the operation function
+        interval - Time interval (in nanoseconds) between executions
+        cleanup_op - A function to perform cleanup operations
+        cleanup_args - Arguments to pass to the cleanup function
+    Return Value: A pointer to the created task
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+task_t* TaskCreateFromSlab(slab_t* slab, operation_t operation, void* args, task_time_t interval, cleanup_op_t cleanup_op, void* cleanup_args);
+
+/*
+    Description: Destroys a task and releases all associated resources,
+                 the memory goes back to the slab the task was created from
     Args: A pointer to the task
     Return Value: None
     Time Complexity: O(1)
@@ -41,7 +133,62 @@ task_t* TaskCreate(operation_t operation, void* args, size_t interval, cleanup_o
 void TaskDestroy(task_t* task);
 
 /*
-    Description: Runs the operation associated with the task
+    Description: Runs the task's cleanup function now instead of in
+                 TaskDestroy, it runs only once either way
+    Args: A pointer to the task
+    Return Value: None
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+void TaskCleanup(task_t* task);
+
+/*
+    Description: Sets how the task is rescheduled after each run,
+                 a new task is TASK_FIXED_DELAY
+    Args: 
+        task - A pointer to the task
+        mode - Fixed delay or fixed rate
+        overrun - What a fixed rate task does with missed periods
+    Return Value: None
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+void TaskSetMode(task_t* task, task_mode_t mode, task_overrun_t overrun);
+
+/*
+    Description: Attaches a record the task's runs are timed into, the
+                 record has to outlive the task. NULL detaches it.
+    Args: A pointer to the task, A pointer to the record or NULL
+    Return Value: None
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+void TaskSetStats(task_t* task, task_stats_record_t* stats);
+
+/*
+    Description: Zeroes a stats record
+    Args: A pointer to the record
+    Return Value: None
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+void TaskStatsInit(task_stats_record_t* stats);
+
+/*
+    Description: Copies a consistent view of a stats record, safe from any
+                 thread while the task runs. Retries while a run is being
+                 recorded, the writer never waits for the reader.
+    Args: A pointer to the record, A pointer to the copy to fill
+    Return Value: None
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+void TaskStatsSnapshot(const task_stats_record_t* stats, task_stats_t* snapshot);
+
+/*
+    Description: Runs the operation associated with the task and records
+                 how late the run started, and with a stats record attached
+                 how long it took
     Args: A pointer to the task
     Return Value: The result of the operation function
     Time Complexity: Depends on the implementation of the operation function
@@ -52,11 +199,20 @@ int TaskRun(task_t* task);
 /*
     Description: Retrieves the next execution time of the task
     Args: A pointer to the task
-    Return Value: The time to run
+    Return Value: The time to run (nanoseconds on CLOCK_MONOTONIC)
     Time Complexity: O(1)
     Space Complexity: O(1)
 */
-time_t TaskGetTimeToRun(const task_t* task);
+task_time_t TaskGetTimeToRun(const task_t* task);
+
+/*
+    Description: Retrieves the lateness counters of the task
+    Args: A pointer to the task
+    Return Value: Copy of the counters
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+task_lateness_t TaskGetLateness(const task_t* task);
 
 /*
     Description: Retrieves the unique identifier (UID) of the task
@@ -77,7 +233,8 @@ UID_t TaskGetUID(const task_t* task);
 int TaskIsMatch(const task_t* task1, const task_t* task2);
 
 /*
-    Description: Updates the next execution time of the task based on its interval
+    Description: Updates the next execution time of the task based on its
+                 interval, mode and overrun policy
     Args: A pointer to the task
     Return Value: 1 if the time was updated successfully, 0 otherwise
     Time Complexity: O(1)
@@ -85,4 +242,13 @@ int TaskIsMatch(const task_t* task1, const task_t* task2);
 */
 int TaskUpdateTimeToRun(task_t* task);
 
+/*
+    Description: Reads the clock the tasks are scheduled on
+    Args: None
+    Return Value: The current CLOCK_MONOTONIC time in nanoseconds, 0 on failure
+    Time Complexity: O(1)
+    Space Complexity: O(1)
+*/
+task_time_t TaskTimeNow(void);
+
 #endif /* end of header guard */
@@ -0,0 +1,149 @@
+/*
+    Version 1.2.0
+*/
+
+#ifndef __THEAP_H__
+#define __THEAP_H__
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+#define THEAP_NO_INDEX ((size_t)-1)
+
+/*Description: type definition to the timer heap ds - a binary min heap of
+                {deadline, data} records stored inline in one array.
+                Deadlines are compared directly, no comparator is called.*/
+typedef struct theap theap_t;
+/*Description: This function returns if a data is equals to the params.
+                Case there's a match - 1 is returns, 0 otherwise.*/
+typedef int (*theap_is_match_t)(void* data, void* params);
+
+/*
+    Description:        Creates the DS.
+    Args:               index_offset - offset of a size_t inside every data the
+                        heap keeps its position in (for THeapRemoveAt), or
+                        THEAP_NO_INDEX when positions are not tracked.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+theap_t* THeapCreate(size_t index_offset);
+
+/*
+    Description:        This function free all memory allocated by the DS.
+    Args:               heap - pointer to the DS.
+    Return value:       None.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void THeapDestroy(theap_t* heap);
+
+/*
+    Description:        Inserts data to expire at deadline.
+    Args:               heap - pointer to the DS.
+                        deadline - key of the data, smallest is popped first.
+                        data - pointer to the data to be stored.
+    Return value:       0 on Success, 1 on allocation failure.
+    Time complexity:    Amortized O(log n).
+    Space complexity:   Amortized O(1).
+*/
+int THeapPush(theap_t* heap, uint64_t deadline, void* data);
+
+/*
+    Description:        Inserts many data at once, each keyed by the uint64_t
+                        deadline stored deadline_offset bytes into it.
+                        A batch as large as the heap rebuilds the whole heap
+                        bottom-up in linear time instead of sifting each item.
+                        Nothing is inserted on allocation failure.
+    Args:               heap - pointer to the DS.
+                        data - array of pointers to the data to be stored.
+                        count - number of items in data.
+                        deadline_offset - offset of the deadline in every data.
+    Return value:       0 on Success, 1 on allocation failure.
+    Time complexity:    O(min(count * log n, n + count)).
+    Space complexity:   Amortized O(count).
+*/
+int THeapPushBulk(theap_t* heap, void* const* data, size_t count, size_t deadline_offset);
+
+/*
+    Description:        Removes the data with the earliest deadline.
+                        Case heap is empty - NULL is returned.
+    Args:               heap - pointer to the DS.
+    Return value:       Pointer to the removed data.
+    Time complexity:    O(log n).
+    Space complexity:   O(1).
+*/
+void* THeapPop(theap_t* heap);
+
+/*
+    Description:        Returns the data with the earliest deadline.
+                        Case heap is empty - NULL is returned.
+    Args:               heap - pointer to the DS.
+    Return value:       Pointer to the data.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void* THeapPeek(const theap_t* heap);
+
+/*
+    Description:        Returns the earliest deadline.
+                        Case heap is empty - UINT64_MAX is returned.
+    Args:               heap - pointer to the DS.
+    Return value:       The earliest deadline.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+uint64_t THeapPeekDeadline(const theap_t* heap);
+
+/*
+    Description:        Removes the data at a position reported through
+                        index_offset.
+    Args:               heap - pointer to the DS.
+                        index - position of the data to remove.
+    Return value:       Pointer to the removed data.
+    Time complexity:    O(log n).
+    Space complexity:   O(1).
+*/
+void* THeapRemoveAt(theap_t* heap, size_t index);
+
+/*
+    Description:        This function finds a value according to param supplied.
+                        (Refer theap_is_match_t)
+    Return value:       Pointer to the found item on success, NULL otherwise.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+void* THeapFind(theap_t* heap, theap_is_match_t is_match, void* params);
+
+/*
+    Description:        Removes every data is_match returns 1 for and rebuilds
+                        the heap once. is_match may free the data it matches,
+                        the heap doesn't touch it again.
+    Args:               heap - pointer to the DS.
+                        is_match - called once per data.
+                        params - passed to is_match as is.
+    Return value:       Number of removed items.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+size_t THeapRemoveIf(theap_t* heap, theap_is_match_t is_match, void* params);
+
+/*
+    Description:        Returns the amount of items within the ds.
+    Args:               heap - pointer to the ds.
+    Return value:       Amount of items within the ds.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+size_t THeapSize(const theap_t* heap);
+
+/*
+    Description:        Returns if heap has no items within the ds.
+    Args:               heap - pointer to the ds.
+    Return value:       1 if true, 0 otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+int THeapIsEmpty(const theap_t* heap);
+
+#endif /* __THEAP_H__*/
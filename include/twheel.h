@@ -0,0 +1,146 @@
+/*
+    Version 1.1.0
+*/
+
+#ifndef __TWHEEL_H__
+#define __TWHEEL_H__
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+/*Description: type definition to the hierarchical timing wheel ds.
+                Deadlines are absolute and given in nanoseconds, they are
+                rounded up to the wheel's tick.*/
+typedef struct twheel twheel_t;
+/*Description: handle to an element stored in the wheel, valid until the
+                element is removed or popped.*/
+typedef struct twheel_node twheel_node_t;
+/*Description: This function returns if a data is equals to the params.
+                Case there's a match - 1 is returns, 0 otherwise.*/
+typedef int (*twheel_is_match_t)(void* data, void* params);
+
+/*
+    Description:        Creates the DS.
+                        This function allocates and initiate the DS.
+    Args:               tick - resolution of the wheel in nanoseconds.
+                        now - current time in nanoseconds.
+    Return value:       Pointer to the DS on success, NULL otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+twheel_t* TWheelCreate(uint64_t tick, uint64_t now);
+
+/*
+    Description:        This function free all memory allocated by the DS.
+    Args:               wheel - pointer to the DS.
+    Return value:       None.
+    Time complexity:    O(n / block size).
+    Space complexity:   O(1).
+*/
+void TWheelDestroy(twheel_t* wheel);
+
+/*
+    Description:        Insert data to the wheel to expire at deadline.
+                        A deadline in the past expires on the next advance.
+    Args:               wheel - pointer to the ds.
+                        data - pointer to the data to be stored.
+                        deadline - expiry time in nanoseconds.
+    Return value:       Handle to the stored element, NULL on allocation failure.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+twheel_node_t* TWheelInsert(twheel_t* wheel, void* data, uint64_t deadline);
+
+/*
+    Description:        Removes the element behind a handle.
+    Args:               wheel - pointer to the ds.
+                        node - handle returned by TWheelInsert.
+    Return value:       Pointer to the removed data.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void* TWheelRemove(twheel_t* wheel, twheel_node_t* node);
+
+/*
+    Description:        This function finds a value according to param supplied.
+                        (Refer twheel_is_match)
+    Return value:       Pointer to the found item on success, NULL otherwise.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+void* TWheelFind(twheel_t* wheel, twheel_is_match_t is_match, void* params);
+
+/*
+    Description:        Removes every element is_match returns 1 for, their
+                        handles become invalid. is_match may free the data it
+                        matches, the wheel doesn't touch it again.
+    Args:               wheel - pointer to the ds.
+                        is_match - called once per element.
+                        params - passed to is_match as is.
+    Return value:       Number of removed elements.
+    Time complexity:    O(n).
+    Space complexity:   O(1).
+*/
+size_t TWheelRemoveIf(twheel_t* wheel, twheel_is_match_t is_match, void* params);
+
+/*
+    Description:        Moves the wheel's time forward to now, every element
+                        whose deadline passed becomes expired.
+    Args:               wheel - pointer to the ds.
+                        now - current time in nanoseconds.
+    Return value:       None.
+    Time complexity:    Amortized O(1) per element.
+    Space complexity:   O(1).
+*/
+void TWheelAdvance(twheel_t* wheel, uint64_t now);
+
+/*
+    Description:        Removes an expired element, in expiry order per tick.
+    Args:               wheel - pointer to the ds.
+    Return value:       Pointer to the expired data, NULL if nothing expired.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+void* TWheelPopExpired(twheel_t* wheel);
+
+/*
+    Description:        Removes any element, expired or not.
+                        Case wheel is empty - NULL is returned.
+    Args:               wheel - pointer to the ds.
+    Return value:       Pointer to the removed data.
+    Time complexity:    O(levels).
+    Space complexity:   O(1).
+*/
+void* TWheelPop(twheel_t* wheel);
+
+/*
+    Description:        Returns the next time the wheel has work to do, either
+                        an expiry or a cascade of a higher level. It is never
+                        later than the earliest deadline in the wheel.
+                        Case wheel is empty - UINT64_MAX is returned.
+    Args:               wheel - pointer to the ds.
+    Return value:       Time in nanoseconds.
+    Time complexity:    O(levels).
+    Space complexity:   O(1).
+*/
+uint64_t TWheelNextExpiry(const twheel_t* wheel);
+
+/*
+    Description:        Returns the amount of items within the ds.
+    Args:               wheel - pointer to the ds.
+    Return value:       Amount of items within the ds.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+size_t TWheelSize(const twheel_t* wheel);
+
+/*
+    Description:        Returns if wheel has no items within the ds.
+    Args:               wheel - pointer to the ds.
+    Return value:       1 if true, 0 otherwise.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+int TWheelIsEmpty(const twheel_t* wheel);
+
+#endif /* __TWHEEL_H__*/
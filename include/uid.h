@@ -1,16 +1,13 @@
 #ifndef __UID_H__
 #define __UID_H__
 
-#include <stddef.h>
-#include <time.h>
-#include <sys/types.h>
+#include <stdint.h> /* uint64_t */
 
+/* 128 bits - the creating host and process, and a counter unique within the process */
 typedef struct UID
 {
-    time_t time;
-    size_t counter;
-    pid_t pid;
-    unsigned char ip[14];
+    uint64_t high; /* IPv4 address of the host << 32 | pid */
+    uint64_t low;  /* process key time (seconds, 24 bits) << 40 | counter */
 } UID_t;
 
 extern const UID_t BadUID;
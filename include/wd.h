@@ -1,5 +1,5 @@
 /*
-    Version 4.0.0
+    Version 4.5.0
 */
 
 #ifndef __WD_H__
@@ -15,10 +15,50 @@ typedef enum wd_status
     FORK_FAILED,
     SEM_OPEN_FAILED,
     SCHEDULER_FAILED,
-    THREAD_CREATION_FAILED
+    THREAD_CREATION_FAILED,
+    PING_EVENT_FAILED,
+    HEARTBEAT_FAILED,
+    DAEMON_ATTACH_FAILED
 } wd_status_t;
 
+/* how the user process and the watchdog ping each other */
+typedef enum wd_transport
+{
+    WD_TRANSPORT_SHM = 0, /* counters in a shared-memory region, no syscall per ping */
+    WD_TRANSPORT_SIGNAL,  /* SIGUSR1 per ping */
+    WD_TRANSPORT_DAEMON   /* no watchdog process, a slot in the table of wd_daemon.out */
+} wd_transport_t;
+
+typedef struct wd_config
+{
+    size_t interval;        /* seconds per ping check window */
+    unsigned int tolerance; /* missed windows before a revive */
+    wd_transport_t transport;
+    int warm_standby;       /* non-zero - a spare watchdog waits parked, a revive only wakes it */
+    double phi_threshold;   /* > 0 - adaptive detection: a revive once the phi of the peer's
+                               silence crosses it, tolerance is unused. Shared-memory transport only */
+    int kick_report_only;   /* non-zero - a registered thread past its deadline is only reported,
+                               the user process is not restarted */
+} wd_config_t;
+
+/* same as WDStartWithConfig with the shared-memory transport, or with
+   WD_TRANSPORT_DAEMON when WD_DAEMON_ENV names the daemon's table.
+   WD_STANDBY_ENV turns on warm_standby, WD_PHI_ENV sets phi_threshold,
+   WD_KICK_REPORT_ENV turns on kick_report_only */
 wd_status_t WDStart(int argc, const char* argv[], size_t interval, unsigned int tolerance);
+wd_status_t WDStartWithConfig(int argc, const char* argv[], const wd_config_t* config);
 void WDStop();
 
+/* the calling thread promises a WDKick at least every deadline_ms. The
+   watchdog process checks it and restarts the user process (or only reports,
+   see kick_report_only) when the thread stalls. name shows in the report.
+   After WDStart, not in daemon mode. 0 on success, -1 without a free slot */
+int WDRegisterThread(const char* name, size_t deadline_ms);
+
+/* progress of the calling thread - one relaxed store, a no-op if it is not registered */
+void WDKick(void);
+
+/* the calling thread is not checked any more */
+void WDUnregisterThread(void);
+
 #endif /*__WD_H__*/
@@ -2,9 +2,9 @@
 #define WD_COMMON_H
 
 #include <semaphore.h> /* sem_t */
-#include <stdatomic.h> /* atomic_int */
 
 #include "scheduler.h" /* scheduler API */
+#include "wd_kick.h"   /* kick_slot_t */
 
 #define TRUE (1)
 #define FALSE (0)
@@ -18,12 +18,26 @@
 #define WD_SEM "/wd_semaphore"
 #define USER_SEM "/user_semaphore"
 
+/* Heartbeat table of the watchdog daemon */
+#define DAEMON_TABLE "/wd_daemon"
+
 /* Process Names */
 #define WD_PROCESS "./wd_process.out"
 #define USER_PROCESS "./user_wd.out"
+#define DAEMON_PROCESS "./wd_daemon.out"
 
-/* Environment variable */
+/* Environment variables */
 #define PID_ENV "PID_ENV"
+#define HEARTBEAT_ENV "HEARTBEAT_ENV" /* shm heartbeat region, unset for signals */
+#define DAEMON_ENV "WD_DAEMON_ENV"     /* set - WDStart attaches to the daemon's table */
+#define STANDBY_ENV "WD_STANDBY_ENV"   /* set - WDStart keeps a parked spare watchdog */
+#define STANDBY_FD_ENV "WD_STANDBY_FD_ENV" /* activation socket of a spare watchdog */
+#define METRICS_ENV "WD_METRICS_ENV"   /* metrics page of the pair, kept over restarts */
+#define LOG_ENV "WD_LOG_ENV"           /* prefix of the flight log files, unset - no log */
+#define KICKS_ENV "WD_KICKS_ENV"       /* progress slots of the user's threads, kept over restarts */
+#define KICK_REPORT_ENV "WD_KICK_REPORT_ENV" /* set - a stalled thread is reported, not restarted */
+#define PHI_ENV "WD_PHI_ENV"           /* phi threshold of the adaptive detector, unset - tolerance windows */
+#define LOG_LEVEL_ENV "WD_LOG_LEVEL_ENV" /* lowest level logged, 0 (debug) to 4 (off) */
 
 typedef struct watchdog_data
 {
@@ -32,14 +46,30 @@ typedef struct watchdog_data
     size_t interval;
     unsigned int tolerance;
     int is_watchdog;  /* TRUE if watchdog process, FALSE if user process */
+    double phi_threshold; /* > 0 - the peer fails once phi crosses it, not after tolerance windows */
+    int kick_report_only; /* TRUE - a stalled thread of the user is reported, the user is not restarted */
 } watchdog_data_t;
 
 int SendPingSignal(void* args);
 int CheckPingResponse(void* args);
+int AddMonitorTasks(watchdog_data_t* data, size_t check_interval);
+int AddPingTask(watchdog_data_t* data);
 void CleanupResources(scheduler_t* scheduler, char** argv, sem_t* wd_sem, sem_t* user_sem);
 void HandleSignal(int sig);
 int SetupSemaphores(sem_t** wd_sem, sem_t** user_sem, int is_watchdog);
-
-extern atomic_int signal_flag;
+int SetupPingEvent(void);
+int SetupHeartbeat(int is_watchdog);
+int SetupDaemonClient(size_t interval, unsigned int tolerance);
+int WatchPeer(watchdog_data_t* data, pid_t pid);
+int ParkStandby(int fd);
+int ActivateStandby(int fd);
+int SetupMetrics(int is_watchdog);
+void MarkRestartBegin(int is_watchdog);
+void MarkRestartDone(int is_watchdog);
+int SetupLog(int is_watchdog);
+int SetupKicks(int is_watchdog);
+kick_slot_t* TakeKickSlot(const char* name, size_t deadline_ms);
+int WatchKicks(watchdog_data_t* data);
+int KillPeer(void);
 
 #endif /* WD_COMMON_H */
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef WD_HEARTBEAT_H
+#define WD_HEARTBEAT_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t, uint64_t */
+
+/* Shared-memory heartbeat channel between the user process and its watchdog.
+   Every side owns a counter in the region: a heartbeat is an atomic increment
+   plus a timestamp, a check is a read - the futex on the counter is only
+   touched when the peer is parked waiting for a beat. */
+
+typedef struct heartbeat heartbeat_t;
+
+typedef enum heartbeat_side
+{
+    HEARTBEAT_USER = 0,
+    HEARTBEAT_WATCHDOG = 1
+} heartbeat_side_t;
+
+/* maps the region called name (a "/name" as for shm_open), is_owner creates a
+   fresh zeroed region, otherwise an existing one is attached. NULL on failure */
+heartbeat_t* HeartbeatOpen(const char* name, int is_owner);
+
+/* unmaps the region, name is unlinked when not NULL */
+void HeartbeatClose(heartbeat_t* heartbeat, const char* name);
+
+/* publishes a heartbeat of side - no syscall unless the peer is waiting */
+void HeartbeatBeat(heartbeat_t* heartbeat, heartbeat_side_t side);
+
+/* wakes a HeartbeatWait on side like a beat, without a timestamp - for a
+   waiter that must stop waiting for a peer known to be gone */
+void HeartbeatWake(heartbeat_t* heartbeat, heartbeat_side_t side);
+
+/* 1 as soon as side beat since *seen (*seen is updated), 0 when interval_sec
+   seconds passed on the monotonic clock without a beat */
+int HeartbeatWait(heartbeat_t* heartbeat, heartbeat_side_t side, uint32_t* seen, size_t interval_sec);
+
+/* HeartbeatWait up to deadline, a CLOCK_MONOTONIC ns - a beat already there wins over a past deadline */
+int HeartbeatWaitUntil(heartbeat_t* heartbeat, heartbeat_side_t side, uint32_t* seen, uint64_t deadline);
+
+/* CLOCK_MONOTONIC ns of the last beat of side, 0 if it never beat */
+uint64_t HeartbeatLastNs(const heartbeat_t* heartbeat, heartbeat_side_t side);
+
+#endif /* WD_HEARTBEAT_H */
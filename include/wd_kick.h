@@ -0,0 +1,48 @@
+#ifndef WD_KICK_H
+#define WD_KICK_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+/* Shared-memory progress slots of the threads of a user process.
+   A thread claims a slot with its deadline and then only bumps the kick
+   count of the slot - one relaxed store, its own cache line. The watchdog
+   process samples the counts and finds the threads whose count stood
+   still for longer than their deadline. */
+
+#define KICK_SLOTS (64)
+#define KICK_NAME_LEN (16)
+
+typedef struct kick_table kick_table_t;
+typedef struct kick_slot kick_slot_t;
+
+/* what KickScan found in one slot */
+typedef struct kick_state
+{
+    uint64_t generation; /* changes when the slot is claimed again */
+    uint64_t kicks;
+    uint64_t deadline_ns;
+    int tid;
+    char name[KICK_NAME_LEN];
+} kick_state_t;
+
+/* maps the table called name (a "/name" as for shm_open), is_owner creates a
+   fresh empty table, otherwise an existing one is attached. NULL on failure */
+kick_table_t* KickOpen(const char* name, int is_owner);
+
+/* unmaps the table, name is unlinked when not NULL */
+void KickClose(kick_table_t* table, const char* name);
+
+/* a slot of the calling thread, NULL when all are taken */
+kick_slot_t* KickClaim(kick_table_t* table, const char* name, uint64_t deadline_ns);
+
+/* frees a slot - it is not checked any more */
+void KickRelease(kick_slot_t* slot);
+
+/* progress of the thread owning slot, only ever called by that thread */
+void Kick(kick_slot_t* slot);
+
+/* state of slot index, 0 if it is free */
+int KickScan(const kick_table_t* table, int index, kick_state_t* state);
+
+#endif /* WD_KICK_H */
@@ -0,0 +1,79 @@
+#ifndef WD_LOG_H
+#define WD_LOG_H
+
+#include <stddef.h>    /* size_t */
+#include <stdint.h>    /* uint64_t, int64_t */
+#include <sys/types.h> /* pid_t */
+
+/* Binary flight log of a watchdog process.
+   A record is a fixed event id plus two integer arguments, written into a
+   ring of the calling thread inside a file mapped once per process - no
+   lock, no stdio, no allocation, so it may be called from a signal handler.
+   The text is only made by an offline decoder, which also reads the log of
+   a crashed or killed process. */
+
+typedef enum log_level
+{
+    LOG_DEBUG = 0,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_OFF
+} log_level_t;
+
+typedef enum log_event
+{
+    LOG_HEARTBEAT_SENT = 0,
+    LOG_PING_SENT,          /* target pid */
+    LOG_CHECK_STARTED,      /* interval, tolerance */
+    LOG_PING_RECEIVED,
+    LOG_WINDOW_MISSED,      /* tolerance left */
+    LOG_PEER_EXITED,
+    LOG_PEER_UNRESPONSIVE,
+    LOG_STOP_SIGNAL,        /* signal */
+    LOG_PEER_SUSPECTED,     /* ms without a beat, phi threshold x1000 */
+    LOG_THREAD_STALLED,     /* tid, ms without a kick */
+    LOG_EVENTS
+} log_event_t;
+
+/* a record as read back by LogRead */
+typedef struct log_entry
+{
+    uint64_t time_ns; /* CLOCK_MONOTONIC - comparable between processes */
+    int64_t args[2];
+    log_event_t event;
+    log_level_t level;
+    pid_t pid;
+    pid_t tid;
+    int is_watchdog;
+} log_entry_t;
+
+/* records below it are dropped - LOG_OFF until LogOpen */
+extern int log_level_g;
+
+/* a disabled level costs the one compare */
+#define WD_LOG(level, event, arg0, arg1)                           \
+    do                                                             \
+    {                                                              \
+        if ((int)(level) >= log_level_g)                           \
+        {                                                          \
+            LogWrite((level), (event), (arg0), (arg1));            \
+        }                                                          \
+    } while (0)
+
+/* creates the log file <prefix>.<pid>.<start ns> of this process and maps it
+   for the rest of its life. 0 on success (also if already open), -1 on failure */
+int LogOpen(const char* prefix, int is_watchdog, log_level_t level);
+
+/* async-signal-safe. Dropped when the thread finds no free ring */
+void LogWrite(log_level_t level, log_event_t event, int64_t arg0, int64_t arg1);
+
+/* appends the records of the log file at path to *entries (realloc'd, *count
+   updated) - lost is set to the records overwritten or dropped. 0 on
+   success, -1 if path is not a readable log file */
+int LogRead(const char* path, log_entry_t** entries, size_t* count, uint64_t* lost);
+
+/* printf format of event, taking the two arguments as long */
+const char* LogFormat(log_event_t event);
+
+#endif /* WD_LOG_H */
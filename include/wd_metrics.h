@@ -0,0 +1,55 @@
+#ifndef WD_METRICS_H
+#define WD_METRICS_H
+
+#include <stdio.h>  /* FILE */
+#include <stdint.h> /* uint64_t */
+
+/* Shared-memory metrics page of a watchdog pair.
+   Each side counts into its own cache line with relaxed atomic adds - no
+   lock, no syscall. The page outlives restarts of either process, it is
+   found again by name, and an exporter reads it from outside the pair. */
+
+#define METRICS_BUCKETS (24) /* heartbeat latency <= 2^i us, the last is +Inf */
+
+typedef struct metrics metrics_t;
+
+typedef enum metrics_side
+{
+    METRICS_USER = 0,
+    METRICS_WATCHDOG = 1
+} metrics_side_t;
+
+typedef enum metrics_counter
+{
+    METRICS_PINGS_SENT = 0,
+    METRICS_PINGS_RECEIVED,
+    METRICS_MISSED_WINDOWS,
+    METRICS_RESTARTS,     /* peers this side started again */
+    METRICS_RESTART_NS,   /* total time from a failure found to the peer monitoring again */
+    METRICS_THREAD_STALLS, /* registered threads of the user found without progress */
+    METRICS_COUNTERS
+} metrics_counter_t;
+
+/* maps the page called name (a "/name" as for shm_open). A writer creates
+   it when missing and keeps the counters of an existing one, a reader only
+   attaches. NULL on failure */
+metrics_t* MetricsOpen(const char* name, int is_writer);
+
+/* unmaps the page, name is unlinked when not NULL */
+void MetricsClose(metrics_t* metrics, const char* name);
+
+void MetricsAdd(metrics_t* metrics, metrics_side_t side, metrics_counter_t counter, uint64_t value);
+
+/* latency_ns from a peer's heartbeat to side noticing it */
+void MetricsObserveLatency(metrics_t* metrics, metrics_side_t side, uint64_t latency_ns);
+
+/* side found its peer failed - counted as a restart, timed until MetricsRestartDone */
+void MetricsRestartBegin(metrics_t* metrics, metrics_side_t side);
+
+/* ends the restart of side begun last, if any - may run in another process */
+void MetricsRestartDone(metrics_t* metrics, metrics_side_t side);
+
+/* the page in the Prometheus text format. 0 on success, -1 on a write error */
+int MetricsPrint(const metrics_t* metrics, FILE* out);
+
+#endif /* WD_METRICS_H */
@@ -0,0 +1,38 @@
+#ifndef WD_PHI_H
+#define WD_PHI_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint32_t, uint64_t */
+
+/* Phi-accrual failure detector (Hayashibara et al.).
+   The intervals between a peer's heartbeats are modelled as a normal
+   distribution over the last PHI_WINDOW of them. phi is -log10 of the
+   chance that a live peer stays silent this long - 1 is a 10% chance,
+   8 is one in 10^8. The threshold so trades detection time for false
+   suspicions, and the model widens by itself under bursty load. */
+
+#define PHI_WINDOW (64)
+
+typedef struct phi_detector
+{
+    uint64_t samples[PHI_WINDOW]; /* ns between beats, a ring */
+    size_t count;
+    size_t next;
+    uint64_t min_stddev_ns; /* a perfectly steady peer still gets some slack */
+    uint64_t last_ns;       /* latest beat, or the start before the first one */
+    uint64_t arrivals;
+} phi_detector_t;
+
+/* starts a model of a peer beating every expected_ns, from now_ns on */
+void PhiInit(phi_detector_t* detector, uint64_t expected_ns, uint64_t now_ns);
+
+/* the peer beat at arrival_ns, beats times since the previous arrival */
+void PhiArrival(phi_detector_t* detector, uint64_t arrival_ns, uint32_t beats);
+
+/* suspicion of the peer at now_ns */
+double Phi(const phi_detector_t* detector, uint64_t now_ns);
+
+/* the time at which phi reaches threshold if no beat comes before */
+uint64_t PhiSuspectAt(const phi_detector_t* detector, double threshold);
+
+#endif /* WD_PHI_H */
@@ -0,0 +1,58 @@
+#ifndef WD_TABLE_H
+#define WD_TABLE_H
+
+#include <stddef.h>    /* size_t */
+#include <stdint.h>    /* uint32_t, uint64_t */
+#include <sys/types.h> /* pid_t */
+
+/* Shared-memory heartbeat table of the watchdog daemon.
+   A client claims a slot by setting its bit in the claimed bitmap, then
+   beats the slot's counter - one atomic increment, no syscall. The daemon
+   finds new clients by scanning the bitmap 64 slots per word and reads the
+   counters on its own schedule. Slots nobody claimed are never touched,
+   so the resident size grows with the clients, not the capacity. */
+
+#define TABLE_CAPACITY (16384)
+#define TABLE_WORDS (TABLE_CAPACITY / 64)
+#define TABLE_NO_SLOT (-1)
+
+typedef struct table table_t;
+
+typedef struct table_client
+{
+    pid_t pid;
+    uint32_t generation; /* changes on every claim of the slot */
+    uint64_t interval_ns;
+    unsigned int tolerance;
+} table_client_t;
+
+/* maps the table called name (a "/name" as for shm_open), is_owner (the
+   daemon) creates a fresh empty table, otherwise it is attached. NULL on failure */
+table_t* TableOpen(const char* name, int is_owner);
+
+/* unmaps the table, name is unlinked when not NULL */
+void TableClose(table_t* table, const char* name);
+
+/* claims a free slot for pid, checked every interval_ns and revived after
+   tolerance missed checks. The slot and its *generation, TABLE_NO_SLOT when
+   the table is full */
+int TableClaim(table_t* table, pid_t pid, uint64_t interval_ns, unsigned int tolerance, uint32_t* generation);
+
+/* frees the slot if it still holds the claim of generation, the daemon stops
+   watching it. 0 on success, 1 if the claim was released already */
+int TableRelease(table_t* table, int slot, uint32_t generation);
+
+/* publishes a heartbeat of the slot's client */
+void TableBeat(table_t* table, int slot);
+
+/* heartbeats of the slot so far, wraps */
+uint32_t TableBeats(const table_t* table, int slot);
+
+/* bit i is set if slot word * 64 + i is claimed */
+uint64_t TableClaimedWord(const table_t* table, size_t word);
+
+/* 0 and the registration of the slot's client, 1 if the slot is free or
+   its client did not finish claiming yet */
+int TableGetClient(const table_t* table, int slot, table_client_t* client);
+
+#endif /* WD_TABLE_H */
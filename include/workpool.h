@@ -0,0 +1,60 @@
+/*
+    Version 1.0.0
+*/
+
+#ifndef __WORKPOOL_H__
+#define __WORKPOOL_H__
+
+#include <stddef.h> /* size_t */
+
+/*Description: This function runs a single job on a worker thread.
+                context is the pointer given to WorkPoolCreate.*/
+typedef void (*workpool_run_t)(void* job, void* context);
+/*Description: type definition to the work-stealing thread pool.
+                Each worker owns a deque, jobs are spread between the deques
+                and idle workers steal from the others.*/
+typedef struct workpool workpool_t;
+
+/*
+    Description:        Creates the pool and starts its worker threads.
+    Args:               n_workers - number of worker threads (at least 1).
+                        run - function every job is run with.
+                        context - passed to run as is.
+    Return value:       Pointer to the pool on success, NULL otherwise.
+    Time complexity:    O(n_workers).
+    Space complexity:   O(n_workers).
+*/
+workpool_t* WorkPoolCreate(size_t n_workers, workpool_run_t run, void* context);
+
+/*
+    Description:        Runs every submitted job, stops the workers and frees
+                        all memory allocated by the pool.
+    Args:               pool - pointer to the pool.
+    Return value:       None.
+    Time complexity:    O(jobs left).
+    Space complexity:   O(1).
+*/
+void WorkPoolDestroy(workpool_t* pool);
+
+/*
+    Description:        Queues a job on the next worker's deque and wakes an
+                        idle worker. A worker runs its own jobs in the order
+                        they were submitted. Only one thread may submit at a time.
+    Args:               pool - pointer to the pool.
+                        job - pointer passed to run.
+    Return value:       0 on Success, 1 on allocation failure.
+    Time complexity:    Amortized O(1).
+    Space complexity:   Amortized O(1).
+*/
+int WorkPoolSubmit(workpool_t* pool, void* job);
+
+/*
+    Description:        Returns the number of worker threads.
+    Args:               pool - pointer to the pool.
+    Return value:       Number of workers.
+    Time complexity:    O(1).
+    Space complexity:   O(1).
+*/
+size_t WorkPoolSize(const workpool_t* pool);
+
+#endif /* __WORKPOOL_H__*/
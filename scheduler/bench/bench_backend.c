@@ -0,0 +1,261 @@
+/*
+    Scheduler queue backends under a periodic-task load:
+    generic binary heap (pqueue), inline timer heap (theap) and
+    hierarchical timing wheel.
+
+    For every queue size the benchmark measures
+        insert     - ns per insert of a new periodic timer
+        reschedule - ns per expiry + re-insert at the next period
+        cancel     - ns per removal of a live timer
+
+    usage: ./bench_backend.out [n1 n2 ...]   (default 1000 100000 1000000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stddef.h> /* offsetof */
+#include <time.h>   /* clock_gettime */
+
+#include "pqueue.h"
+#include "theap.h"
+#include "twheel.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define TICK_NS (1000000ULL)          /* 1ms */
+#define MAX_PERIOD_TICKS (1000)       /* periods up to 1s */
+#define RESCHEDULES_PER_TIMER (4)
+
+typedef struct bench_timer
+{
+    uint64_t deadline;
+    uint64_t period;
+    twheel_node_t* node;
+    size_t heap_index;
+    int is_live;
+} bench_timer_t;
+
+typedef struct bench_result
+{
+    double insert_ns;
+    double reschedule_ns;
+    double cancel_ns;
+} bench_result_t;
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t NextRandom(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return seed;
+}
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static int CompareTimers(void* timer1, void* timer2)
+{
+    uint64_t deadline1 = ((bench_timer_t*)timer1)->deadline;
+    uint64_t deadline2 = ((bench_timer_t*)timer2)->deadline;
+
+    return (deadline1 > deadline2) - (deadline1 < deadline2);
+}
+
+static void SetHeapIndex(void* timer, size_t index)
+{
+    ((bench_timer_t*)timer)->heap_index = index;
+}
+
+static void InitTimers(bench_timer_t* timers, size_t n)
+{
+    size_t i = 0;
+
+    seed = 88172645463325252ULL;
+    for (i = 0; i < n; ++i)
+    {
+        timers[i].period = (1 + NextRandom() % MAX_PERIOD_TICKS) * TICK_NS;
+        timers[i].deadline = NextRandom() % timers[i].period;
+        timers[i].node = NULL;
+        timers[i].is_live = 1;
+    }
+}
+
+static bench_result_t BenchHeap(bench_timer_t* timers, size_t n)
+{
+    bench_result_t result = {0};
+    pqueue_t* queue = PQCreateIndexed(CompareTimers, SetHeapIndex);
+    size_t reschedules = n * RESCHEDULES_PER_TIMER;
+    size_t cancels = n / 10;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    InitTimers(timers, n);
+
+    start = NowNs();
+    for (i = 0; i < n; ++i)
+    {
+        PQEnqueue(queue, &timers[i]);
+    }
+    result.insert_ns = (double)(NowNs() - start) / n;
+
+    start = NowNs();
+    for (i = 0; i < reschedules; ++i)
+    {
+        bench_timer_t* timer = (bench_timer_t*)PQDequeue(queue);
+        timer->deadline += timer->period;
+        PQEnqueue(queue, timer);
+    }
+    result.reschedule_ns = (double)(NowNs() - start) / reschedules;
+
+    start = NowNs();
+    for (i = 0; i < cancels; ++i)
+    {
+        bench_timer_t* timer = &timers[(i * 7919) % n];
+        if (timer->is_live)
+        {
+            PQEraseAt(queue, timer->heap_index);
+            timer->is_live = 0;
+        }
+    }
+    result.cancel_ns = (0 == cancels) ? 0 : (double)(NowNs() - start) / cancels;
+
+    PQDestroy(queue);
+
+    return result;
+}
+
+static bench_result_t BenchTimerHeap(bench_timer_t* timers, size_t n)
+{
+    bench_result_t result = {0};
+    theap_t* heap = THeapCreate(offsetof(bench_timer_t, heap_index));
+    size_t reschedules = n * RESCHEDULES_PER_TIMER;
+    size_t cancels = n / 10;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    InitTimers(timers, n);
+
+    start = NowNs();
+    for (i = 0; i < n; ++i)
+    {
+        THeapPush(heap, timers[i].deadline, &timers[i]);
+    }
+    result.insert_ns = (double)(NowNs() - start) / n;
+
+    start = NowNs();
+    for (i = 0; i < reschedules; ++i)
+    {
+        bench_timer_t* timer = (bench_timer_t*)THeapPop(heap);
+        timer->deadline += timer->period;
+        THeapPush(heap, timer->deadline, timer);
+    }
+    result.reschedule_ns = (double)(NowNs() - start) / reschedules;
+
+    start = NowNs();
+    for (i = 0; i < cancels; ++i)
+    {
+        bench_timer_t* timer = &timers[(i * 7919) % n];
+        if (timer->is_live)
+        {
+            THeapRemoveAt(heap, timer->heap_index);
+            timer->is_live = 0;
+        }
+    }
+    result.cancel_ns = (0 == cancels) ? 0 : (double)(NowNs() - start) / cancels;
+
+    THeapDestroy(heap);
+
+    return result;
+}
+
+static bench_result_t BenchWheel(bench_timer_t* timers, size_t n)
+{
+    bench_result_t result = {0};
+    twheel_t* wheel = TWheelCreate(TICK_NS, 0);
+    size_t reschedules = n * RESCHEDULES_PER_TIMER;
+    size_t cancels = n / 10;
+    size_t done = 0;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    InitTimers(timers, n);
+
+    start = NowNs();
+    for (i = 0; i < n; ++i)
+    {
+        timers[i].node = TWheelInsert(wheel, &timers[i], timers[i].deadline);
+    }
+    result.insert_ns = (double)(NowNs() - start) / n;
+
+    start = NowNs();
+    while (done < reschedules)
+    {
+        bench_timer_t* timer = NULL;
+
+        TWheelAdvance(wheel, TWheelNextExpiry(wheel));
+        while (done < reschedules && NULL != (timer = (bench_timer_t*)TWheelPopExpired(wheel)))
+        {
+            timer->deadline += timer->period;
+            timer->node = TWheelInsert(wheel, timer, timer->deadline);
+            ++done;
+        }
+    }
+    result.reschedule_ns = (double)(NowNs() - start) / reschedules;
+
+    start = NowNs();
+    for (i = 0; i < cancels; ++i)
+    {
+        bench_timer_t* timer = &timers[(i * 7919) % n];
+        if (NULL != timer->node)
+        {
+            TWheelRemove(wheel, timer->node);
+            timer->node = NULL;
+        }
+    }
+    result.cancel_ns = (0 == cancels) ? 0 : (double)(NowNs() - start) / cancels;
+
+    TWheelDestroy(wheel);
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {1000, 100000, 1000000};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t i = 0;
+
+    printf("backend,tasks,insert_ns,reschedule_ns,cancel_ns\n");
+    for (i = 0; i < count; ++i)
+    {
+        size_t n = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i];
+        bench_timer_t* timers = (bench_timer_t*)malloc(n * sizeof(bench_timer_t));
+        bench_result_t heap = {0};
+        bench_result_t timer_heap = {0};
+        bench_result_t wheel = {0};
+
+        if (NULL == timers)
+        {
+            return 1;
+        }
+
+        heap = BenchHeap(timers, n);
+        timer_heap = BenchTimerHeap(timers, n);
+        wheel = BenchWheel(timers, n);
+        printf("heap,%lu,%.1f,%.1f,%.1f\n", n, heap.insert_ns, heap.reschedule_ns, heap.cancel_ns);
+        printf("theap,%lu,%.1f,%.1f,%.1f\n", n, timer_heap.insert_ns, timer_heap.reschedule_ns, timer_heap.cancel_ns);
+        printf("wheel,%lu,%.1f,%.1f,%.1f\n", n, wheel.insert_ns, wheel.reschedule_ns, wheel.cancel_ns);
+
+        free(timers);
+    }
+
+    return 0;
+}
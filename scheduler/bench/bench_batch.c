@@ -0,0 +1,183 @@
+/*
+    Batch dispatch of tasks that fall due in the same tick.
+
+    dispatch - TASKS periodic tasks share one interval, each runs RUNS_PER_TASK
+               times. Reports the runner's CPU time per task run, waiting
+               excluded, so it is the cost of dequeue + run + re-insert.
+    build    - filling the scheduler one SchedulerAddTaskUs at a time vs. a
+               single SchedulerAddTasks, and the same for the bare timer heap
+               (THeapPush loop vs. THeapPushBulk) without task creation.
+
+    usage: ./bench_batch.out [n1 n2 ...]   (default 1000 10000 100000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <stddef.h> /* offsetof */
+#include <time.h>   /* clock_gettime */
+
+#include "scheduler.h"
+#include "theap.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define INTERVAL_US (1000)
+#define RUNS_PER_TASK (20)
+
+typedef struct bench_timer
+{
+    uint64_t deadline;
+    size_t heap_index;
+} bench_timer_t;
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t NextRandom(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return seed;
+}
+
+static uint64_t ClockNs(clockid_t clock)
+{
+    struct timespec now = {0};
+
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static int CountRuns(void* args)
+{
+    return ++*(size_t*)args < RUNS_PER_TASK;
+}
+
+static void FillDescs(scheduler_task_desc_t* descs, size_t* runs, size_t n)
+{
+    size_t i = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        runs[i] = 0;
+        descs[i].operation = CountRuns;
+        descs[i].args = &runs[i];
+        descs[i].interval_us = INTERVAL_US;
+        descs[i].cleanup_op = NULL;
+        descs[i].cleanup_args = NULL;
+    }
+}
+
+static double BenchDispatch(scheduler_task_desc_t* descs, size_t* runs, size_t n)
+{
+    scheduler_t* scheduler = SchedulerCreate();
+    uint64_t cpu = 0;
+
+    FillDescs(descs, runs, n);
+    SchedulerAddTasks(scheduler, descs, n, NULL);
+
+    cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+    SchedulerRun(scheduler);
+    cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+
+    SchedulerDestroy(scheduler);
+
+    return (double)cpu / (n * RUNS_PER_TASK);
+}
+
+/* is_bulk 0 adds one by one */
+static double BenchBuild(scheduler_task_desc_t* descs, size_t* runs, size_t n, int is_bulk)
+{
+    scheduler_t* scheduler = SchedulerCreate();
+    uint64_t start = 0;
+    size_t i = 0;
+
+    FillDescs(descs, runs, n);
+
+    start = ClockNs(CLOCK_MONOTONIC);
+    if (is_bulk)
+    {
+        SchedulerAddTasks(scheduler, descs, n, NULL);
+    }
+    else
+    {
+        for (i = 0; i < n; ++i)
+        {
+            SchedulerAddTaskUs(scheduler, descs[i].operation, descs[i].args, descs[i].interval_us, NULL, NULL);
+        }
+    }
+    start = ClockNs(CLOCK_MONOTONIC) - start;
+
+    SchedulerDestroy(scheduler);
+
+    return (double)start / n;
+}
+
+static double BenchHeapBuild(bench_timer_t* timers, void** pointers, size_t n, int is_bulk)
+{
+    theap_t* heap = THeapCreate(offsetof(bench_timer_t, heap_index));
+    uint64_t start = 0;
+    size_t i = 0;
+
+    seed = 88172645463325252ULL;
+    for (i = 0; i < n; ++i)
+    {
+        timers[i].deadline = NextRandom() % NSEC_PER_SEC;
+        pointers[i] = &timers[i];
+    }
+
+    start = ClockNs(CLOCK_MONOTONIC);
+    if (is_bulk)
+    {
+        THeapPushBulk(heap, pointers, n, offsetof(bench_timer_t, deadline));
+    }
+    else
+    {
+        for (i = 0; i < n; ++i)
+        {
+            THeapPush(heap, timers[i].deadline, &timers[i]);
+        }
+    }
+    start = ClockNs(CLOCK_MONOTONIC) - start;
+
+    THeapDestroy(heap);
+
+    return (double)start / n;
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {1000, 10000, 100000};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t i = 0;
+
+    printf("bench,tasks,ns_per_task\n");
+    for (i = 0; i < count; ++i)
+    {
+        size_t n = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i];
+        scheduler_task_desc_t* descs = (scheduler_task_desc_t*)malloc(n * sizeof(scheduler_task_desc_t));
+        size_t* runs = (size_t*)malloc(n * sizeof(size_t));
+        bench_timer_t* timers = (bench_timer_t*)malloc(n * sizeof(bench_timer_t));
+        void** pointers = (void**)malloc(n * sizeof(void*));
+
+        if (NULL == descs || NULL == runs || NULL == timers || NULL == pointers)
+        {
+            return 1;
+        }
+
+        printf("dispatch_cpu,%lu,%.1f\n", n, BenchDispatch(descs, runs, n));
+        printf("build_add_task,%lu,%.1f\n", n, BenchBuild(descs, runs, n, 0));
+        printf("build_add_tasks,%lu,%.1f\n", n, BenchBuild(descs, runs, n, 1));
+        printf("theap_push,%lu,%.1f\n", n, BenchHeapBuild(timers, pointers, n, 0));
+        printf("theap_push_bulk,%lu,%.1f\n", n, BenchHeapBuild(timers, pointers, n, 1));
+
+        free(descs);
+        free(runs);
+        free(timers);
+        free(pointers);
+    }
+
+    return 0;
+}
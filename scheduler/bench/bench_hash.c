@@ -0,0 +1,144 @@
+/*
+    UID index (open addressing hash table) at large sizes.
+
+    For every table size the benchmark measures, in random order
+        insert     - ns per insert into a table growing from empty
+        find_hit   - ns per lookup of a stored key
+        find_miss  - ns per lookup of a key that is not stored
+        remove     - ns per removal of a stored key
+
+    usage: ./bench_hash.out [n1 n2 ...]   (default 1000 100000 1000000 4000000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <time.h>   /* clock_gettime */
+
+#include "hash.h"
+#include "uid.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+
+typedef struct bench_entry
+{
+    UID_t id;
+    uint64_t payload;
+} bench_entry_t;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static size_t HashUID(const void* key)
+{
+    const UID_t* uid = (const UID_t*)key;
+
+    return (size_t)(uid->high ^ uid->low);
+}
+
+static int IsEntryOfUID(const void* entry, const void* key)
+{
+    return UIDIsEqual(((const bench_entry_t*)entry)->id, *(const UID_t*)key);
+}
+
+/* a random permutation - lookups don't walk the table in insertion order */
+static void Shuffle(size_t* order, size_t n)
+{
+    uint64_t seed = 88172645463325252ULL;
+    size_t i = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        order[i] = i;
+    }
+    for (i = n; i > 1; --i)
+    {
+        size_t j = 0;
+        size_t tmp = 0;
+
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        j = seed % i;
+        tmp = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = tmp;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {1000, 100000, 1000000, 4000000};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t i = 0;
+
+    printf("tasks,insert_ns,find_hit_ns,find_miss_ns,remove_ns\n");
+    for (i = 0; i < count; ++i)
+    {
+        size_t n = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i];
+        bench_entry_t* entries = (bench_entry_t*)malloc(n * sizeof(bench_entry_t));
+        size_t* order = (size_t*)malloc(n * sizeof(size_t));
+        hash_t* hash = HashCreate(HashUID, IsEntryOfUID);
+        volatile size_t found = 0;
+        double insert_ns = 0;
+        double hit_ns = 0;
+        double miss_ns = 0;
+        uint64_t start = 0;
+        UID_t missing = BadUID;
+        size_t j = 0;
+
+        if (NULL == entries || NULL == order || NULL == hash)
+        {
+            return 1;
+        }
+
+        for (j = 0; j < n; ++j)
+        {
+            entries[j].id = UIDCreate();
+        }
+        Shuffle(order, n);
+
+        start = NowNs();
+        for (j = 0; j < n; ++j)
+        {
+            HashInsert(hash, &entries[order[j]].id, &entries[order[j]]);
+        }
+        insert_ns = (double)(NowNs() - start) / n;
+
+        Shuffle(order, n);
+        start = NowNs();
+        for (j = 0; j < n; ++j)
+        {
+            found += (NULL != HashFind(hash, &entries[order[j]].id));
+        }
+        hit_ns = (double)(NowNs() - start) / n;
+
+        start = NowNs();
+        for (j = 0; j < n; ++j)
+        {
+            missing = UIDCreate();
+            found += (NULL != HashFind(hash, &missing));
+        }
+        miss_ns = (double)(NowNs() - start) / n;
+
+        start = NowNs();
+        for (j = 0; j < n; ++j)
+        {
+            HashRemove(hash, &entries[order[j]].id);
+        }
+
+        printf("%lu,%.1f,%.1f,%.1f,%.1f\n", n, insert_ns, hit_ns, miss_ns, (double)(NowNs() - start) / n);
+
+        HashDestroy(hash);
+        free(entries);
+        free(order);
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+    Generic heap (pqueue) arity: binary vs. 4-ary vs. 8-ary.
+
+    For every queue size and arity the benchmark measures
+        push       - ns per push of a new timer
+        reschedule - ns per pop of the earliest timer + push at its next
+                     period, the pattern SchedulerRun drives
+        pop        - ns per pop while draining the queue
+
+    usage: ./bench_heap_arity.out [n1 n2 ...]   (default 1000 100000 1000000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <time.h>   /* clock_gettime */
+
+#include "pqueue.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define TICK_NS (1000000ULL)          /* 1ms */
+#define MAX_PERIOD_TICKS (1000)       /* periods up to 1s */
+#define RESCHEDULES_PER_TIMER (4)
+
+typedef struct bench_timer
+{
+    uint64_t deadline;
+    uint64_t period;
+    size_t heap_index;
+} bench_timer_t;
+
+typedef struct bench_result
+{
+    double push_ns;
+    double reschedule_ns;
+    double pop_ns;
+} bench_result_t;
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t NextRandom(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return seed;
+}
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static int CompareTimers(void* timer1, void* timer2)
+{
+    uint64_t deadline1 = ((bench_timer_t*)timer1)->deadline;
+    uint64_t deadline2 = ((bench_timer_t*)timer2)->deadline;
+
+    return (deadline1 > deadline2) - (deadline1 < deadline2);
+}
+
+/* the scheduler keeps positions up to date, so does the benchmark */
+static void SetHeapIndex(void* timer, size_t index)
+{
+    ((bench_timer_t*)timer)->heap_index = index;
+}
+
+static bench_result_t Bench(bench_timer_t* timers, size_t n, size_t arity)
+{
+    bench_result_t result = {0};
+    pqueue_t* queue = PQCreateWithArity(CompareTimers, SetHeapIndex, arity);
+    size_t reschedules = n * RESCHEDULES_PER_TIMER;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    seed = 88172645463325252ULL;
+    for (i = 0; i < n; ++i)
+    {
+        timers[i].period = (1 + NextRandom() % MAX_PERIOD_TICKS) * TICK_NS;
+        timers[i].deadline = NextRandom() % timers[i].period;
+    }
+
+    start = NowNs();
+    for (i = 0; i < n; ++i)
+    {
+        PQEnqueue(queue, &timers[i]);
+    }
+    result.push_ns = (double)(NowNs() - start) / n;
+
+    start = NowNs();
+    for (i = 0; i < reschedules; ++i)
+    {
+        bench_timer_t* timer = (bench_timer_t*)PQDequeue(queue);
+        timer->deadline += timer->period;
+        PQEnqueue(queue, timer);
+    }
+    result.reschedule_ns = (double)(NowNs() - start) / reschedules;
+
+    start = NowNs();
+    for (i = 0; i < n; ++i)
+    {
+        PQDequeue(queue);
+    }
+    result.pop_ns = (double)(NowNs() - start) / n;
+
+    PQDestroy(queue);
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {1000, 100000, 1000000};
+    size_t arities[] = {2, 4, 8};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t i = 0;
+    size_t j = 0;
+
+    printf("arity,tasks,push_ns,reschedule_ns,pop_ns\n");
+    for (i = 0; i < count; ++i)
+    {
+        size_t n = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i];
+        bench_timer_t* timers = (bench_timer_t*)malloc(n * sizeof(bench_timer_t));
+
+        if (NULL == timers)
+        {
+            return 1;
+        }
+
+        for (j = 0; j < sizeof(arities) / sizeof(arities[0]); ++j)
+        {
+            bench_result_t result = Bench(timers, n, arities[j]);
+            printf("%lu,%lu,%.1f,%.1f,%.1f\n", arities[j], n, result.push_ns, result.reschedule_ns, result.pop_ns);
+        }
+
+        free(timers);
+    }
+
+    return 0;
+}
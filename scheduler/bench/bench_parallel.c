@@ -0,0 +1,114 @@
+/*
+    Serial SchedulerRun vs. SchedulerRunParallel on CPU bound periodic tasks.
+
+    Every task spins for WORK_US and re-arms itself RUNS_PER_TASK times with
+    a zero interval, so the run is bound by task work and dispatch overhead.
+
+    usage: ./bench_parallel.out [tasks] [work_us]   (default 64 200)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <time.h>   /* clock_gettime */
+
+#include "scheduler.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define NSEC_PER_USEC (1000ULL)
+#define RUNS_PER_TASK (20)
+
+typedef struct bench_task
+{
+    size_t runs;
+    uint64_t work_ns;
+} bench_task_t;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static int SpinTask(void* args)
+{
+    bench_task_t* task = (bench_task_t*)args;
+    uint64_t end = NowNs() + task->work_ns;
+
+    while (NowNs() < end)
+    {
+    }
+
+    return ++task->runs < RUNS_PER_TASK;
+}
+
+/* n_workers 0 runs the serial executor */
+static double BenchRun(bench_task_t* tasks, size_t n, uint64_t work_ns, size_t n_workers)
+{
+    scheduler_t* scheduler = SchedulerCreate();
+    uint64_t start = 0;
+    size_t i = 0;
+
+    if (NULL == scheduler)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        tasks[i].runs = 0;
+        tasks[i].work_ns = work_ns;
+        SchedulerAddTaskUs(scheduler, SpinTask, &tasks[i], 0, NULL, NULL);
+    }
+
+    start = NowNs();
+    if (0 == n_workers)
+    {
+        SchedulerRun(scheduler);
+    }
+    else
+    {
+        SchedulerRunParallel(scheduler, n_workers);
+    }
+    start = NowNs() - start;
+
+    SchedulerDestroy(scheduler);
+
+    return (double)start / NSEC_PER_SEC * 1000;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : 64;
+    uint64_t work_ns = ((argc > 2) ? strtoul(argv[2], NULL, 10) : 200) * NSEC_PER_USEC;
+    size_t workers[] = {0, 1, 2, 4, 8};
+    bench_task_t* tasks = (bench_task_t*)malloc(n * sizeof(bench_task_t));
+    double serial_ms = 0;
+    size_t i = 0;
+
+    if (NULL == tasks)
+    {
+        return 1;
+    }
+
+    printf("executor,workers,tasks,runs,wall_ms,speedup\n");
+    for (i = 0; i < sizeof(workers) / sizeof(workers[0]); ++i)
+    {
+        double wall_ms = BenchRun(tasks, n, work_ns, workers[i]);
+
+        if (0 == workers[i])
+        {
+            serial_ms = wall_ms;
+        }
+
+        printf("%s,%lu,%lu,%lu,%.2f,%.2f\n", (0 == workers[i]) ? "serial" : "parallel",
+               workers[i], n, n * RUNS_PER_TASK, wall_ms, serial_ms / wall_ms);
+    }
+
+    free(tasks);
+
+    return 0;
+}
@@ -0,0 +1,345 @@
+/*
+    Scheduler benchmark suite, one run covers every queue backend.
+
+    For every backend and queue size:
+        add          - ns per SchedulerAddTaskUs into a queue of that size
+        remove       - ns per SchedulerRemove of a live task
+        cancel       - ns per SchedulerCancel of a live task by handle
+        clear        - ns per task of a SchedulerClear of the full queue
+        dispatch     - runner CPU ns per task run (dequeue + run + re-insert),
+                       every task is due again right after it runs, without
+                       and with a per-task stats record attached
+        memory       - heap bytes per queued task (task, queue slot, UID)
+    Per backend:
+        latency      - a 1ms fixed-rate task under a background load, actual
+                       start minus requested deadline, as percentiles and as
+                       the raw log-linear histogram (latency_hist rows,
+                       metric is the bucket's lower bound in ns)
+
+    Output is CSV on stdout, one value per row:
+        bench,backend,tasks,metric,value
+
+    usage: ./bench_scheduler.out [n1 n2 ...]   (default 1000 10000 100000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <string.h> /* memset */
+#include <malloc.h> /* mallinfo2 */
+#include <time.h>   /* clock_gettime */
+
+#include "scheduler.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define DISPATCH_RUNS (10)
+#define MAX_REMOVES (1000)
+#define LATENCY_INTERVAL_US (1000)
+#define LATENCY_SAMPLES (1000)
+#define LATENCY_LOAD (1000)
+#define SUB_BITS (5)
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define BUCKETS (64 * SUB_BUCKETS)
+
+typedef struct histogram
+{
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} histogram_t;
+
+typedef struct probe
+{
+    scheduler_t* scheduler;
+    histogram_t* histogram;
+    task_time_t first_deadline;
+    size_t runs;
+} probe_t;
+
+static const char* backend_names[] = {"heap", "wheel", "pqueue"};
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t NextRandom(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return seed;
+}
+
+static uint64_t ClockNs(clockid_t clock)
+{
+    struct timespec now = {0};
+
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+/* log-linear - SUB_BUCKETS linear buckets per power of two, ~3% precision */
+static size_t BucketOf(uint64_t value)
+{
+    int shift = 0;
+
+    if (value < 2 * SUB_BUCKETS)
+    {
+        return (size_t)value;
+    }
+
+    shift = 63 - __builtin_clzll(value) - SUB_BITS;
+
+    return (size_t)shift * SUB_BUCKETS + (size_t)(value >> shift);
+}
+
+static uint64_t BucketLowerBound(size_t bucket)
+{
+    int shift = 0;
+
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    shift = (int)(bucket / SUB_BUCKETS) - 1;
+
+    return (uint64_t)(bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+}
+
+static void HistogramRecord(histogram_t* histogram, uint64_t value)
+{
+    ++histogram->counts[BucketOf(value)];
+    ++histogram->total;
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+}
+
+static uint64_t HistogramPercentile(const histogram_t* histogram, double percentile)
+{
+    uint64_t rank = (uint64_t)(histogram->total * percentile / 100);
+    uint64_t seen = 0;
+    size_t i = 0;
+
+    for (i = 0; i < BUCKETS; ++i)
+    {
+        seen += histogram->counts[i];
+        if (seen > rank)
+        {
+            return BucketLowerBound(i);
+        }
+    }
+
+    return histogram->max;
+}
+
+static void Report(const char* bench, sched_backend_t backend, size_t tasks, const char* metric, double value)
+{
+    printf("%s,%s,%lu,%s,%.1f\n", bench, backend_names[backend], tasks, metric, value);
+}
+
+static scheduler_t* CreateScheduler(sched_backend_t backend)
+{
+    scheduler_config_t config = {0};
+
+    config.backend = backend;
+
+    return SchedulerCreateWithConfig(&config);
+}
+
+static int Idle(void* args)
+{
+    (void)args;
+
+    return 1;
+}
+
+static int CountRuns(void* args)
+{
+    return ++*(size_t*)args < DISPATCH_RUNS;
+}
+
+static int StopOp(void* args)
+{
+    SchedulerStop((scheduler_t*)args);
+
+    return 0;
+}
+
+static int ProbeRun(void* args)
+{
+    probe_t* probe = (probe_t*)args;
+    task_time_t now = TaskTimeNow();
+    task_time_t deadline = probe->first_deadline + (task_time_t)probe->runs * LATENCY_INTERVAL_US * 1000;
+
+    HistogramRecord(probe->histogram, (now > deadline) ? now - deadline : 0);
+
+    return ++probe->runs < LATENCY_SAMPLES;
+}
+
+static void BenchAddRemove(sched_backend_t backend, size_t n)
+{
+    scheduler_t* scheduler = CreateScheduler(backend);
+    UID_t* uids = (UID_t*)malloc(n * sizeof(UID_t));
+    size_t removes = (n < MAX_REMOVES) ? n : MAX_REMOVES;
+    size_t before = mallinfo2().uordblks;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    start = ClockNs(CLOCK_MONOTONIC);
+    for (i = 0; i < n; ++i)
+    {
+        /* far enough apart that nothing is due while measuring */
+        uids[i] = SchedulerAddTaskUs(scheduler, Idle, NULL, 1000000 + NextRandom() % 1000000, NULL, NULL);
+    }
+    Report("throughput", backend, n, "add_ns", (double)(ClockNs(CLOCK_MONOTONIC) - start) / n);
+    Report("memory", backend, n, "bytes_per_task", (double)(mallinfo2().uordblks - before) / n);
+
+    start = ClockNs(CLOCK_MONOTONIC);
+    for (i = 0; i < removes; ++i)
+    {
+        SchedulerRemove(scheduler, uids[(i * 7919) % n]);
+    }
+    Report("throughput", backend, n, "remove_ns", (double)(ClockNs(CLOCK_MONOTONIC) - start) / removes);
+
+    SchedulerDestroy(scheduler);
+    free(uids);
+}
+
+static void BenchCancelClear(sched_backend_t backend, size_t n)
+{
+    scheduler_t* scheduler = CreateScheduler(backend);
+    sched_handle_t* handles = (sched_handle_t*)malloc(n * sizeof(sched_handle_t));
+    scheduler_task_desc_t desc = {0};
+    size_t cancels = (n < MAX_REMOVES) ? n : MAX_REMOVES;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    desc.operation = Idle;
+    for (i = 0; i < n; ++i)
+    {
+        desc.interval_us = 1000000 + NextRandom() % 1000000;
+        handles[i] = SchedulerAddTaskHandle(scheduler, &desc, NULL);
+    }
+
+    /* below the purge threshold, every cancel only marks the task */
+    start = ClockNs(CLOCK_MONOTONIC);
+    for (i = 0; i < cancels; ++i)
+    {
+        SchedulerCancel(scheduler, handles[(i * 7919) % n]);
+    }
+    Report("throughput", backend, n, "cancel_ns", (double)(ClockNs(CLOCK_MONOTONIC) - start) / cancels);
+
+    start = ClockNs(CLOCK_MONOTONIC);
+    SchedulerClear(scheduler);
+    Report("throughput", backend, n, "clear_ns", (double)(ClockNs(CLOCK_MONOTONIC) - start) / n);
+
+    SchedulerDestroy(scheduler);
+    free(handles);
+}
+
+static void BenchDispatch(sched_backend_t backend, size_t n, int is_timed)
+{
+    scheduler_t* scheduler = CreateScheduler(backend);
+    scheduler_task_desc_t* descs = (scheduler_task_desc_t*)calloc(n, sizeof(scheduler_task_desc_t));
+    task_stats_record_t* records = is_timed ? (task_stats_record_t*)malloc(n * sizeof(task_stats_record_t)) : NULL;
+    size_t* runs = (size_t*)calloc(n, sizeof(size_t));
+    uint64_t cpu = 0;
+    size_t i = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        descs[i].operation = CountRuns;
+        descs[i].args = &runs[i];
+        if (is_timed)
+        {
+            TaskStatsInit(&records[i]);
+            descs[i].stats = &records[i];
+        }
+    }
+    SchedulerAddTasks(scheduler, descs, n, NULL);
+
+    cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+    SchedulerRun(scheduler);
+    Report("throughput", backend, n, is_timed ? "dispatch_stats_cpu_ns" : "dispatch_cpu_ns",
+           (double)(ClockNs(CLOCK_PROCESS_CPUTIME_ID) - cpu) / (n * DISPATCH_RUNS));
+
+    SchedulerDestroy(scheduler);
+    free(descs);
+    free(records);
+    free(runs);
+}
+
+static void BenchLatency(sched_backend_t backend)
+{
+    static histogram_t histogram;
+    scheduler_t* scheduler = CreateScheduler(backend);
+    scheduler_task_desc_t probe_desc = {0};
+    probe_t probe = {0};
+    size_t i = 0;
+
+    memset(&histogram, 0, sizeof(histogram));
+    probe.scheduler = scheduler;
+    probe.histogram = &histogram;
+
+    /* background periodic tasks between 1ms and 100ms */
+    for (i = 0; i < LATENCY_LOAD; ++i)
+    {
+        SchedulerAddTaskUs(scheduler, Idle, NULL, 1000 + NextRandom() % 99000, NULL, NULL);
+    }
+
+    probe_desc.operation = ProbeRun;
+    probe_desc.args = &probe;
+    probe_desc.interval_us = LATENCY_INTERVAL_US;
+    probe_desc.mode = TASK_FIXED_RATE;
+    probe_desc.overrun = TASK_OVERRUN_CATCH_UP;
+    SchedulerAddTasks(scheduler, &probe_desc, 1, NULL);
+    /* the task read its deadline right before the insert - off by the insert time only */
+    probe.first_deadline = TaskTimeNow() + LATENCY_INTERVAL_US * 1000;
+    SchedulerAddTaskUs(scheduler, StopOp, scheduler, (LATENCY_SAMPLES + 1) * LATENCY_INTERVAL_US, NULL, NULL);
+
+    SchedulerRun(scheduler);
+
+    Report("latency", backend, LATENCY_LOAD, "p50_ns", (double)HistogramPercentile(&histogram, 50));
+    Report("latency", backend, LATENCY_LOAD, "p90_ns", (double)HistogramPercentile(&histogram, 90));
+    Report("latency", backend, LATENCY_LOAD, "p99_ns", (double)HistogramPercentile(&histogram, 99));
+    Report("latency", backend, LATENCY_LOAD, "p999_ns", (double)HistogramPercentile(&histogram, 99.9));
+    Report("latency", backend, LATENCY_LOAD, "max_ns", (double)histogram.max);
+    for (i = 0; i < BUCKETS; ++i)
+    {
+        if (0 != histogram.counts[i])
+        {
+            printf("latency_hist,%s,%d,%lu,%lu\n", backend_names[backend], LATENCY_LOAD,
+                   BucketLowerBound(i), histogram.counts[i]);
+        }
+    }
+
+    SchedulerDestroy(scheduler);
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_sizes[] = {1000, 10000, 100000};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_sizes) / sizeof(default_sizes[0]);
+    int backend = 0;
+    size_t i = 0;
+
+    printf("bench,backend,tasks,metric,value\n");
+    for (backend = SCHED_BACKEND_HEAP; backend <= SCHED_BACKEND_PQUEUE; ++backend)
+    {
+        for (i = 0; i < count; ++i)
+        {
+            size_t n = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_sizes[i];
+
+            BenchAddRemove((sched_backend_t)backend, n);
+            BenchCancelClear((sched_backend_t)backend, n);
+            BenchDispatch((sched_backend_t)backend, n, 0);
+            BenchDispatch((sched_backend_t)backend, n, 1);
+        }
+
+        BenchLatency((sched_backend_t)backend);
+    }
+
+    return 0;
+}
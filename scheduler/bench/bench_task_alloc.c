@@ -0,0 +1,152 @@
+/*
+    task_t allocation under add/remove churn: malloc vs. the scheduler's slab.
+
+    A window of LIVE_TASKS tasks is kept alive, every step destroys the oldest
+    one and creates a new one. For every mode the benchmark reports
+        mallocs_per_op  - calls to malloc per create (task memory and UID)
+        mallocs_per_sec - malloc rate the churn drives
+        p50_ns, p99_ns  - create latency percentiles
+
+    malloc is counted by wrapping glibc's __libc_malloc.
+
+    usage: ./bench_task_alloc.out [steps]   (default 200000)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>  /* printf */
+#include <stdlib.h> /* malloc, qsort, strtoul */
+#include <stdint.h> /* uint64_t */
+#include <time.h>   /* clock_gettime */
+
+#include "task.h"
+#include "scheduler.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define LIVE_TASKS (1024)
+#define INTERVAL_NS (3600 * NSEC_PER_SEC) /* never due during the run */
+
+extern void* __libc_malloc(size_t size);
+
+static size_t malloc_calls = 0;
+
+void* malloc(size_t size)
+{
+    ++malloc_calls;
+
+    return __libc_malloc(size);
+}
+
+typedef enum
+{
+    MODE_MALLOC,
+    MODE_SLAB,
+    MODE_SCHEDULER
+} alloc_mode_t;
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static int Noop(void* args)
+{
+    (void)args;
+
+    return 0;
+}
+
+static int CompareU64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static void Bench(const char* name, alloc_mode_t mode, size_t steps, uint64_t* latencies)
+{
+    slab_t* slab = SlabCreate(sizeof(task_t), 256);
+    scheduler_t* scheduler = SchedulerCreate();
+    task_t* live[LIVE_TASKS] = {0};
+    UID_t live_ids[LIVE_TASKS];
+    size_t mallocs = 0;
+    uint64_t start = 0;
+    uint64_t total = 0;
+    size_t i = 0;
+
+    for (i = 0; i < steps + LIVE_TASKS; ++i)
+    {
+        size_t slot = i % LIVE_TASKS;
+        uint64_t before = 0;
+
+        if (i >= LIVE_TASKS)
+        {
+            if (MODE_SCHEDULER == mode)
+            {
+                SchedulerRemove(scheduler, live_ids[slot]);
+            }
+            else
+            {
+                TaskDestroy(live[slot]);
+            }
+        }
+
+        /* the first window warms up the slab and the queue */
+        if (LIVE_TASKS == i)
+        {
+            mallocs = malloc_calls;
+            start = NowNs();
+        }
+
+        before = NowNs();
+        if (MODE_SCHEDULER == mode)
+        {
+            live_ids[slot] = SchedulerAddTaskUs(scheduler, Noop, NULL, INTERVAL_NS / 1000, NULL, NULL);
+        }
+        else
+        {
+            live[slot] = TaskCreateFromSlab((MODE_SLAB == mode) ? slab : NULL, Noop, NULL, INTERVAL_NS, NULL, NULL);
+        }
+
+        if (i >= LIVE_TASKS)
+        {
+            latencies[i - LIVE_TASKS] = NowNs() - before;
+        }
+    }
+
+    total = NowNs() - start;
+    mallocs = malloc_calls - mallocs;
+    qsort(latencies, steps, sizeof(uint64_t), CompareU64);
+    printf("%s,%lu,%.2f,%.0f,%lu,%lu\n", name, steps, (double)mallocs / steps,
+           (double)mallocs / ((double)total / NSEC_PER_SEC), latencies[steps / 2], latencies[steps * 99 / 100]);
+
+    for (i = 0; MODE_SCHEDULER != mode && i < LIVE_TASKS; ++i)
+    {
+        TaskDestroy(live[i]);
+    }
+    SchedulerDestroy(scheduler);
+    SlabDestroy(slab);
+}
+
+int main(int argc, char** argv)
+{
+    size_t steps = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200000;
+    uint64_t* latencies = (uint64_t*)malloc(steps * sizeof(uint64_t));
+
+    if (NULL == latencies)
+    {
+        return 1;
+    }
+
+    printf("mode,ops,mallocs_per_op,mallocs_per_sec,p50_ns,p99_ns\n");
+    Bench("malloc", MODE_MALLOC, steps, latencies);
+    Bench("slab", MODE_SLAB, steps, latencies);
+    Bench("scheduler", MODE_SCHEDULER, steps, latencies);
+
+    free(latencies);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+    UIDCreate throughput across threads.
+
+    Every thread creates UIDS_PER_THREAD UIDs back to back, the wall time of
+    the slowest thread gives the total UIDs per second. UIDIsEqual is timed
+    on a single thread.
+
+    usage: ./bench_uid.out [threads1 threads2 ...]   (default 1 2 4 8)
+*/
+#define _GNU_SOURCE
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* strtoul */
+#include <stdint.h>  /* uint64_t */
+#include <time.h>    /* clock_gettime */
+#include <pthread.h> /* pthread_create */
+
+#include "uid.h"
+
+#define NSEC_PER_SEC (1000000000ULL)
+#define UIDS_PER_THREAD (1000000)
+#define MAX_THREADS (64)
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
+
+static void* CreateUIDs(void* args)
+{
+    volatile uint64_t* sink = (volatile uint64_t*)args;
+    size_t i = 0;
+
+    for (i = 0; i < UIDS_PER_THREAD; ++i)
+    {
+        *sink += UIDCreate().low;
+    }
+
+    return NULL;
+}
+
+static double BenchCreate(size_t n_threads)
+{
+    pthread_t threads[MAX_THREADS];
+    uint64_t sinks[MAX_THREADS] = {0};
+    uint64_t start = NowNs();
+    size_t i = 0;
+
+    for (i = 0; i < n_threads; ++i)
+    {
+        pthread_create(&threads[i], NULL, CreateUIDs, &sinks[i]);
+    }
+    for (i = 0; i < n_threads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    return (double)(n_threads * UIDS_PER_THREAD) * NSEC_PER_SEC / (NowNs() - start);
+}
+
+static double BenchIsEqual(void)
+{
+    UID_t uids[2];
+    volatile size_t matches = 0;
+    uint64_t start = 0;
+    size_t i = 0;
+
+    uids[0] = UIDCreate();
+    uids[1] = UIDCreate();
+
+    start = NowNs();
+    for (i = 0; i < UIDS_PER_THREAD; ++i)
+    {
+        matches += UIDIsEqual(uids[i & 1], uids[0]);
+    }
+
+    return (double)(NowNs() - start) / UIDS_PER_THREAD;
+}
+
+int main(int argc, char** argv)
+{
+    size_t default_threads[] = {1, 2, 4, 8};
+    size_t count = (argc > 1) ? (size_t)(argc - 1) : sizeof(default_threads) / sizeof(default_threads[0]);
+    size_t i = 0;
+
+    printf("bench,threads,value\n");
+    for (i = 0; i < count; ++i)
+    {
+        size_t n_threads = (argc > 1) ? strtoul(argv[i + 1], NULL, 10) : default_threads[i];
+        double per_sec = 0;
+
+        if (0 == n_threads || MAX_THREADS < n_threads)
+        {
+            return 1;
+        }
+
+        per_sec = BenchCreate(n_threads);
+        printf("create_per_sec,%lu,%.0f\n", n_threads, per_sec);
+        printf("create_ns,%lu,%.1f\n", n_threads, NSEC_PER_SEC * (double)n_threads / per_sec);
+    }
+    printf("is_equal_ns,1,%.2f\n", BenchIsEqual());
+
+    return 0;
+}
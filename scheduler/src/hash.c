@@ -0,0 +1,227 @@
+/*
+Author: Roi Sasson
+Date: 02-04-2025
+Reviewer:
+*/
+#include <stdlib.h> /* calloc, free */
+#include <stdint.h> /* uint64_t */
+#include <assert.h> /* assert */
+
+#include "hash.h" /* API */
+
+#define SUCCESS (0)
+#define FAIL (1)
+#define MIN_CAPACITY (16)
+#define GROWTH_FACTOR (2)
+/* at most 3/4 full - linear probes stay short */
+#define LOAD_NUMERATOR (3)
+#define LOAD_DENOMINATOR (4)
+#define GOLDEN_RATIO_64 (0x9E3779B97F4A7C15ULL)
+
+/* 16 bytes, 4 to a cache line - a probe compares hashes before touching the data */
+typedef struct hash_entry
+{
+    size_t hash;
+    void* data; /* NULL - empty */
+} hash_entry_t;
+
+struct hash
+{
+    hash_entry_t* entries;
+    size_t mask; /* capacity - 1, the capacity is a power of two */
+    size_t size;
+    hash_func_t hash_func;
+    hash_is_match_t is_match;
+};
+
+static size_t Mix(size_t hash);
+static int IsOverloaded(size_t count, size_t capacity);
+static int Rehash(hash_t* hash, size_t capacity);
+static size_t FindIndex(const hash_t* hash, const void* key, size_t hashed);
+
+hash_t* HashCreate(hash_func_t hash_func, hash_is_match_t is_match)
+{
+    hash_t* hash = NULL;
+
+    assert(NULL != hash_func);
+    assert(NULL != is_match);
+
+    hash = (hash_t*)malloc(sizeof(hash_t));
+    if (NULL == hash)
+    {
+        return NULL;
+    }
+
+    hash->entries = (hash_entry_t*)calloc(MIN_CAPACITY, sizeof(hash_entry_t));
+    if (NULL == hash->entries)
+    {
+        free(hash);
+        return NULL;
+    }
+
+    hash->mask = MIN_CAPACITY - 1;
+    hash->size = 0;
+    hash->hash_func = hash_func;
+    hash->is_match = is_match;
+
+    return hash;
+}
+
+void HashDestroy(hash_t* hash)
+{
+    assert(NULL != hash);
+
+    free(hash->entries);
+    free(hash);
+}
+
+int HashInsert(hash_t* hash, const void* key, void* data)
+{
+    size_t hashed = 0;
+    size_t i = 0;
+
+    assert(NULL != hash);
+    assert(NULL != data);
+
+    if (IsOverloaded(hash->size + 1, hash->mask + 1) &&
+        SUCCESS != Rehash(hash, (hash->mask + 1) * GROWTH_FACTOR))
+    {
+        return FAIL;
+    }
+
+    hashed = Mix(hash->hash_func(key));
+    for (i = hashed & hash->mask; NULL != hash->entries[i].data; i = (i + 1) & hash->mask)
+    {
+    }
+
+    hash->entries[i].hash = hashed;
+    hash->entries[i].data = data;
+    ++hash->size;
+
+    return SUCCESS;
+}
+
+void* HashRemove(hash_t* hash, const void* key)
+{
+    size_t i = 0;
+    size_t next = 0;
+    void* removed = NULL;
+
+    assert(NULL != hash);
+
+    i = FindIndex(hash, key, Mix(hash->hash_func(key)));
+    removed = hash->entries[i].data;
+    if (NULL == removed)
+    {
+        return NULL;
+    }
+
+    /* backward shift - every entry of the run after the hole that may move closer to its home does */
+    for (next = (i + 1) & hash->mask; NULL != hash->entries[next].data; next = (next + 1) & hash->mask)
+    {
+        size_t home = hash->entries[next].hash & hash->mask;
+
+        if (((next - home) & hash->mask) >= ((next - i) & hash->mask))
+        {
+            hash->entries[i] = hash->entries[next];
+            i = next;
+        }
+    }
+
+    hash->entries[i].data = NULL;
+    --hash->size;
+
+    return removed;
+}
+
+void* HashFind(const hash_t* hash, const void* key)
+{
+    assert(NULL != hash);
+
+    return hash->entries[FindIndex(hash, key, Mix(hash->hash_func(key)))].data;
+}
+
+int HashReserve(hash_t* hash, size_t count)
+{
+    size_t capacity = 0;
+
+    assert(NULL != hash);
+
+    capacity = hash->mask + 1;
+    if (!IsOverloaded(count, capacity))
+    {
+        return SUCCESS;
+    }
+
+    while (IsOverloaded(count, capacity))
+    {
+        capacity *= GROWTH_FACTOR;
+    }
+
+    return Rehash(hash, capacity);
+}
+
+size_t HashSize(const hash_t* hash)
+{
+    assert(NULL != hash);
+
+    return hash->size;
+}
+
+/* sequential keys end up far apart in the table */
+static size_t Mix(size_t hash)
+{
+    uint64_t mixed = (uint64_t)hash * GOLDEN_RATIO_64;
+
+    return (size_t)(mixed ^ (mixed >> 32));
+}
+
+static int IsOverloaded(size_t count, size_t capacity)
+{
+    return count * LOAD_DENOMINATOR > capacity * LOAD_NUMERATOR;
+}
+
+static int Rehash(hash_t* hash, size_t capacity)
+{
+    hash_entry_t* old_entries = hash->entries;
+    size_t old_capacity = hash->mask + 1;
+    size_t i = 0;
+    size_t j = 0;
+
+    hash->entries = (hash_entry_t*)calloc(capacity, sizeof(hash_entry_t));
+    if (NULL == hash->entries)
+    {
+        hash->entries = old_entries;
+        return FAIL;
+    }
+
+    hash->mask = capacity - 1;
+    for (i = 0; i < old_capacity; ++i)
+    {
+        if (NULL != old_entries[i].data)
+        {
+            for (j = old_entries[i].hash & hash->mask; NULL != hash->entries[j].data; j = (j + 1) & hash->mask)
+            {
+            }
+            hash->entries[j] = old_entries[i];
+        }
+    }
+
+    free(old_entries);
+
+    return SUCCESS;
+}
+
+/* the entry holding key, or the empty entry that ends its probe */
+static size_t FindIndex(const hash_t* hash, const void* key, size_t hashed)
+{
+    size_t i = hashed & hash->mask;
+
+    while (NULL != hash->entries[i].data &&
+           (hash->entries[i].hash != hashed || !hash->is_match(hash->entries[i].data, key)))
+    {
+        i = (i + 1) & hash->mask;
+    }
+
+    return i;
+}
@@ -9,26 +9,41 @@ Reviewer: Matan Tabachnik
 #include "heap.h" /* API */
 
 #define WORD_SIZE (sizeof(void*))
+#define DEFAULT_ARITY (2)
 
 struct heap
 {
     vector_t* vector;
     heap_compare_func_t compare_func;
+    heap_set_index_t set_index;
+    size_t arity;
 };
 
-static void HeapifyUp(heap_t* heap);
-static void HeapifyDown(heap_t* heap);
-static void* GetRightChild(heap_t* heap, size_t index);
-static size_t GetMinChildIndex(heap_t* heap, void* left_child, void* right_child, size_t i);
+static void HeapifyUp(heap_t* heap, size_t index);
+static void HeapifyDown(heap_t* heap, size_t index);
+static size_t GetMinChildIndex(heap_t* heap, size_t first_child);
 static void* FindMatch(heap_t* heap, heap_is_match_t is_match, void* params, size_t* match_index);
-static void SwapAndRemoveElement(heap_t* heap, size_t index);
-static void SwapElementData(void* a, void* b, size_t size);
+static void SwapElements(heap_t* heap, size_t index1, size_t index2);
+static void UpdateIndex(heap_t* heap, size_t index);
 
 heap_t* HeapCreate(heap_compare_func_t compare_func)
 {
-    heap_t* heap = (heap_t*)malloc(sizeof(heap_t));
+    return HeapCreateIndexed(compare_func, NULL);
+}
+
+heap_t* HeapCreateIndexed(heap_compare_func_t compare_func, heap_set_index_t set_index)
+{
+    return HeapCreateWithArity(compare_func, set_index, DEFAULT_ARITY);
+}
+
+heap_t* HeapCreateWithArity(heap_compare_func_t compare_func, heap_set_index_t set_index, size_t arity)
+{
+    heap_t* heap = NULL;
     vector_t* vector = NULL;
 
+    assert(2 <= arity);
+
+    heap = (heap_t*)malloc(sizeof(heap_t));
     if (NULL == heap)
     {
         return NULL;
@@ -43,6 +58,8 @@ heap_t* HeapCreate(heap_compare_func_t compare_func)
 
     heap->vector = vector;
     heap->compare_func = compare_func;
+    heap->set_index = set_index;
+    heap->arity = arity;
     return heap;
 }
 
@@ -63,7 +80,8 @@ int HeapPush(heap_t* heap, void* data)
     assert(NULL != data);
 
     result = VectorPushBack(heap->vector, &data);
-    HeapifyUp(heap);
+    UpdateIndex(heap, HeapSize(heap) - 1);
+    HeapifyUp(heap, HeapSize(heap) - 1);
 
     return result;
 }
@@ -78,9 +96,6 @@ void* HeapPeek(const heap_t* heap)
 
 void HeapPop(heap_t* heap)
 {
-    void* last_element = NULL;
-    void* first_element = NULL;
-
     assert(NULL != heap);
     assert(NULL != heap->vector);
 
@@ -89,33 +104,110 @@ void HeapPop(heap_t* heap)
         return;
     }
 
-    first_element = VectorGetAccess(heap->vector, 0);
-    last_element = VectorGetAccess(heap->vector, VectorGetSize(heap->vector) - 1);
-
-    SwapElementData(first_element, last_element, WORD_SIZE);
-    VectorPopBack(heap->vector);
-    HeapifyDown(heap);
+    HeapRemoveAt(heap, 0);
 }
 
 void* HeapRemove(heap_t* heap, heap_is_match_t is_match, void* params)
 {
-    void* removed_data = NULL;
     size_t match_index = 0;
 
     assert(NULL != heap);
     assert(NULL != heap->vector);
     assert(NULL != is_match);
 
-    removed_data = FindMatch(heap, is_match, params, &match_index);
-    if (removed_data != NULL)
+    if (NULL == FindMatch(heap, is_match, params, &match_index))
     {
-        removed_data = *(void**)removed_data;
-        SwapAndRemoveElement(heap, match_index);
+        return NULL;
+    }
+
+    return HeapRemoveAt(heap, match_index);
+}
+
+void* HeapFind(heap_t* heap, heap_is_match_t is_match, void* params)
+{
+    size_t match_index = 0;
+    void* match = NULL;
+
+    assert(NULL != heap);
+    assert(NULL != is_match);
+
+    match = FindMatch(heap, is_match, params, &match_index);
+
+    return (NULL != match) ? *(void**)match : NULL;
+}
+
+void* HeapRemoveAt(heap_t* heap, size_t index)
+{
+    void* removed_data = NULL;
+    size_t last_index = 0;
+
+    assert(NULL != heap);
+    assert(NULL != heap->vector);
+    assert(index < HeapSize(heap));
+
+    removed_data = *(void**)VectorGetAccess(heap->vector, index);
+    last_index = HeapSize(heap) - 1;
+
+    if (index < last_index)
+    {
+        SwapElements(heap, index, last_index);
+        VectorPopBack(heap->vector);
+
+        /* the moved element may belong below or above its new position */
+        HeapifyDown(heap, index);
+        HeapifyUp(heap, index);
+    }
+    else
+    {
+        VectorPopBack(heap->vector);
     }
 
     return removed_data;
 }
 
+size_t HeapRemoveIf(heap_t* heap, heap_is_match_t is_match, void* params)
+{
+    size_t size = 0;
+    size_t kept = 0;
+    size_t i = 0;
+
+    assert(NULL != heap);
+    assert(NULL != heap->vector);
+    assert(NULL != is_match);
+
+    size = HeapSize(heap);
+    for (i = 0; i < size; ++i)
+    {
+        void* current = *(void**)VectorGetAccess(heap->vector, i);
+        if (!is_match(current, params))
+        {
+            *(void**)VectorGetAccess(heap->vector, kept++) = current;
+        }
+    }
+
+    for (i = kept; i < size; ++i)
+    {
+        VectorPopBack(heap->vector);
+    }
+
+    if (kept == size)
+    {
+        return 0;
+    }
+
+    /* heapify bottom-up - indexes first, HeapifyDown only updates what it swaps */
+    for (i = 0; i < kept; ++i)
+    {
+        UpdateIndex(heap, i);
+    }
+    for (i = (0 == kept) ? 0 : (kept - 1) / heap->arity + 1; i > 0; --i)
+    {
+        HeapifyDown(heap, i - 1);
+    }
+
+    return size - kept;
+}
+
 int HeapIsEmpty(const heap_t* heap)
 {
     assert(NULL != heap);
@@ -132,11 +224,10 @@ size_t HeapSize(const heap_t* heap)
     return VectorGetSize(heap->vector);
 }
 
-static void HeapifyUp(heap_t* heap)
+static void HeapifyUp(heap_t* heap, size_t index)
 {
     void* current = NULL;
     void* parent = NULL;
-    size_t index = HeapSize(heap) - 1;
     size_t parent_index = 0;
 
     assert(NULL != heap);
@@ -144,7 +235,7 @@ static void HeapifyUp(heap_t* heap)
 
     while (index > 0)
     {
-        parent_index = (index - 1) / 2;
+        parent_index = (index - 1) / heap->arity;
         current = VectorGetAccess(heap->vector, index);
         parent = VectorGetAccess(heap->vector, parent_index);
 
@@ -154,56 +245,58 @@ static void HeapifyUp(heap_t* heap)
             break;
         }
 
-        SwapElementData(current, parent, WORD_SIZE);
+        SwapElements(heap, index, parent_index);
         index = parent_index;
     }
 }
 
-static void HeapifyDown(heap_t* heap)
+static void HeapifyDown(heap_t* heap, size_t i)
 {
     void* current = NULL;
-    void* left_child = NULL;
-    void* right_child = NULL;
     void* min_child = NULL;
     size_t min_child_index = 0;
-    size_t i = 0;
 
     assert(NULL != heap);
     assert(NULL != heap->vector);
 
-    while ((2 * i) + 1 < HeapSize(heap))
+    while ((heap->arity * i) + 1 < HeapSize(heap))
     {
         current = VectorGetAccess(heap->vector, i);
-        left_child = VectorGetAccess(heap->vector, (2 * i) + 1);
-        right_child = GetRightChild(heap, i);
-
-        min_child_index = GetMinChildIndex(heap, left_child, right_child, i);
+        min_child_index = GetMinChildIndex(heap, (heap->arity * i) + 1);
         min_child = VectorGetAccess(heap->vector, min_child_index);
 
-        /* stop if curr element <= MIN(left, right) */
+        /* stop if curr element <= MIN(children) */
         if (heap->compare_func(*(void**)current, *(void**)min_child) <= 0)
         {
             break;
         }
 
-        SwapElementData(current, min_child, WORD_SIZE);
+        SwapElements(heap, i, min_child_index);
         i = min_child_index;
     }
 }
 
-static void* GetRightChild(heap_t* heap, size_t index)
+/* siblings are adjacent in the vector - one pass over (at most) arity pointers */
+static size_t GetMinChildIndex(heap_t* heap, size_t first_child)
 {
-    assert(NULL != heap);
-    assert(NULL != heap->vector);
-    return ((2 * index) + 2 < HeapSize(heap))
-             ? VectorGetAccess(heap->vector, (2 * index) + 2) : NULL;
-}
+    void** children = NULL;
+    size_t count = HeapSize(heap) - first_child;
+    size_t min_child = 0;
+    size_t i = 0;
 
-static size_t GetMinChildIndex(heap_t* heap, void* left_child, void* right_child, size_t i)
-{
     assert(NULL != heap);
-    return (right_child && heap->compare_func(*(void**)left_child, *(void**)right_child) > 0)
-             ? (2 * i) + 2 : (2 * i) + 1;
+
+    children = (void**)VectorGetAccess(heap->vector, first_child);
+    count = (count < heap->arity) ? count : heap->arity;
+    for (i = 1; i < count; ++i)
+    {
+        if (heap->compare_func(children[min_child], children[i]) > 0)
+        {
+            min_child = i;
+        }
+    }
+
+    return first_child + min_child;
 }
 
 static void* FindMatch(heap_t* heap, heap_is_match_t is_match, void* params, size_t* match_index)
@@ -228,35 +321,30 @@ static void* FindMatch(heap_t* heap, heap_is_match_t is_match, void* params, siz
     return NULL;
 }
 
-static void SwapAndRemoveElement(heap_t* heap, size_t index)
+static void SwapElements(heap_t* heap, size_t index1, size_t index2)
 {
-    size_t size = HeapSize(heap);
-    void* last_element = VectorGetAccess(heap->vector, size - 1);
+    void** element1 = NULL;
+    void** element2 = NULL;
+    void* temp = NULL;
 
     assert(NULL != heap);
     assert(NULL != heap->vector);
 
-    if (index < size - 1)
-    {
-        void* current = VectorGetAccess(heap->vector, index);
-        SwapElementData(current, last_element, WORD_SIZE);
-        VectorPopBack(heap->vector);
-        HeapifyDown(heap);
-    }
-    else
-    {
-        VectorPopBack(heap->vector);
-    }
+    element1 = (void**)VectorGetAccess(heap->vector, index1);
+    element2 = (void**)VectorGetAccess(heap->vector, index2);
+    temp = *element1;
+    *element1 = *element2;
+    *element2 = temp;
+    UpdateIndex(heap, index1);
+    UpdateIndex(heap, index2);
 }
 
-static void SwapElementData(void* a, void* b, size_t size)
+static void UpdateIndex(heap_t* heap, size_t index)
 {
-    size_t i = 0;
-    
-    for (i = 0; i < size ;++i)
+    assert(NULL != heap);
+
+    if (NULL != heap->set_index)
     {
-        char temp = *((char*)a + i);
-        *((char*)a + i) = *((char*)b + i);
-        *((char*)b + i) = temp;
+        heap->set_index(*(void**)VectorGetAccess(heap->vector, index), index);
     }
-}
\ No newline at end of file
+}
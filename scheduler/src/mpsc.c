@@ -0,0 +1,99 @@
+/*
+Author: Roi Sasson
+Date: 12-03-2025
+Reviewer:
+*/
+#include <stdlib.h> /* malloc, free */
+#include <assert.h> /* assert */
+
+#include "mpsc.h" /* API */
+
+/* producers swap themselves into head, the consumer walks from tail */
+struct mpsc
+{
+    _Atomic(mpsc_node_t*) head;
+    mpsc_node_t* tail;
+    mpsc_node_t stub;
+};
+
+mpsc_t* MPSCCreate(void)
+{
+    mpsc_t* queue = (mpsc_t*)malloc(sizeof(mpsc_t));
+    if (NULL == queue)
+    {
+        return NULL;
+    }
+
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+
+    return queue;
+}
+
+void MPSCDestroy(mpsc_t* queue)
+{
+    assert(NULL != queue);
+
+    free(queue);
+}
+
+void MPSCPush(mpsc_t* queue, mpsc_node_t* node)
+{
+    mpsc_node_t* prev = NULL;
+
+    assert(NULL != queue);
+    assert(NULL != node);
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    /* between the exchange and this store the list is cut - MPSCPop sees it as empty */
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+mpsc_node_t* MPSCPop(mpsc_t* queue)
+{
+    mpsc_node_t* tail = NULL;
+    mpsc_node_t* next = NULL;
+
+    assert(NULL != queue);
+
+    tail = queue->tail;
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    /* skip the stub, it is only there to keep the list non-empty */
+    if (&queue->stub == tail)
+    {
+        if (NULL == next)
+        {
+            return NULL;
+        }
+
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    if (NULL != next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+
+    /* tail is not the last node - a push is half done */
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire))
+    {
+        return NULL;
+    }
+
+    /* tail is the last node - put the stub behind it so tail can be handed out */
+    MPSCPush(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (NULL != next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
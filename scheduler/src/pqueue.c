@@ -9,12 +9,24 @@ Reviewer: Yechiel Shirion
 
 #include "pqueue.h"
 
+#define DEFAULT_ARITY (2)
+
 struct pqueue
 {
     heap_t* list;
 };
 
 pqueue_t* PQCreate(pq_comperator_t comperator)
+{
+	return PQCreateIndexed(comperator, NULL);
+}
+
+pqueue_t* PQCreateIndexed(pq_comperator_t comperator, pq_set_index_t set_index)
+{
+	return PQCreateWithArity(comperator, set_index, DEFAULT_ARITY);
+}
+
+pqueue_t* PQCreateWithArity(pq_comperator_t comperator, pq_set_index_t set_index, size_t arity)
 {
 	pqueue_t* queue = (pqueue_t*)malloc(sizeof(pqueue_t));
 	
@@ -23,7 +35,7 @@ pqueue_t* PQCreate(pq_comperator_t comperator)
 		return NULL;
 	}
 	
-	queue->list = HeapCreate(comperator);
+	queue->list = HeapCreateWithArity(comperator, set_index, arity);
 	if (NULL == queue->list)
 	{
 		free(queue);
@@ -100,6 +112,32 @@ void* PQErase(pqueue_t* queue, void* data, int (*IsMatch)(void*, void*))
 	return HeapRemove(queue->list, IsMatch, data);
 }
 
+void* PQFind(pqueue_t* queue, void* data, int (*IsMatch)(void*, void*))
+{
+	assert(NULL != queue);
+	assert(NULL != queue->list);
+	assert(NULL != data);
+
+	return HeapFind(queue->list, IsMatch, data);
+}
+
+void* PQEraseAt(pqueue_t* queue, size_t index)
+{
+	assert(NULL != queue);
+	assert(NULL != queue->list);
+	assert(index < PQSize(queue));
+
+	return HeapRemoveAt(queue->list, index);
+}
+
+size_t PQEraseIf(pqueue_t* queue, int (*IsMatch)(void*, void*), void* data)
+{
+	assert(NULL != queue);
+	assert(NULL != queue->list);
+	
+	return HeapRemoveIf(queue->list, IsMatch, data);
+}
+
 void PQClear(pqueue_t* queue)
 {
 	assert(NULL != queue);
@@ -3,51 +3,303 @@ Author: Roi Sasson
 Date: 24-12-2024
 Reviewer: Or Eliyahu
 */
-#include <stdlib.h> /* malloc, free */
-#include <assert.h> /* assert */
-#include <unistd.h> /* sleep */
-#include <time.h>   /* time */
+#define _GNU_SOURCE
+#include <stdlib.h>    /* malloc, realloc, free */
+#include <stddef.h>    /* offsetof */
+#include <stdint.h>    /* uint32_t, UINT32_MAX */
+#include <assert.h>    /* assert */
+#include <unistd.h>    /* close */
+#include <poll.h>      /* ppoll */
+#include <time.h>      /* struct timespec */
+#include <pthread.h>   /* pthread_mutex_t */
+#include <stdatomic.h> /* atomic_int */
+#include <sys/eventfd.h> /* eventfd */
 
 #include "task.h" /* task API */
+#include "theap.h" /* timer heap backend */
+#include "twheel.h" /* timing wheel backend */
+#include "workpool.h" /* parallel executor */
+#include "mpsc.h" /* commands from other threads */
+#include "slab.h" /* task memory */
+#include "hash.h" /* UID index */
 #include "scheduler.h" /* API */
 
 #define FAIL (-1)
 #define SUCCESS (0)
 #define TRUE (1)
 #define FALSE (0)
+#define NSEC_PER_SEC (1000000000ULL)
+#define NSEC_PER_USEC (1000ULL)
+#define DEFAULT_WHEEL_TICK_US (1000)
+#define TASKS_PER_CHUNK (256)
+#define DEFAULT_HEAP_ARITY (4)
+#define MIN_SLOTS (64)
+#define PURGE_MIN_CANCELLED (64)
+
+/* a task queue backend, the runner only talks to the queue through these */
+typedef struct sched_queue_ops
+{
+    void* (*create)(const scheduler_config_t* config);
+    void (*destroy)(void* queue);
+    int (*enqueue)(void* queue, task_t* task);
+    size_t (*enqueue_bulk)(void* queue, task_t** tasks, size_t count); /* returns how many went in */
+    task_t* (*dequeue_due)(void* queue, task_time_t now);
+    task_t* (*pop)(void* queue);
+    task_time_t (*next_deadline)(void* queue);
+    void (*remove)(void* queue, task_t* task);
+    size_t (*remove_if)(void* queue, int (*is_match)(void* task, void* params), void* params); /* is_match may destroy the task */
+    size_t (*size)(const void* queue);
+} sched_queue_ops_t;
+
+/* where a tracked task is between runs */
+typedef enum
+{
+    PLACE_QUEUE,
+    PLACE_RUNNING, /* dequeued - running, or handed to a worker */
+    PLACE_REARMED
+} task_place_t;
+
+/* a task's entry in the handle table, free entries are chained through next_free */
+typedef struct task_slot
+{
+    task_t* task;
+    uint32_t generation;
+    uint32_t next_free;
+    int is_cancelled;
+    task_place_t place;
+} task_slot_t;
 
 struct scheduler
 {
-    pqueue_t* pqueue;
-    int is_scheduler_running;
-    int is_task_running;
-    int is_cleared;
+    void* queue;
+    const sched_queue_ops_t* ops;
+    mpsc_t* commands;
+    slab_t* tasks; /* memory of tasks added on the runner's side */
+    int wakeup_fd; /* eventfd - posted commands, SchedulerStop, finished parallel tasks */
+    atomic_int is_scheduler_running;
+    size_t running_tasks;
+    task_t** rearmed; /* ran in the current batch, waiting to go back in bulk */
+    size_t rearmed_count;
+    size_t rearmed_capacity;
+    task_t* running_task; /* the task SchedulerRun is running right now */
+    task_slot_t* slots;   /* every task the runner owns, by handle */
+    hash_t* index;        /* the same tasks by UID */
+    uint32_t slots_capacity;
+    uint32_t free_slots;
+    uint32_t free_slot;   /* head of the free list */
+    size_t cancelled;     /* tombstones still in the queue, re-armed or running */
+    int wait_when_empty;
 };
 
-static void SchedulerSleepUntilNextTask(scheduler_t* scheduler);
-static run_status_t SchedulerHandleTaskExecution(scheduler_t* scheduler);
+typedef enum
+{
+    COMMAND_ADD,
+    COMMAND_REMOVE
+} command_type_t;
+
+/* posted by SchedulerPostTask/SchedulerPostRemove, applied by the runner */
+typedef struct sched_command
+{
+    mpsc_node_t node;
+    command_type_t type;
+    task_t* task;
+    UID_t task_id;
+} sched_command_t;
+
+typedef struct completion
+{
+    task_t* task;
+    int run_result;
+} completion_t;
+
+/* state shared between the timer thread and the workers of SchedulerRunParallel */
+typedef struct parallel_run
+{
+    scheduler_t* scheduler;
+    pthread_mutex_t lock;
+    completion_t* completed;  /* filled by workers */
+    completion_t* reaping;    /* drained by the timer thread */
+    size_t completed_count;
+    size_t capacity;
+} parallel_run_t;
+
+static UID_t SchedulerAddTaskNs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                                task_time_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args);
+static UID_t SchedulerPostTaskNs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                                 task_time_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args);
+static int SchedulerPostCommand(scheduler_t* scheduler, command_type_t type, task_t* task, UID_t task_id);
+static run_status_t SchedulerDrainCommands(scheduler_t* scheduler);
+static void SchedulerWakeUp(scheduler_t* scheduler);
+static int SchedulerWaitForNextTask(scheduler_t* scheduler);
+static run_status_t SchedulerRunDueTasks(scheduler_t* scheduler);
+static run_status_t SchedulerRearmTask(scheduler_t* scheduler, task_t* task, int run_result);
+static run_status_t SchedulerFlushRearmed(scheduler_t* scheduler);
+static size_t SchedulerFindRearmed(scheduler_t* scheduler, task_t* task);
+static int SchedulerAddDescs(scheduler_t* scheduler, const scheduler_task_desc_t* tasks, size_t count,
+                             UID_t* task_ids, sched_handle_t* handles);
+static int SchedulerReserveSlots(scheduler_t* scheduler, size_t count);
+static void SchedulerTrack(scheduler_t* scheduler, task_t* task);
+static void SchedulerDestroyTask(scheduler_t* scheduler, task_t* task);
+static int SchedulerIsCancelled(const scheduler_t* scheduler, const task_t* task);
+static void SchedulerMarkCancelled(scheduler_t* scheduler, task_t* task);
+static void SchedulerSetPlace(scheduler_t* scheduler, task_t* task, task_place_t place);
+static size_t HashUID(const void* task_id);
+static int IsTaskOfUID(const void* task, const void* task_id);
+static int DestroyIfCancelled(void* task, void* scheduler);
+static int DestroyTaskWrapper(void* task, void* scheduler);
+static int ParallelInit(parallel_run_t* run, scheduler_t* scheduler);
+static void ParallelDestroy(parallel_run_t* run);
+static void ParallelRunTask(void* task, void* context);
+static run_status_t ParallelDispatch(scheduler_t* scheduler, parallel_run_t* run, workpool_t* pool);
+static run_status_t ParallelReap(scheduler_t* scheduler, parallel_run_t* run);
+static struct timespec ToTimespec(task_time_t time);
 static int SchedulerComperator(void* task1, void* task2);
-static int IsTaskMatchWrapper(void* id, void* task);
+static void SetTaskQueueIndex(void* task, size_t index);
+
+static void* THeapQueueCreate(const scheduler_config_t* config);
+static void THeapQueueDestroy(void* queue);
+static int THeapQueueEnqueue(void* queue, task_t* task);
+static size_t THeapQueueEnqueueBulk(void* queue, task_t** tasks, size_t count);
+static task_t* THeapQueueDequeueDue(void* queue, task_time_t now);
+static task_t* THeapQueuePop(void* queue);
+static task_time_t THeapQueueNextDeadline(void* queue);
+static void THeapQueueRemove(void* queue, task_t* task);
+static size_t THeapQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params);
+static size_t THeapQueueSize(const void* queue);
+
+static void* PQQueueCreate(const scheduler_config_t* config);
+static void PQQueueDestroy(void* queue);
+static int PQQueueEnqueue(void* queue, task_t* task);
+static size_t PQQueueEnqueueBulk(void* queue, task_t** tasks, size_t count);
+static task_t* PQQueueDequeueDue(void* queue, task_time_t now);
+static task_t* PQQueuePop(void* queue);
+static task_time_t PQQueueNextDeadline(void* queue);
+static void PQQueueRemove(void* queue, task_t* task);
+static size_t PQQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params);
+static size_t PQQueueSize(const void* queue);
+
+static void* WheelQueueCreate(const scheduler_config_t* config);
+static void WheelQueueDestroy(void* queue);
+static int WheelQueueEnqueue(void* queue, task_t* task);
+static size_t WheelQueueEnqueueBulk(void* queue, task_t** tasks, size_t count);
+static task_t* WheelQueueDequeueDue(void* queue, task_time_t now);
+static task_t* WheelQueuePop(void* queue);
+static task_time_t WheelQueueNextDeadline(void* queue);
+static void WheelQueueRemove(void* queue, task_t* task);
+static size_t WheelQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params);
+static size_t WheelQueueSize(const void* queue);
+
+const sched_handle_t BadHandle = {TASK_NO_SLOT, 0};
+
+static const sched_queue_ops_t theap_queue_ops = 
+{
+    THeapQueueCreate, THeapQueueDestroy, THeapQueueEnqueue, THeapQueueEnqueueBulk, THeapQueueDequeueDue,
+    THeapQueuePop, THeapQueueNextDeadline, THeapQueueRemove, THeapQueueRemoveIf, THeapQueueSize
+};
+
+static const sched_queue_ops_t pq_queue_ops = 
+{
+    PQQueueCreate, PQQueueDestroy, PQQueueEnqueue, PQQueueEnqueueBulk, PQQueueDequeueDue,
+    PQQueuePop, PQQueueNextDeadline, PQQueueRemove, PQQueueRemoveIf, PQQueueSize
+};
+
+static const sched_queue_ops_t wheel_queue_ops = 
+{
+    WheelQueueCreate, WheelQueueDestroy, WheelQueueEnqueue, WheelQueueEnqueueBulk, WheelQueueDequeueDue,
+    WheelQueuePop, WheelQueueNextDeadline, WheelQueueRemove, WheelQueueRemoveIf, WheelQueueSize
+};
 
 scheduler_t* SchedulerCreate(void)
 {
-    scheduler_t* scheduler = (scheduler_t*)malloc(sizeof(scheduler_t));
+    scheduler_config_t config = {0};
+
+    config.backend = SCHED_BACKEND_HEAP;
+
+    return SchedulerCreateWithConfig(&config);
+}
+
+scheduler_t* SchedulerCreateWithConfig(const scheduler_config_t* config)
+{
+    scheduler_t* scheduler = NULL;
 
+    assert(NULL != config);
+
+    scheduler = (scheduler_t*)malloc(sizeof(scheduler_t));
     if (NULL == scheduler)
     {
         return NULL;
     }
 
-    scheduler->pqueue = PQCreate(SchedulerComperator);
-    if (NULL == scheduler->pqueue)
+    switch (config->backend)
+    {
+        case SCHED_BACKEND_WHEEL:
+            scheduler->ops = &wheel_queue_ops;
+            break;
+        case SCHED_BACKEND_PQUEUE:
+            scheduler->ops = &pq_queue_ops;
+            break;
+        default:
+            scheduler->ops = &theap_queue_ops;
+            break;
+    }
+
+    scheduler->queue = scheduler->ops->create(config);
+    if (NULL == scheduler->queue)
     {
         free(scheduler);
         return NULL;
     }
 
-    scheduler->is_scheduler_running = TRUE;
-    scheduler->is_task_running = FALSE;
-    scheduler->is_cleared = FALSE;
+    scheduler->commands = MPSCCreate();
+    if (NULL == scheduler->commands)
+    {
+        scheduler->ops->destroy(scheduler->queue);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->tasks = SlabCreate(sizeof(task_t), TASKS_PER_CHUNK);
+    if (NULL == scheduler->tasks)
+    {
+        MPSCDestroy(scheduler->commands);
+        scheduler->ops->destroy(scheduler->queue);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->index = HashCreate(HashUID, IsTaskOfUID);
+    if (NULL == scheduler->index)
+    {
+        SlabDestroy(scheduler->tasks);
+        MPSCDestroy(scheduler->commands);
+        scheduler->ops->destroy(scheduler->queue);
+        free(scheduler);
+        return NULL;
+    }
+
+    scheduler->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (-1 == scheduler->wakeup_fd)
+    {
+        HashDestroy(scheduler->index);
+        SlabDestroy(scheduler->tasks);
+        MPSCDestroy(scheduler->commands);
+        scheduler->ops->destroy(scheduler->queue);
+        free(scheduler);
+        return NULL;
+    }
+
+    atomic_init(&scheduler->is_scheduler_running, TRUE);
+    scheduler->running_tasks = 0;
+    scheduler->rearmed = NULL;
+    scheduler->rearmed_count = 0;
+    scheduler->rearmed_capacity = 0;
+    scheduler->running_task = NULL;
+    scheduler->slots = NULL;
+    scheduler->slots_capacity = 0;
+    scheduler->free_slots = 0;
+    scheduler->free_slot = TASK_NO_SLOT;
+    scheduler->cancelled = 0;
+    scheduler->wait_when_empty = config->wait_when_empty;
 
     return scheduler;
 }
@@ -56,46 +308,214 @@ void SchedulerDestroy(scheduler_t* scheduler)
 {
     assert(NULL != scheduler);
 
+    /* posted tasks are owned by the scheduler as well */
+    SchedulerDrainCommands(scheduler);
     SchedulerClear(scheduler);
-    PQDestroy(scheduler->pqueue);
+    scheduler->ops->destroy(scheduler->queue);
+    MPSCDestroy(scheduler->commands);
+    SlabDestroy(scheduler->tasks);
+    close(scheduler->wakeup_fd);
+    free(scheduler->rearmed);
+    free(scheduler->slots);
+    HashDestroy(scheduler->index);
     free(scheduler);
 }
 
 UID_t SchedulerAddTask(scheduler_t* scheduler, s_operation_t operation, void* args,
                        size_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args)
+{
+    return SchedulerAddTaskNs(scheduler, operation, args, (task_time_t)interval * NSEC_PER_SEC,
+                              cleanup_op, cleanup_args);
+}
+
+UID_t SchedulerAddTaskUs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                         size_t interval_us, s_cleanup_op_t cleanup_op, void* cleanup_args)
+{
+    return SchedulerAddTaskNs(scheduler, operation, args, (task_time_t)interval_us * NSEC_PER_USEC,
+                              cleanup_op, cleanup_args);
+}
+
+static UID_t SchedulerAddTaskNs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                                task_time_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args)
+{
+    task_t* task = NULL;
+
+    assert(NULL != scheduler);
+
+    if (SUCCESS != SchedulerReserveSlots(scheduler, 1))
+    {
+        return BadUID;
+    }
+
+    task = TaskCreateFromSlab(scheduler->tasks, operation, args, interval, cleanup_op, cleanup_args);
+    if (NULL == task)
+    {
+        return BadUID;
+    }
+
+    SchedulerTrack(scheduler, task);
+    if (FAIL == scheduler->ops->enqueue(scheduler->queue, task))
+    {
+        SchedulerDestroyTask(scheduler, task);
+        return BadUID;
+    }
+
+    return TaskGetUID(task);
+}
+
+int SchedulerAddTasks(scheduler_t* scheduler, const scheduler_task_desc_t* tasks, size_t count, UID_t* task_ids)
+{
+    assert(NULL != scheduler);
+    assert(NULL != tasks || 0 == count);
+
+    return SchedulerAddDescs(scheduler, tasks, count, task_ids, NULL);
+}
+
+sched_handle_t SchedulerAddTaskHandle(scheduler_t* scheduler, const scheduler_task_desc_t* task, UID_t* task_id)
+{
+    sched_handle_t handle = BadHandle;
+
+    assert(NULL != scheduler);
+    assert(NULL != task);
+
+    SchedulerAddDescs(scheduler, task, 1, task_id, &handle);
+
+    return handle;
+}
+
+int SchedulerCancel(scheduler_t* scheduler, sched_handle_t handle)
+{
+    task_slot_t* slot = NULL;
+
+    assert(NULL != scheduler);
+
+    if (handle.slot >= scheduler->slots_capacity)
+    {
+        return FAIL;
+    }
+
+    slot = &scheduler->slots[handle.slot];
+    if (NULL == slot->task || slot->generation != handle.generation || slot->is_cancelled)
+    {
+        return FAIL;
+    }
+
+    /* the running task may still use what its cleanup frees - that waits for the end of the run */
+    if (slot->task != scheduler->running_task)
+    {
+        TaskCleanup(slot->task);
+    }
+    SchedulerMarkCancelled(scheduler, slot->task);
+
+    /* the runner drops a tombstone once it is due, a queue of mostly tombstones is purged at once */
+    if (PURGE_MIN_CANCELLED <= scheduler->cancelled &&
+        scheduler->cancelled * 2 > scheduler->ops->size(scheduler->queue))
+    {
+        scheduler->ops->remove_if(scheduler->queue, DestroyIfCancelled, scheduler);
+    }
+
+    return SUCCESS;
+}
+
+UID_t SchedulerPostTask(scheduler_t* scheduler, s_operation_t operation, void* args,
+                        size_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args)
+{
+    return SchedulerPostTaskNs(scheduler, operation, args, (task_time_t)interval * NSEC_PER_SEC,
+                               cleanup_op, cleanup_args);
+}
+
+UID_t SchedulerPostTaskUs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                          size_t interval_us, s_cleanup_op_t cleanup_op, void* cleanup_args)
+{
+    return SchedulerPostTaskNs(scheduler, operation, args, (task_time_t)interval_us * NSEC_PER_USEC,
+                               cleanup_op, cleanup_args);
+}
+
+static UID_t SchedulerPostTaskNs(scheduler_t* scheduler, s_operation_t operation, void* args,
+                                 task_time_t interval, s_cleanup_op_t cleanup_op, void* cleanup_args)
 {
     task_t* task = NULL;
+    UID_t task_id = BadUID;
 
     assert(NULL != scheduler);
 
-    task = TaskCreate(operation, args, interval, cleanup_op, cleanup_args);
+    /* created on the posting thread - the UID is known before the runner sees the task,
+       the slab belongs to the runner so the memory comes from malloc */
+    task = TaskCreateNs(operation, args, interval, cleanup_op, cleanup_args);
     if (NULL == task)
     {
         return BadUID;
     }
 
-    if (FAIL == PQEnqueue(scheduler->pqueue, task))
+    task_id = TaskGetUID(task);
+    if (SUCCESS != SchedulerPostCommand(scheduler, COMMAND_ADD, task, task_id))
     {
         TaskDestroy(task);
         return BadUID;
     }
 
-    scheduler->is_cleared = FALSE;
+    return task_id;
+}
 
-    return TaskGetUID(task);
+int SchedulerPostRemove(scheduler_t* scheduler, UID_t task_id)
+{
+    assert(NULL != scheduler);
+
+    return SchedulerPostCommand(scheduler, COMMAND_REMOVE, NULL, task_id);
 }
 
 void SchedulerRemove(scheduler_t* scheduler, UID_t task_id)
 {
     task_t* task = NULL;
+    size_t index = 0;
 
     assert(NULL != scheduler);
 
-    task = (task_t*)PQErase(scheduler->pqueue, &task_id, IsTaskMatchWrapper);
-    if (NULL != task)
+    task = (task_t*)HashFind(scheduler->index, &task_id);
+    if (NULL == task)
     {
-        TaskDestroy(task);
+        return;
+    }
+
+    /* no default - a new place is a -Wswitch warning here, not a remove that does nothing */
+    switch (scheduler->slots[task->slot].place)
+    {
+        case PLACE_QUEUE:
+            scheduler->ops->remove(scheduler->queue, task);
+            SchedulerDestroyTask(scheduler, task);
+            break;
+        case PLACE_REARMED:
+            index = SchedulerFindRearmed(scheduler, task);
+            scheduler->rearmed[index] = scheduler->rearmed[--scheduler->rearmed_count];
+            SchedulerDestroyTask(scheduler, task);
+            break;
+        case PLACE_RUNNING:
+            /* running inline or on a worker - dropped instead of re-armed once the run ends */
+            if (!SchedulerIsCancelled(scheduler, task))
+            {
+                SchedulerMarkCancelled(scheduler, task);
+            }
+            break;
+    }
+}
+
+int SchedulerGetLateness(scheduler_t* scheduler, UID_t task_id, task_lateness_t* lateness)
+{
+    task_t* task = NULL;
+
+    assert(NULL != scheduler);
+    assert(NULL != lateness);
+
+    task = (task_t*)HashFind(scheduler->index, &task_id);
+    if (NULL == task || PLACE_RUNNING == scheduler->slots[task->slot].place ||
+        SchedulerIsCancelled(scheduler, task))
+    {
+        return FAIL;
     }
+
+    *lateness = TaskGetLateness(task);
+
+    return SUCCESS;
 }
 
 run_status_t SchedulerRun(scheduler_t* scheduler)
@@ -104,17 +524,93 @@ run_status_t SchedulerRun(scheduler_t* scheduler)
     assert(NULL != scheduler);
 
     scheduler->is_scheduler_running = TRUE;
-    while (!SchedulerIsEmpty(scheduler) && TRUE == scheduler->is_scheduler_running)
+    while (TRUE == scheduler->is_scheduler_running)
     {
-        SchedulerSleepUntilNextTask(scheduler);
-        status = SchedulerHandleTaskExecution(scheduler);
+        status = SchedulerDrainCommands(scheduler);
         if (status != SUCCESSFULL_RUN)
         {
             return status;
         }
+
+        if (SchedulerIsEmpty(scheduler) && !scheduler->wait_when_empty)
+        {
+            break;
+        }
+
+        if (TRUE == SchedulerWaitForNextTask(scheduler))
+        {
+            status = SchedulerRunDueTasks(scheduler);
+            if (status != SUCCESSFULL_RUN)
+            {
+                return status;
+            }
+        }
     }
 
-    return status;
+    return (TRUE == scheduler->is_scheduler_running) ? status : STOP;
+}
+
+run_status_t SchedulerRunParallel(scheduler_t* scheduler, size_t n_workers)
+{
+    parallel_run_t run;
+    workpool_t* pool = NULL;
+    run_status_t status = SUCCESSFULL_RUN;
+
+    assert(NULL != scheduler);
+    assert(0 < n_workers);
+
+    if (SUCCESS != ParallelInit(&run, scheduler))
+    {
+        return WORKERS_FAIL;
+    }
+
+    pool = WorkPoolCreate(n_workers, ParallelRunTask, &run);
+    if (NULL == pool)
+    {
+        ParallelDestroy(&run);
+        return WORKERS_FAIL;
+    }
+
+    scheduler->is_scheduler_running = TRUE;
+    while (SUCCESSFULL_RUN == status && TRUE == scheduler->is_scheduler_running)
+    {
+        status = SchedulerDrainCommands(scheduler);
+        if (SUCCESSFULL_RUN == status)
+        {
+            status = ParallelReap(scheduler, &run);
+        }
+
+        if (SUCCESSFULL_RUN != status || (SchedulerIsEmpty(scheduler) && !scheduler->wait_when_empty))
+        {
+            break;
+        }
+
+        status = ParallelDispatch(scheduler, &run, pool);
+        if (SUCCESSFULL_RUN == status)
+        {
+            /* workers post to the wakeup fd as well - a finished task ends the wait */
+            SchedulerWaitForNextTask(scheduler);
+        }
+    }
+
+    /* let the tasks in flight finish - they are re-armed like in SchedulerRun */
+    WorkPoolDestroy(pool);
+    if (SUCCESSFULL_RUN == status)
+    {
+        status = ParallelReap(scheduler, &run);
+    }
+    else
+    {
+        ParallelReap(scheduler, &run);
+    }
+    ParallelDestroy(&run);
+
+    if (SUCCESSFULL_RUN != status)
+    {
+        return status;
+    }
+
+    return (TRUE == scheduler->is_scheduler_running) ? status : STOP;
 }
 
 void SchedulerStop(scheduler_t* scheduler)
@@ -122,96 +618,818 @@ void SchedulerStop(scheduler_t* scheduler)
     assert(NULL != scheduler);
 
     scheduler->is_scheduler_running = FALSE;
+    SchedulerWakeUp(scheduler);
 }
 
 void SchedulerClear(scheduler_t* scheduler)
 {
     assert(NULL != scheduler);
 
-    while (!PQIsEmpty(scheduler->pqueue))
+    /* one pass over the queue, nothing is sifted per task */
+    scheduler->ops->remove_if(scheduler->queue, DestroyTaskWrapper, scheduler);
+
+    while (0 != scheduler->rearmed_count)
     {
-        task_t* task = PQDequeue(scheduler->pqueue);
-        if (NULL != task)
-        {
-            TaskDestroy(task);
-        }
+        SchedulerDestroyTask(scheduler, scheduler->rearmed[--scheduler->rearmed_count]);
     }
 
-    scheduler->is_cleared = TRUE;
+    /* cleared from within a task - it is dropped after its run */
+    if (NULL != scheduler->running_task && !SchedulerIsCancelled(scheduler, scheduler->running_task))
+    {
+        SchedulerMarkCancelled(scheduler, scheduler->running_task);
+    }
 }
 
 int SchedulerIsEmpty(scheduler_t* scheduler)
 {
     assert(NULL != scheduler);
 
-    return !scheduler->is_task_running && PQIsEmpty(scheduler->pqueue);
+    return 0 == SchedulerSize(scheduler);
 }
 
 size_t SchedulerSize(scheduler_t* scheduler)
 {
     assert(NULL != scheduler);
 
-    return (size_t)scheduler->is_task_running + PQSize(scheduler->pqueue);
+    return scheduler->running_tasks + scheduler->rearmed_count + scheduler->ops->size(scheduler->queue) -
+           scheduler->cancelled;
 }
 
-static void SchedulerSleepUntilNextTask(scheduler_t* scheduler)
+static int SchedulerPostCommand(scheduler_t* scheduler, command_type_t type, task_t* task, UID_t task_id)
 {
-    task_t* task_to_run = (task_t*)PQPeek(scheduler->pqueue);
-    time_t time_to_run = TaskGetTimeToRun(task_to_run);
-    time_t current_time = time(NULL);
-    time_t sleep_time = time_to_run - current_time;
+    sched_command_t* command = (sched_command_t*)malloc(sizeof(sched_command_t));
+    if (NULL == command)
+    {
+        return FAIL;
+    }
 
-    assert(NULL != scheduler);
+    command->type = type;
+    command->task = task;
+    command->task_id = task_id;
+    MPSCPush(scheduler->commands, &command->node);
+    SchedulerWakeUp(scheduler);
+
+    return SUCCESS;
+}
+
+/* runner side - applies everything posted since the last drain, in order */
+static run_status_t SchedulerDrainCommands(scheduler_t* scheduler)
+{
+    run_status_t status = SUCCESSFULL_RUN;
+    mpsc_node_t* node = NULL;
 
-    if (sleep_time > 0)
+    while (NULL != (node = MPSCPop(scheduler->commands)))
     {
-        sleep(sleep_time);
+        sched_command_t* command = (sched_command_t*)node;
+
+        if (COMMAND_REMOVE == command->type)
+        {
+            SchedulerRemove(scheduler, command->task_id);
+        }
+        else if (SUCCESS != SchedulerReserveSlots(scheduler, 1))
+        {
+            TaskDestroy(command->task);
+            status = ENQUEUE_FAIL;
+        }
+        else
+        {
+            SchedulerTrack(scheduler, command->task);
+            if (FAIL == scheduler->ops->enqueue(scheduler->queue, command->task))
+            {
+                SchedulerDestroyTask(scheduler, command->task);
+                status = ENQUEUE_FAIL;
+            }
+        }
+
+        free(command);
     }
+
+    return status;
+}
+
+static void SchedulerWakeUp(scheduler_t* scheduler)
+{
+    eventfd_write(scheduler->wakeup_fd, 1);
 }
 
-static run_status_t SchedulerHandleTaskExecution(scheduler_t* scheduler)
+/* sleeps until the next deadline - TRUE, or until woken up - FALSE */
+static int SchedulerWaitForNextTask(scheduler_t* scheduler)
 {
-    int run_result = 0;
-    task_t* task_to_run = PQDequeue(scheduler->pqueue);
+    struct pollfd wakeup = {0};
+    struct timespec timeout = {0};
+    struct timespec* timeout_ptr = NULL;
+    eventfd_t events = 0;
+    int ready = 0;
 
     assert(NULL != scheduler);
 
-    scheduler->is_task_running = TRUE;
-    run_result = TaskRun(task_to_run);
-
-    if (!scheduler->is_cleared && TRUE == run_result)
+    /* nothing queued - sleep until a command or a finished task arrives */
+    if (0 != scheduler->ops->size(scheduler->queue))
     {
-        if (FAIL == TaskUpdateTimeToRun(task_to_run))
+        task_time_t deadline = scheduler->ops->next_deadline(scheduler->queue);
+        task_time_t now = TaskTimeNow();
+
+        if (now >= deadline)
         {
-            scheduler->is_task_running = FALSE;
-            return TIME_FAILURE;
+            return TRUE;
         }
 
-        if (FAIL == PQEnqueue(scheduler->pqueue, task_to_run))
+        timeout = ToTimespec(deadline - now);
+        timeout_ptr = &timeout;
+    }
+
+    wakeup.fd = scheduler->wakeup_fd;
+    wakeup.events = POLLIN;
+    ready = ppoll(&wakeup, 1, timeout_ptr, NULL);
+    if (0 < ready)
+    {
+        eventfd_read(scheduler->wakeup_fd, &events);
+        return FALSE;
+    }
+
+    /* interrupted by a signal - the caller re-checks the deadline, a task never runs early */
+    return 0 == ready;
+}
+
+/* runs every task due at one reading of the clock, then re-inserts them together */
+static run_status_t SchedulerRunDueTasks(scheduler_t* scheduler)
+{
+    run_status_t status = SUCCESSFULL_RUN;
+    run_status_t flush_status = SUCCESSFULL_RUN;
+    task_time_t now = TaskTimeNow();
+    task_t* task = NULL;
+
+    assert(NULL != scheduler);
+
+    /* no task may come back due in the same batch - the re-armed wait for the flush */
+    while (SUCCESSFULL_RUN == status && TRUE == scheduler->is_scheduler_running &&
+           NULL != (task = scheduler->ops->dequeue_due(scheduler->queue, now)))
+    {
+        int run_result = 0;
+
+        if (SchedulerIsCancelled(scheduler, task))
         {
-            scheduler->is_task_running = FALSE;
-            return ENQUEUE_FAIL;
+            SchedulerDestroyTask(scheduler, task);
+            continue;
         }
+
+        SchedulerSetPlace(scheduler, task, PLACE_RUNNING);
+        scheduler->running_tasks = 1;
+        scheduler->running_task = task;
+        run_result = TaskRun(task);
+        scheduler->running_task = NULL;
+        scheduler->running_tasks = 0;
+
+        status = SchedulerRearmTask(scheduler, task, run_result);
     }
-    else
+
+    flush_status = SchedulerFlushRearmed(scheduler);
+
+    return (SUCCESSFULL_RUN != status) ? status : flush_status;
+}
+
+static run_status_t SchedulerRearmTask(scheduler_t* scheduler, task_t* task, int run_result)
+{
+    if (SchedulerIsCancelled(scheduler, task) || TRUE != run_result)
+    {
+        SchedulerDestroyTask(scheduler, task);
+        return SUCCESSFULL_RUN;
+    }
+
+    if (SUCCESS != TaskUpdateTimeToRun(task))
+    {
+        SchedulerDestroyTask(scheduler, task);
+        return TIME_FAILURE;
+    }
+
+    if (scheduler->rearmed_count == scheduler->rearmed_capacity)
     {
-        TaskDestroy(task_to_run);
+        size_t new_capacity = (0 == scheduler->rearmed_capacity) ? 64 : scheduler->rearmed_capacity * 2;
+        task_t** rearmed = (task_t**)realloc(scheduler->rearmed, new_capacity * sizeof(task_t*));
+
+        /* no room in the batch - insert on its own */
+        if (NULL == rearmed)
+        {
+            if (FAIL == scheduler->ops->enqueue(scheduler->queue, task))
+            {
+                SchedulerDestroyTask(scheduler, task);
+                return ENQUEUE_FAIL;
+            }
+            SchedulerSetPlace(scheduler, task, PLACE_QUEUE);
+
+            return SUCCESSFULL_RUN;
+        }
+
+        scheduler->rearmed = rearmed;
+        scheduler->rearmed_capacity = new_capacity;
     }
 
-    scheduler->is_task_running = FALSE;
+    SchedulerSetPlace(scheduler, task, PLACE_REARMED);
+    scheduler->rearmed[scheduler->rearmed_count++] = task;
 
     return SUCCESSFULL_RUN;
 }
 
-static int SchedulerComperator(void* task1, void* task2)
+static run_status_t SchedulerFlushRearmed(scheduler_t* scheduler)
 {
-    time_t time1 = TaskGetTimeToRun((task_t*)task1);
-    time_t time2 = TaskGetTimeToRun((task_t*)task2);
+    size_t count = 0;
+    size_t enqueued = 0;
+    size_t i = 0;
 
-    return time1 - time2;
-}
+    /* cancelled by a later task of the batch */
+    for (i = 0; i < scheduler->rearmed_count; ++i)
+    {
+        if (SchedulerIsCancelled(scheduler, scheduler->rearmed[i]))
+        {
+            SchedulerDestroyTask(scheduler, scheduler->rearmed[i]);
+        }
+        else
+        {
+            SchedulerSetPlace(scheduler, scheduler->rearmed[i], PLACE_QUEUE);
+            scheduler->rearmed[count++] = scheduler->rearmed[i];
+        }
+    }
 
-static int IsTaskMatchWrapper(void* id, void* task)
-{
-    return UIDIsEqual(*(UID_t*)id, TaskGetUID((task_t*)task));
-}
\ No newline at end of file
+    scheduler->rearmed_count = count;
+    if (0 == count)
+    {
+        return SUCCESSFULL_RUN;
+    }
+
+    enqueued = scheduler->ops->enqueue_bulk(scheduler->queue, scheduler->rearmed, count);
+    scheduler->rearmed_count = 0;
+    if (enqueued == count)
+    {
+        return SUCCESSFULL_RUN;
+    }
+
+    while (enqueued < count)
+    {
+        SchedulerDestroyTask(scheduler, scheduler->rearmed[enqueued++]);
+    }
+
+    return ENQUEUE_FAIL;
+}
+
+/* a task that ran in the current batch is not in the queue yet, only the batch is searched */
+static size_t SchedulerFindRearmed(scheduler_t* scheduler, task_t* task)
+{
+    size_t i = 0;
+
+    for (i = 0; i < scheduler->rearmed_count && task != scheduler->rearmed[i]; ++i)
+    {
+    }
+
+    return i;
+}
+
+/* creates, tracks and enqueues the whole array - all or nothing */
+static int SchedulerAddDescs(scheduler_t* scheduler, const scheduler_task_desc_t* tasks, size_t count,
+                             UID_t* task_ids, sched_handle_t* handles)
+{
+    task_t** created = NULL;
+    size_t enqueued = 0;
+    size_t i = 0;
+
+    if (SUCCESS != SchedulerReserveSlots(scheduler, count))
+    {
+        return FAIL;
+    }
+
+    created = (task_t**)malloc(count * sizeof(task_t*));
+    if (NULL == created && 0 != count)
+    {
+        return FAIL;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        created[i] = TaskCreateFromSlab(scheduler->tasks, tasks[i].operation, tasks[i].args,
+                                        (task_time_t)tasks[i].interval_us * NSEC_PER_USEC,
+                                        tasks[i].cleanup_op, tasks[i].cleanup_args);
+        if (NULL == created[i])
+        {
+            break;
+        }
+        TaskSetMode(created[i], tasks[i].mode, tasks[i].overrun);
+        TaskSetStats(created[i], tasks[i].stats);
+        SchedulerTrack(scheduler, created[i]);
+    }
+
+    /* one build of the queue for the whole array */
+    if (i == count)
+    {
+        enqueued = scheduler->ops->enqueue_bulk(scheduler->queue, created, count);
+    }
+
+    if (enqueued != count)
+    {
+        while (enqueued > 0)
+        {
+            scheduler->ops->remove(scheduler->queue, created[--enqueued]);
+        }
+        while (i > 0)
+        {
+            SchedulerDestroyTask(scheduler, created[--i]);
+        }
+        free(created);
+        return FAIL;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        if (NULL != task_ids)
+        {
+            task_ids[i] = TaskGetUID(created[i]);
+        }
+        if (NULL != handles)
+        {
+            handles[i].slot = created[i]->slot;
+            handles[i].generation = scheduler->slots[created[i]->slot].generation;
+        }
+    }
+
+    free(created);
+
+    return SUCCESS;
+}
+
+/* makes sure count tasks can be tracked without allocating */
+static int SchedulerReserveSlots(scheduler_t* scheduler, size_t count)
+{
+    size_t needed = 0;
+    size_t capacity = 0;
+    size_t i = 0;
+    task_slot_t* slots = NULL;
+
+    if (count <= scheduler->free_slots)
+    {
+        return SUCCESS;
+    }
+
+    needed = scheduler->slots_capacity + (count - scheduler->free_slots);
+    capacity = (0 == scheduler->slots_capacity) ? MIN_SLOTS : (size_t)scheduler->slots_capacity * 2;
+    if (capacity < needed)
+    {
+        capacity = needed;
+    }
+    if (capacity >= TASK_NO_SLOT)
+    {
+        return FAIL;
+    }
+
+    /* every tracked task is in the index too - sized along, tracking never allocates */
+    if (SUCCESS != HashReserve(scheduler->index, capacity))
+    {
+        return FAIL;
+    }
+
+    slots = (task_slot_t*)realloc(scheduler->slots, capacity * sizeof(task_slot_t));
+    if (NULL == slots)
+    {
+        return FAIL;
+    }
+
+    /* chained from the top down - the lowest new slot is handed out first */
+    for (i = capacity; i > scheduler->slots_capacity; --i)
+    {
+        slots[i - 1].task = NULL;
+        slots[i - 1].generation = 1;
+        slots[i - 1].is_cancelled = FALSE;
+        slots[i - 1].next_free = scheduler->free_slot;
+        scheduler->free_slot = (uint32_t)(i - 1);
+    }
+
+    scheduler->free_slots += (uint32_t)(capacity - scheduler->slots_capacity);
+    scheduler->slots_capacity = (uint32_t)capacity;
+    scheduler->slots = slots;
+
+    return SUCCESS;
+}
+
+/* takes a reserved slot */
+static void SchedulerTrack(scheduler_t* scheduler, task_t* task)
+{
+    task_slot_t* slot = &scheduler->slots[scheduler->free_slot];
+
+    task->slot = scheduler->free_slot;
+    scheduler->free_slot = slot->next_free;
+    --scheduler->free_slots;
+    slot->task = task;
+    slot->is_cancelled = FALSE;
+    slot->place = PLACE_QUEUE;
+    HashInsert(scheduler->index, &task->id, task);
+}
+
+/* every task the runner owns ends here - the slot is freed and its old handles go stale */
+static void SchedulerDestroyTask(scheduler_t* scheduler, task_t* task)
+{
+    if (TASK_NO_SLOT != task->slot)
+    {
+        task_slot_t* slot = &scheduler->slots[task->slot];
+
+        if (slot->is_cancelled)
+        {
+            --scheduler->cancelled;
+        }
+
+        slot->task = NULL;
+        slot->is_cancelled = FALSE;
+        slot->generation = (UINT32_MAX == slot->generation) ? 1 : slot->generation + 1;
+        slot->next_free = scheduler->free_slot;
+        scheduler->free_slot = task->slot;
+        ++scheduler->free_slots;
+        HashRemove(scheduler->index, &task->id);
+    }
+
+    TaskDestroy(task);
+}
+
+static int SchedulerIsCancelled(const scheduler_t* scheduler, const task_t* task)
+{
+    return TASK_NO_SLOT != task->slot && scheduler->slots[task->slot].is_cancelled;
+}
+
+static void SchedulerMarkCancelled(scheduler_t* scheduler, task_t* task)
+{
+    assert(TASK_NO_SLOT != task->slot);
+
+    scheduler->slots[task->slot].is_cancelled = TRUE;
+    ++scheduler->cancelled;
+}
+
+static void SchedulerSetPlace(scheduler_t* scheduler, task_t* task, task_place_t place)
+{
+    assert(TASK_NO_SLOT != task->slot);
+
+    scheduler->slots[task->slot].place = place;
+}
+
+static size_t HashUID(const void* task_id)
+{
+    const UID_t* uid = (const UID_t*)task_id;
+
+    return (size_t)(uid->high ^ uid->low);
+}
+
+static int IsTaskOfUID(const void* task, const void* task_id)
+{
+    return UIDIsEqual(((const task_t*)task)->id, *(const UID_t*)task_id);
+}
+
+static int DestroyIfCancelled(void* task, void* scheduler)
+{
+    if (!SchedulerIsCancelled((scheduler_t*)scheduler, (task_t*)task))
+    {
+        return FALSE;
+    }
+
+    SchedulerDestroyTask((scheduler_t*)scheduler, (task_t*)task);
+
+    return TRUE;
+}
+
+static int DestroyTaskWrapper(void* task, void* scheduler)
+{
+    SchedulerDestroyTask((scheduler_t*)scheduler, (task_t*)task);
+
+    return TRUE;
+}
+
+static int ParallelInit(parallel_run_t* run, scheduler_t* scheduler)
+{
+    run->scheduler = scheduler;
+    run->completed = NULL;
+    run->reaping = NULL;
+    run->completed_count = 0;
+    run->capacity = 0;
+
+    if (0 != pthread_mutex_init(&run->lock, NULL))
+    {
+        return FAIL;
+    }
+
+    return SUCCESS;
+}
+
+static void ParallelDestroy(parallel_run_t* run)
+{
+    pthread_mutex_destroy(&run->lock);
+    free(run->completed);
+    free(run->reaping);
+}
+
+/* worker side - runs the task and hands it back to the timer thread */
+static void ParallelRunTask(void* task, void* context)
+{
+    parallel_run_t* run = (parallel_run_t*)context;
+    int run_result = TaskRun((task_t*)task);
+
+    pthread_mutex_lock(&run->lock);
+    run->completed[run->completed_count].task = (task_t*)task;
+    run->completed[run->completed_count].run_result = run_result;
+    ++run->completed_count;
+    pthread_mutex_unlock(&run->lock);
+
+    SchedulerWakeUp(run->scheduler);
+}
+
+/* hands every due task to the workers, a task is out of the queue until it is reaped */
+static run_status_t ParallelDispatch(scheduler_t* scheduler, parallel_run_t* run, workpool_t* pool)
+{
+    task_time_t now = TaskTimeNow();
+    task_t* task = NULL;
+
+    while (NULL != (task = scheduler->ops->dequeue_due(scheduler->queue, now)))
+    {
+        if (SchedulerIsCancelled(scheduler, task))
+        {
+            SchedulerDestroyTask(scheduler, task);
+            continue;
+        }
+
+        /* completions can never outnumber the tasks in flight */
+        if (scheduler->running_tasks == run->capacity)
+        {
+            size_t new_capacity = (0 == run->capacity) ? 16 : run->capacity * 2;
+            completion_t* completed = NULL;
+            completion_t* reaping = (completion_t*)realloc(run->reaping, new_capacity * sizeof(completion_t));
+
+            if (NULL != reaping)
+            {
+                run->reaping = reaping;
+                pthread_mutex_lock(&run->lock);
+                completed = (completion_t*)realloc(run->completed, new_capacity * sizeof(completion_t));
+                if (NULL != completed)
+                {
+                    run->completed = completed;
+                    run->capacity = new_capacity;
+                }
+                pthread_mutex_unlock(&run->lock);
+            }
+
+            if (NULL == completed)
+            {
+                scheduler->ops->enqueue(scheduler->queue, task);
+                return ENQUEUE_FAIL;
+            }
+        }
+
+        SchedulerSetPlace(scheduler, task, PLACE_RUNNING);
+        ++scheduler->running_tasks;
+        if (SUCCESS != WorkPoolSubmit(pool, task))
+        {
+            --scheduler->running_tasks;
+            SchedulerSetPlace(scheduler, task, PLACE_QUEUE);
+            scheduler->ops->enqueue(scheduler->queue, task);
+            return ENQUEUE_FAIL;
+        }
+    }
+
+    return SUCCESSFULL_RUN;
+}
+
+/* re-arms or destroys every task the workers finished */
+static run_status_t ParallelReap(scheduler_t* scheduler, parallel_run_t* run)
+{
+    run_status_t status = SUCCESSFULL_RUN;
+    completion_t* reaping = NULL;
+    size_t count = 0;
+    run_status_t rearm_status = SUCCESSFULL_RUN;
+    size_t i = 0;
+
+    pthread_mutex_lock(&run->lock);
+    reaping = run->completed;
+    run->completed = run->reaping;
+    run->reaping = reaping;
+    count = run->completed_count;
+    run->completed_count = 0;
+    pthread_mutex_unlock(&run->lock);
+
+    for (i = 0; i < count; ++i)
+    {
+        --scheduler->running_tasks;
+        rearm_status = SchedulerRearmTask(scheduler, reaping[i].task, reaping[i].run_result);
+        if (SUCCESSFULL_RUN != rearm_status)
+        {
+            status = rearm_status;
+        }
+    }
+
+    rearm_status = SchedulerFlushRearmed(scheduler);
+
+    return (SUCCESSFULL_RUN != status) ? status : rearm_status;
+}
+
+static struct timespec ToTimespec(task_time_t time)
+{
+    struct timespec converted = {0};
+
+    converted.tv_sec = (time_t)(time / NSEC_PER_SEC);
+    converted.tv_nsec = (long)(time % NSEC_PER_SEC);
+
+    return converted;
+}
+
+static int SchedulerComperator(void* task1, void* task2)
+{
+    task_time_t time1 = TaskGetTimeToRun((task_t*)task1);
+    task_time_t time2 = TaskGetTimeToRun((task_t*)task2);
+
+    return (time1 > time2) - (time1 < time2);
+}
+
+static void SetTaskQueueIndex(void* task, size_t index)
+{
+    ((task_t*)task)->queue_index = index;
+}
+
+static void* THeapQueueCreate(const scheduler_config_t* config)
+{
+    (void)config;
+
+    return THeapCreate(offsetof(task_t, queue_index));
+}
+
+static void THeapQueueDestroy(void* queue)
+{
+    THeapDestroy((theap_t*)queue);
+}
+
+static int THeapQueueEnqueue(void* queue, task_t* task)
+{
+    return (SUCCESS == THeapPush((theap_t*)queue, TaskGetTimeToRun(task), task)) ? SUCCESS : FAIL;
+}
+
+static size_t THeapQueueEnqueueBulk(void* queue, task_t** tasks, size_t count)
+{
+    if (SUCCESS != THeapPushBulk((theap_t*)queue, (void* const*)tasks, count, offsetof(task_t, time_to_run)))
+    {
+        return 0;
+    }
+
+    return count;
+}
+
+static task_t* THeapQueueDequeueDue(void* queue, task_time_t now)
+{
+    if (THeapPeekDeadline((theap_t*)queue) > now)
+    {
+        return NULL;
+    }
+
+    return (task_t*)THeapPop((theap_t*)queue);
+}
+
+static task_t* THeapQueuePop(void* queue)
+{
+    return (task_t*)THeapPop((theap_t*)queue);
+}
+
+static task_time_t THeapQueueNextDeadline(void* queue)
+{
+    return THeapPeekDeadline((theap_t*)queue);
+}
+
+static void THeapQueueRemove(void* queue, task_t* task)
+{
+    THeapRemoveAt((theap_t*)queue, task->queue_index);
+}
+
+static size_t THeapQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params)
+{
+    return THeapRemoveIf((theap_t*)queue, is_match, params);
+}
+
+static size_t THeapQueueSize(const void* queue)
+{
+    return THeapSize((const theap_t*)queue);
+}
+
+static void* PQQueueCreate(const scheduler_config_t* config)
+{
+    size_t arity = (0 != config->heap_arity) ? config->heap_arity : DEFAULT_HEAP_ARITY;
+
+    return PQCreateWithArity(SchedulerComperator, SetTaskQueueIndex, arity);
+}
+
+static void PQQueueDestroy(void* queue)
+{
+    PQDestroy((pqueue_t*)queue);
+}
+
+static int PQQueueEnqueue(void* queue, task_t* task)
+{
+    return PQEnqueue((pqueue_t*)queue, task);
+}
+
+static size_t PQQueueEnqueueBulk(void* queue, task_t** tasks, size_t count)
+{
+    size_t i = 0;
+
+    for (i = 0; i < count && FAIL != PQQueueEnqueue(queue, tasks[i]); ++i)
+    {
+    }
+
+    return i;
+}
+
+static task_t* PQQueueDequeueDue(void* queue, task_time_t now)
+{
+    task_t* task = (task_t*)PQPeek((pqueue_t*)queue);
+
+    if (NULL == task || TaskGetTimeToRun(task) > now)
+    {
+        return NULL;
+    }
+
+    return (task_t*)PQDequeue((pqueue_t*)queue);
+}
+
+static task_t* PQQueuePop(void* queue)
+{
+    return (task_t*)PQDequeue((pqueue_t*)queue);
+}
+
+static task_time_t PQQueueNextDeadline(void* queue)
+{
+    return TaskGetTimeToRun((task_t*)PQPeek((pqueue_t*)queue));
+}
+
+static void PQQueueRemove(void* queue, task_t* task)
+{
+    PQEraseAt((pqueue_t*)queue, task->queue_index);
+}
+
+static size_t PQQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params)
+{
+    return PQEraseIf((pqueue_t*)queue, is_match, params);
+}
+
+static size_t PQQueueSize(const void* queue)
+{
+    return PQSize((const pqueue_t*)queue);
+}
+
+static void* WheelQueueCreate(const scheduler_config_t* config)
+{
+    size_t tick_us = (0 != config->wheel_tick_us) ? config->wheel_tick_us : DEFAULT_WHEEL_TICK_US;
+
+    return TWheelCreate((task_time_t)tick_us * NSEC_PER_USEC, TaskTimeNow());
+}
+
+static void WheelQueueDestroy(void* queue)
+{
+    TWheelDestroy((twheel_t*)queue);
+}
+
+static int WheelQueueEnqueue(void* queue, task_t* task)
+{
+    task->queue_node = TWheelInsert((twheel_t*)queue, task, TaskGetTimeToRun(task));
+
+    return (NULL == task->queue_node) ? FAIL : SUCCESS;
+}
+
+/* every insert is O(1) already */
+static size_t WheelQueueEnqueueBulk(void* queue, task_t** tasks, size_t count)
+{
+    size_t i = 0;
+
+    for (i = 0; i < count && FAIL != WheelQueueEnqueue(queue, tasks[i]); ++i)
+    {
+    }
+
+    return i;
+}
+
+static task_t* WheelQueueDequeueDue(void* queue, task_time_t now)
+{
+    TWheelAdvance((twheel_t*)queue, now);
+
+    return (task_t*)TWheelPopExpired((twheel_t*)queue);
+}
+
+static task_t* WheelQueuePop(void* queue)
+{
+    return (task_t*)TWheelPop((twheel_t*)queue);
+}
+
+static task_time_t WheelQueueNextDeadline(void* queue)
+{
+    return TWheelNextExpiry((twheel_t*)queue);
+}
+
+static void WheelQueueRemove(void* queue, task_t* task)
+{
+    TWheelRemove((twheel_t*)queue, (twheel_node_t*)task->queue_node);
+}
+
+static size_t WheelQueueRemoveIf(void* queue, int (*is_match)(void*, void*), void* params)
+{
+    return TWheelRemoveIf((twheel_t*)queue, is_match, params);
+}
+
+static size_t WheelQueueSize(const void* queue)
+{
+    return TWheelSize((const twheel_t*)queue);
+}
@@ -0,0 +1,139 @@
+/*
+Author: Roi Sasson
+Date: 15-03-2025
+Reviewer:
+*/
+#include <stdlib.h> /* malloc, free */
+#include <stddef.h> /* max_align_t */
+#include <assert.h> /* assert */
+
+#include "slab.h" /* API */
+
+#define ALIGN_UP(size, align) (((size) + (align) - 1) / (align) * (align))
+
+typedef struct free_object
+{
+    struct free_object* next;
+} free_object_t;
+
+typedef struct chunk
+{
+    struct chunk* next;
+    max_align_t objects[]; /* keeps the objects aligned for any type */
+} chunk_t;
+
+struct slab
+{
+    chunk_t* chunks;
+    free_object_t* free_objects;
+    size_t object_size;
+    size_t objects_per_chunk;
+    size_t chunk_count;
+};
+
+static int SlabGrow(slab_t* slab);
+
+slab_t* SlabCreate(size_t object_size, size_t objects_per_chunk)
+{
+    slab_t* slab = NULL;
+
+    assert(0 < object_size);
+    assert(0 < objects_per_chunk);
+
+    slab = (slab_t*)malloc(sizeof(slab_t));
+    if (NULL == slab)
+    {
+        return NULL;
+    }
+
+    /* a free object holds the freelist link */
+    if (object_size < sizeof(free_object_t))
+    {
+        object_size = sizeof(free_object_t);
+    }
+
+    slab->chunks = NULL;
+    slab->free_objects = NULL;
+    slab->object_size = ALIGN_UP(object_size, _Alignof(max_align_t));
+    slab->objects_per_chunk = objects_per_chunk;
+    slab->chunk_count = 0;
+
+    return slab;
+}
+
+void SlabDestroy(slab_t* slab)
+{
+    chunk_t* chunk = NULL;
+
+    assert(NULL != slab);
+
+    while (NULL != slab->chunks)
+    {
+        chunk = slab->chunks;
+        slab->chunks = chunk->next;
+        free(chunk);
+    }
+
+    free(slab);
+}
+
+void* SlabAlloc(slab_t* slab)
+{
+    free_object_t* object = NULL;
+
+    assert(NULL != slab);
+
+    if (NULL == slab->free_objects && 0 != SlabGrow(slab))
+    {
+        return NULL;
+    }
+
+    object = slab->free_objects;
+    slab->free_objects = object->next;
+
+    return object;
+}
+
+void SlabFree(slab_t* slab, void* object)
+{
+    free_object_t* freed = (free_object_t*)object;
+
+    assert(NULL != slab);
+    assert(NULL != object);
+
+    freed->next = slab->free_objects;
+    slab->free_objects = freed;
+}
+
+size_t SlabChunks(const slab_t* slab)
+{
+    assert(NULL != slab);
+
+    return slab->chunk_count;
+}
+
+static int SlabGrow(slab_t* slab)
+{
+    chunk_t* chunk = (chunk_t*)malloc(sizeof(chunk_t) + slab->object_size * slab->objects_per_chunk);
+    char* object = NULL;
+    size_t i = 0;
+
+    if (NULL == chunk)
+    {
+        return 1;
+    }
+
+    chunk->next = slab->chunks;
+    slab->chunks = chunk;
+    ++slab->chunk_count;
+
+    /* pushed backwards - objects are handed out in address order */
+    object = (char*)chunk->objects + slab->object_size * slab->objects_per_chunk;
+    for (i = 0; i < slab->objects_per_chunk; ++i)
+    {
+        object -= slab->object_size;
+        SlabFree(slab, object);
+    }
+
+    return 0;
+}
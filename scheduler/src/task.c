@@ -4,35 +4,66 @@ Date: 20-12-2024
 Reviewer:
 */
 
-#include <stdlib.h> /* malloc */
+#include <stdlib.h> /* malloc, free */
 #include <assert.h> /* assert */
+#include <time.h>   /* clock_gettime */
 
 #include "task.h"
 
-#define TIME_FAILURE (-1)
+#define NSEC_PER_SEC (1000000000ULL)
+#define NSEC_PER_USEC (1000ULL)
 #define SUCCESS (0)
 #define FAIL (1)
 #define FALSE (0)
 #define TRUE (1)
 
+static void TaskFree(task_t* task);
+static void TaskRecordRun(task_stats_record_t* stats, task_time_t lateness, task_time_t exec, int result);
+static void AddRelaxed(_Atomic(uint64_t)* counter, uint64_t value);
+static size_t LatenessBucket(task_time_t lateness);
+
 task_t* TaskCreate(operation_t operation, void* args, size_t interval, cleanup_op_t cleanup_op, void* cleanup_args)
 {
-	task_t* task = (task_t*)malloc(sizeof(task_t));
+	return TaskCreateNs(operation, args, (task_time_t)interval * NSEC_PER_SEC, cleanup_op, cleanup_args);
+}
+
+task_t* TaskCreateNs(operation_t operation, void* args, task_time_t interval, cleanup_op_t cleanup_op, void* cleanup_args)
+{
+	return TaskCreateFromSlab(NULL, operation, args, interval, cleanup_op, cleanup_args);
+}
+
+task_t* TaskCreateFromSlab(slab_t* slab, operation_t operation, void* args, task_time_t interval, cleanup_op_t cleanup_op, void* cleanup_args)
+{
+	task_t* task = (NULL != slab) ? (task_t*)SlabAlloc(slab) : (task_t*)malloc(sizeof(task_t));
 	
 	assert(NULL != operation);
 	
+	if (NULL == task)
+	{
+		return NULL;
+	}
+	
+	task->slab = slab;
+	task->mode = TASK_FIXED_DELAY;
+	task->overrun = TASK_OVERRUN_SKIP;
+	task->lateness.runs = 0;
+	task->lateness.skipped_periods = 0;
+	task->lateness.last = 0;
+	task->lateness.max = 0;
+	task->lateness.total = 0;
+	task->stats = NULL;
+	task->slot = TASK_NO_SLOT;
 	task->id = UIDCreate();
 	if (UIDIsEqual(BadUID, task->id))
 	{
-		free(task);
+		TaskFree(task);
 		return NULL;
 	}
 	
 	task->interval = interval;
-	TaskUpdateTimeToRun(task);
-	if (TIME_FAILURE == task->time_to_run)
+	if (SUCCESS != TaskUpdateTimeToRun(task))
 	{
-		free(task);
+		TaskFree(task);
 		return NULL;
 	}
 	
@@ -48,28 +79,122 @@ void TaskDestroy(task_t* task)
 {
 	assert(NULL != task);
 	
-	if (NULL != task->cleanup_op)
+	TaskCleanup(task);
+	TaskFree(task);
+}
+
+void TaskCleanup(task_t* task)
+{
+	cleanup_op_t cleanup_op = NULL;
+	
+	assert(NULL != task);
+	
+	cleanup_op = task->cleanup_op;
+	task->cleanup_op = NULL;
+	if (NULL != cleanup_op)
+	{
+		cleanup_op(task->cleanup_args);
+	}
+}
+
+void TaskSetMode(task_t* task, task_mode_t mode, task_overrun_t overrun)
+{
+	assert(NULL != task);
+	
+	task->mode = mode;
+	task->overrun = overrun;
+}
+
+void TaskSetStats(task_t* task, task_stats_record_t* stats)
+{
+	assert(NULL != task);
+	
+	task->stats = stats;
+}
+
+void TaskStatsInit(task_stats_record_t* stats)
+{
+	size_t i = 0;
+	
+	assert(NULL != stats);
+	
+	atomic_init(&stats->sequence, 0);
+	atomic_init(&stats->runs, 0);
+	atomic_init(&stats->failures, 0);
+	atomic_init(&stats->exec_total, 0);
+	atomic_init(&stats->exec_max, 0);
+	for (i = 0; i < TASK_LATENESS_BUCKETS; ++i)
 	{
-		task->cleanup_op(task->cleanup_args);
+		atomic_init(&stats->lateness[i], 0);
 	}
+}
+
+void TaskStatsSnapshot(const task_stats_record_t* stats, task_stats_t* snapshot)
+{
+	/* the loads don't change the record, they just can't take a const atomic */
+	task_stats_record_t* record = (task_stats_record_t*)stats;
+	unsigned int begin = 0;
+	unsigned int end = 0;
+	size_t i = 0;
+	
+	assert(NULL != stats);
+	assert(NULL != snapshot);
 	
-	free(task);
+	do
+	{
+		begin = atomic_load_explicit(&record->sequence, memory_order_acquire);
+		snapshot->runs = atomic_load_explicit(&record->runs, memory_order_relaxed);
+		snapshot->failures = atomic_load_explicit(&record->failures, memory_order_relaxed);
+		snapshot->exec_total = atomic_load_explicit(&record->exec_total, memory_order_relaxed);
+		snapshot->exec_max = atomic_load_explicit(&record->exec_max, memory_order_relaxed);
+		for (i = 0; i < TASK_LATENESS_BUCKETS; ++i)
+		{
+			snapshot->lateness[i] = atomic_load_explicit(&record->lateness[i], memory_order_relaxed);
+		}
+		atomic_thread_fence(memory_order_acquire);
+		end = atomic_load_explicit(&record->sequence, memory_order_relaxed);
+	} while (0 != (begin & 1) || begin != end);
 }
 
 int TaskRun(task_t* task)
 {
+	task_time_t started = TaskTimeNow();
+	int result = 0;
 	assert(NULL != task);
 	
-	return task->operation(task->args);
+	task->lateness.last = (started > task->time_to_run) ? started - task->time_to_run : 0;
+	task->lateness.total += task->lateness.last;
+	if (task->lateness.last > task->lateness.max)
+	{
+		task->lateness.max = task->lateness.last;
+	}
+	++task->lateness.runs;
+	
+	if (NULL == task->stats)
+	{
+		return task->operation(task->args);
+	}
+	
+	result = task->operation(task->args);
+	TaskRecordRun(task->stats, task->lateness.last, TaskTimeNow() - started, result);
+	
+	return result;
 }
 
-time_t TaskGetTimeToRun(const task_t* task)
+task_time_t TaskGetTimeToRun(const task_t* task)
 {
 	assert(NULL != task);
 	
 	return task->time_to_run;
 }
 
+task_lateness_t TaskGetLateness(const task_t* task)
+{
+	assert(NULL != task);
+	
+	return task->lateness;
+}
+
 UID_t TaskGetUID(const task_t* task)
 {
 	assert(NULL != task);
@@ -87,15 +212,101 @@ int TaskIsMatch(const task_t* task1, const task_t* task2)
 
 int TaskUpdateTimeToRun(task_t* task)
 {
-	time_t timer = time(NULL);
+	task_time_t timer = TaskTimeNow();
+	task_time_t missed = 0;
 	assert(NULL != task);
 	
-	if (TIME_FAILURE == timer)
+	if (0 == timer)
 	{
 		return FAIL;
 	}
 	
-	task->time_to_run = timer + (time_t)task->interval;
+	if (TASK_FIXED_DELAY == task->mode || 0 == task->interval)
+	{
+		task->time_to_run = timer + task->interval;
+		return SUCCESS;
+	}
+	
+	/* fixed rate - step on the grid of the first deadline, the run time doesn't add up */
+	task->time_to_run += task->interval;
+	if (task->time_to_run > timer)
+	{
+		return SUCCESS;
+	}
+	
+	missed = (timer - task->time_to_run) / task->interval + 1;
+	switch (task->overrun)
+	{
+		case TASK_OVERRUN_SKIP:
+			task->time_to_run += missed * task->interval;
+			task->lateness.skipped_periods += missed;
+			break;
+		case TASK_OVERRUN_COALESCE:
+			task->time_to_run += (missed - 1) * task->interval;
+			task->lateness.skipped_periods += missed - 1;
+			break;
+		case TASK_OVERRUN_CATCH_UP:
+		default:
+			break;
+	}
 	
 	return SUCCESS;
 }
+
+task_time_t TaskTimeNow(void)
+{
+	struct timespec now = {0};
+	
+	if (0 != clock_gettime(CLOCK_MONOTONIC, &now))
+	{
+		return 0;
+	}
+	
+	return (task_time_t)now.tv_sec * NSEC_PER_SEC + (task_time_t)now.tv_nsec;
+}
+
+/* a seqlock with a single writer - the thread the task runs on */
+static void TaskRecordRun(task_stats_record_t* stats, task_time_t lateness, task_time_t exec, int result)
+{
+	unsigned int sequence = atomic_load_explicit(&stats->sequence, memory_order_relaxed);
+	
+	atomic_store_explicit(&stats->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	
+	AddRelaxed(&stats->runs, 1);
+	AddRelaxed(&stats->failures, result < 0);
+	AddRelaxed(&stats->exec_total, exec);
+	if (exec > atomic_load_explicit(&stats->exec_max, memory_order_relaxed))
+	{
+		atomic_store_explicit(&stats->exec_max, exec, memory_order_relaxed);
+	}
+	AddRelaxed(&stats->lateness[LatenessBucket(lateness)], 1);
+	
+	atomic_store_explicit(&stats->sequence, sequence + 2, memory_order_release);
+}
+
+/* only the owner writes - no read-modify-write needed */
+static void AddRelaxed(_Atomic(uint64_t)* counter, uint64_t value)
+{
+	atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static size_t LatenessBucket(task_time_t lateness)
+{
+	task_time_t us = lateness / NSEC_PER_USEC;
+	size_t bucket = (0 == us) ? 0 : (size_t)(64 - __builtin_clzll(us));
+	
+	return (bucket < TASK_LATENESS_BUCKETS) ? bucket : TASK_LATENESS_BUCKETS - 1;
+}
+
+static void TaskFree(task_t* task)
+{
+	if (NULL != task->slab)
+	{
+		SlabFree(task->slab, task);
+	}
+	else
+	{
+		free(task);
+	}
+}
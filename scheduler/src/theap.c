@@ -0,0 +1,307 @@
+/*
+Author: Roi Sasson
+Date: 18-03-2025
+Reviewer:
+*/
+#include <stdlib.h> /* malloc, realloc, free */
+#include <assert.h> /* assert */
+
+#include "theap.h" /* API */
+
+#define SUCCESS (0)
+#define FAIL (1)
+#define MIN_CAPACITY (64)
+#define GROWTH_FACTOR (2)
+#define PARENT(index) (((index) - 1) / 2)
+#define LEFT_CHILD(index) (2 * (index) + 1)
+
+typedef struct theap_entry
+{
+    uint64_t deadline;
+    void* data;
+} theap_entry_t;
+
+struct theap
+{
+    theap_entry_t* entries;
+    size_t size;
+    size_t capacity;
+    size_t index_offset;
+};
+
+static int Reserve(theap_t* heap, size_t capacity);
+static void SiftUp(theap_t* heap, size_t index, theap_entry_t entry);
+static void SiftDown(theap_t* heap, size_t index, theap_entry_t entry);
+static void Place(theap_t* heap, size_t index, theap_entry_t entry);
+
+theap_t* THeapCreate(size_t index_offset)
+{
+    theap_t* heap = (theap_t*)malloc(sizeof(theap_t));
+    if (NULL == heap)
+    {
+        return NULL;
+    }
+
+    heap->entries = (theap_entry_t*)malloc(MIN_CAPACITY * sizeof(theap_entry_t));
+    if (NULL == heap->entries)
+    {
+        free(heap);
+        return NULL;
+    }
+
+    heap->size = 0;
+    heap->capacity = MIN_CAPACITY;
+    heap->index_offset = index_offset;
+
+    return heap;
+}
+
+void THeapDestroy(theap_t* heap)
+{
+    assert(NULL != heap);
+
+    free(heap->entries);
+    free(heap);
+}
+
+int THeapPush(theap_t* heap, uint64_t deadline, void* data)
+{
+    theap_entry_t entry;
+
+    assert(NULL != heap);
+
+    if (SUCCESS != Reserve(heap, heap->size + 1))
+    {
+        return FAIL;
+    }
+
+    entry.deadline = deadline;
+    entry.data = data;
+    SiftUp(heap, heap->size++, entry);
+
+    return SUCCESS;
+}
+
+int THeapPushBulk(theap_t* heap, void* const* data, size_t count, size_t deadline_offset)
+{
+    theap_entry_t entry;
+    size_t old_size = 0;
+    size_t i = 0;
+
+    assert(NULL != heap);
+    assert(NULL != data || 0 == count);
+
+    if (SUCCESS != Reserve(heap, heap->size + count))
+    {
+        return FAIL;
+    }
+
+    old_size = heap->size;
+    for (i = 0; i < count; ++i)
+    {
+        entry.deadline = *(const uint64_t*)((const char*)data[i] + deadline_offset);
+        entry.data = data[i];
+        if (count < old_size)
+        {
+            SiftUp(heap, heap->size++, entry);
+        }
+        else
+        {
+            Place(heap, heap->size++, entry);
+        }
+    }
+
+    /* appended unordered - heapify bottom-up, O(n) */
+    if (count >= old_size && 1 < heap->size)
+    {
+        for (i = PARENT(heap->size - 1) + 1; i > 0; --i)
+        {
+            SiftDown(heap, i - 1, heap->entries[i - 1]);
+        }
+    }
+
+    return SUCCESS;
+}
+
+void* THeapPop(theap_t* heap)
+{
+    assert(NULL != heap);
+
+    return (0 == heap->size) ? NULL : THeapRemoveAt(heap, 0);
+}
+
+void* THeapPeek(const theap_t* heap)
+{
+    assert(NULL != heap);
+
+    return (0 == heap->size) ? NULL : heap->entries[0].data;
+}
+
+uint64_t THeapPeekDeadline(const theap_t* heap)
+{
+    assert(NULL != heap);
+
+    return (0 == heap->size) ? UINT64_MAX : heap->entries[0].deadline;
+}
+
+void* THeapRemoveAt(theap_t* heap, size_t index)
+{
+    void* data = NULL;
+    theap_entry_t last;
+
+    assert(NULL != heap);
+    assert(index < heap->size);
+
+    data = heap->entries[index].data;
+    last = heap->entries[--heap->size];
+    if (index == heap->size)
+    {
+        return data;
+    }
+
+    /* the last entry fills the hole - it may belong above or below it */
+    if (0 != index && last.deadline < heap->entries[PARENT(index)].deadline)
+    {
+        SiftUp(heap, index, last);
+    }
+    else
+    {
+        SiftDown(heap, index, last);
+    }
+
+    return data;
+}
+
+void* THeapFind(theap_t* heap, theap_is_match_t is_match, void* params)
+{
+    size_t i = 0;
+
+    assert(NULL != heap);
+    assert(NULL != is_match);
+
+    for (i = 0; i < heap->size; ++i)
+    {
+        if (is_match(heap->entries[i].data, params))
+        {
+            return heap->entries[i].data;
+        }
+    }
+
+    return NULL;
+}
+
+size_t THeapRemoveIf(theap_t* heap, theap_is_match_t is_match, void* params)
+{
+    size_t kept = 0;
+    size_t removed = 0;
+    size_t i = 0;
+
+    assert(NULL != heap);
+    assert(NULL != is_match);
+
+    for (i = 0; i < heap->size; ++i)
+    {
+        if (!is_match(heap->entries[i].data, params))
+        {
+            heap->entries[kept++] = heap->entries[i];
+        }
+    }
+
+    removed = heap->size - kept;
+    heap->size = kept;
+
+    /* heapify bottom-up, on the leaves SiftDown only writes the new index */
+    for (i = (0 == removed) ? 0 : heap->size; i > 0; --i)
+    {
+        SiftDown(heap, i - 1, heap->entries[i - 1]);
+    }
+
+    return removed;
+}
+
+size_t THeapSize(const theap_t* heap)
+{
+    assert(NULL != heap);
+
+    return heap->size;
+}
+
+int THeapIsEmpty(const theap_t* heap)
+{
+    assert(NULL != heap);
+
+    return 0 == heap->size;
+}
+
+static int Reserve(theap_t* heap, size_t capacity)
+{
+    size_t new_capacity = heap->capacity;
+    theap_entry_t* entries = NULL;
+
+    if (capacity <= heap->capacity)
+    {
+        return SUCCESS;
+    }
+
+    while (new_capacity < capacity)
+    {
+        new_capacity *= GROWTH_FACTOR;
+    }
+
+    entries = (theap_entry_t*)realloc(heap->entries, new_capacity * sizeof(theap_entry_t));
+    if (NULL == entries)
+    {
+        return FAIL;
+    }
+
+    heap->entries = entries;
+    heap->capacity = new_capacity;
+
+    return SUCCESS;
+}
+
+/* moves the hole at index up until entry fits, parents shift down into it */
+static void SiftUp(theap_t* heap, size_t index, theap_entry_t entry)
+{
+    while (0 != index && entry.deadline < heap->entries[PARENT(index)].deadline)
+    {
+        Place(heap, index, heap->entries[PARENT(index)]);
+        index = PARENT(index);
+    }
+
+    Place(heap, index, entry);
+}
+
+/* moves the hole at index down until entry fits, the smaller child shifts up */
+static void SiftDown(theap_t* heap, size_t index, theap_entry_t entry)
+{
+    size_t child = LEFT_CHILD(index);
+
+    while (child < heap->size)
+    {
+        if (child + 1 < heap->size && heap->entries[child + 1].deadline < heap->entries[child].deadline)
+        {
+            ++child;
+        }
+
+        if (entry.deadline <= heap->entries[child].deadline)
+        {
+            break;
+        }
+
+        Place(heap, index, heap->entries[child]);
+        index = child;
+        child = LEFT_CHILD(index);
+    }
+
+    Place(heap, index, entry);
+}
+
+static void Place(theap_t* heap, size_t index, theap_entry_t entry)
+{
+    heap->entries[index] = entry;
+    if (THEAP_NO_INDEX != heap->index_offset)
+    {
+        *(size_t*)((char*)entry.data + heap->index_offset) = index;
+    }
+}
@@ -0,0 +1,506 @@
+/*
+Author: Roi Sasson
+Date: 02-03-2025
+Reviewer:
+*/
+#include <stdlib.h> /* malloc, free */
+#include <assert.h> /* assert */
+
+#include "twheel.h" /* API */
+
+#define LEVEL_BITS (6)
+#define SLOTS (1 << LEVEL_BITS)
+#define SLOT_MASK (SLOTS - 1)
+#define LEVELS (8)
+#define NODES_PER_BLOCK (256)
+#define TRUE (1)
+#define FALSE (0)
+
+struct twheel_node
+{
+    twheel_node_t* next;
+    twheel_node_t* prev;
+    void* data;
+    uint64_t expires; /* in ticks */
+};
+
+typedef struct node_block
+{
+    struct node_block* next;
+    twheel_node_t nodes[NODES_PER_BLOCK];
+} node_block_t;
+
+struct twheel
+{
+    twheel_node_t slots[LEVELS][SLOTS]; /* list sentinels */
+    uint64_t pending[LEVELS];            /* bit per non-empty slot */
+    twheel_node_t expired;
+    uint64_t now;                        /* in ticks */
+    uint64_t tick;
+    size_t size;
+    node_block_t* blocks;
+    twheel_node_t* free_nodes;
+};
+
+static void ListInit(twheel_node_t* sentinel);
+static int ListIsEmpty(const twheel_node_t* sentinel);
+static void ListPushBack(twheel_node_t* sentinel, twheel_node_t* node);
+static void ListUnlink(twheel_node_t* node);
+static void ListSplice(twheel_node_t* to, twheel_node_t* from);
+static void Place(twheel_t* wheel, twheel_node_t* node);
+static twheel_node_t* AllocNode(twheel_t* wheel);
+static void FreeNode(twheel_t* wheel, twheel_node_t* node);
+static uint64_t PassedSlots(uint64_t from, uint64_t to, int level);
+static int FirstSetBit(uint64_t bits);
+static int LastSetBit(uint64_t bits);
+static size_t ListRemoveIf(twheel_t* wheel, twheel_node_t* sentinel, twheel_is_match_t is_match, void* params);
+
+twheel_t* TWheelCreate(uint64_t tick, uint64_t now)
+{
+    twheel_t* wheel = NULL;
+    size_t level = 0;
+    size_t slot = 0;
+
+    assert(0 < tick);
+
+    wheel = (twheel_t*)malloc(sizeof(twheel_t));
+    if (NULL == wheel)
+    {
+        return NULL;
+    }
+
+    for (level = 0; level < LEVELS; ++level)
+    {
+        for (slot = 0; slot < SLOTS; ++slot)
+        {
+            ListInit(&wheel->slots[level][slot]);
+        }
+        wheel->pending[level] = 0;
+    }
+
+    ListInit(&wheel->expired);
+    wheel->tick = tick;
+    wheel->now = now / tick;
+    wheel->size = 0;
+    wheel->blocks = NULL;
+    wheel->free_nodes = NULL;
+
+    return wheel;
+}
+
+void TWheelDestroy(twheel_t* wheel)
+{
+    node_block_t* block = NULL;
+
+    assert(NULL != wheel);
+
+    while (NULL != wheel->blocks)
+    {
+        block = wheel->blocks;
+        wheel->blocks = block->next;
+        free(block);
+    }
+
+    free(wheel);
+}
+
+twheel_node_t* TWheelInsert(twheel_t* wheel, void* data, uint64_t deadline)
+{
+    twheel_node_t* node = NULL;
+
+    assert(NULL != wheel);
+
+    node = AllocNode(wheel);
+    if (NULL == node)
+    {
+        return NULL;
+    }
+
+    node->data = data;
+    /* round up - an element never expires before its deadline */
+    node->expires = deadline / wheel->tick + (0 != deadline % wheel->tick);
+    Place(wheel, node);
+    ++wheel->size;
+
+    return node;
+}
+
+void* TWheelRemove(twheel_t* wheel, twheel_node_t* node)
+{
+    void* data = NULL;
+    twheel_node_t* next = NULL;
+
+    assert(NULL != wheel);
+    assert(NULL != node);
+
+    next = node->next;
+    data = node->data;
+    ListUnlink(node);
+
+    /* the slot became empty - sentinels are the only nodes inside the wheel struct */
+    if (next == next->next && next >= &wheel->slots[0][0] && next <= &wheel->slots[LEVELS - 1][SLOT_MASK])
+    {
+        size_t index = (size_t)(next - &wheel->slots[0][0]);
+        wheel->pending[index / SLOTS] &= ~((uint64_t)1 << (index % SLOTS));
+    }
+
+    FreeNode(wheel, node);
+    --wheel->size;
+
+    return data;
+}
+
+void* TWheelFind(twheel_t* wheel, twheel_is_match_t is_match, void* params)
+{
+    twheel_node_t* runner = NULL;
+    uint64_t bits = 0;
+    int level = 0;
+    int slot = 0;
+
+    assert(NULL != wheel);
+    assert(NULL != is_match);
+
+    for (runner = wheel->expired.next; runner != &wheel->expired; runner = runner->next)
+    {
+        if (is_match(runner->data, params))
+        {
+            return runner->data;
+        }
+    }
+
+    for (level = 0; level < LEVELS; ++level)
+    {
+        for (bits = wheel->pending[level]; 0 != bits; bits &= bits - 1)
+        {
+            twheel_node_t* sentinel = NULL;
+
+            slot = FirstSetBit(bits);
+            sentinel = &wheel->slots[level][slot];
+            for (runner = sentinel->next; runner != sentinel; runner = runner->next)
+            {
+                if (is_match(runner->data, params))
+                {
+                    return runner->data;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+size_t TWheelRemoveIf(twheel_t* wheel, twheel_is_match_t is_match, void* params)
+{
+    size_t removed = 0;
+    uint64_t bits = 0;
+    int level = 0;
+    int slot = 0;
+
+    assert(NULL != wheel);
+    assert(NULL != is_match);
+
+    removed += ListRemoveIf(wheel, &wheel->expired, is_match, params);
+    for (level = 0; level < LEVELS; ++level)
+    {
+        for (bits = wheel->pending[level]; 0 != bits; bits &= bits - 1)
+        {
+            slot = FirstSetBit(bits);
+            removed += ListRemoveIf(wheel, &wheel->slots[level][slot], is_match, params);
+            if (ListIsEmpty(&wheel->slots[level][slot]))
+            {
+                wheel->pending[level] &= ~((uint64_t)1 << slot);
+            }
+        }
+    }
+
+    wheel->size -= removed;
+
+    return removed;
+}
+
+void TWheelAdvance(twheel_t* wheel, uint64_t now)
+{
+    twheel_node_t cascade;
+    twheel_node_t* node = NULL;
+    uint64_t new_now = 0;
+    uint64_t bits = 0;
+    int level = 0;
+
+    assert(NULL != wheel);
+
+    new_now = now / wheel->tick;
+    if (new_now <= wheel->now)
+    {
+        return;
+    }
+
+    /* collect every slot the clock moved over, on every level it moved on */
+    ListInit(&cascade);
+    for (level = 0; level < LEVELS; ++level)
+    {
+        if ((new_now >> (level * LEVEL_BITS)) == (wheel->now >> (level * LEVEL_BITS)))
+        {
+            break;
+        }
+
+        bits = wheel->pending[level] & PassedSlots(wheel->now, new_now, level);
+        wheel->pending[level] &= ~bits;
+        for (; 0 != bits; bits &= bits - 1)
+        {
+            ListSplice(&cascade, &wheel->slots[level][FirstSetBit(bits)]);
+        }
+    }
+
+    /* re-place them relative to the new time - lower level or expired */
+    wheel->now = new_now;
+    while (!ListIsEmpty(&cascade))
+    {
+        node = cascade.next;
+        ListUnlink(node);
+        Place(wheel, node);
+    }
+}
+
+void* TWheelPopExpired(twheel_t* wheel)
+{
+    assert(NULL != wheel);
+
+    if (ListIsEmpty(&wheel->expired))
+    {
+        return NULL;
+    }
+
+    return TWheelRemove(wheel, wheel->expired.next);
+}
+
+void* TWheelPop(twheel_t* wheel)
+{
+    int level = 0;
+
+    assert(NULL != wheel);
+
+    if (!ListIsEmpty(&wheel->expired))
+    {
+        return TWheelRemove(wheel, wheel->expired.next);
+    }
+
+    for (level = 0; level < LEVELS; ++level)
+    {
+        if (0 != wheel->pending[level])
+        {
+            twheel_node_t* sentinel = &wheel->slots[level][FirstSetBit(wheel->pending[level])];
+            return TWheelRemove(wheel, sentinel->next);
+        }
+    }
+
+    return NULL;
+}
+
+uint64_t TWheelNextExpiry(const twheel_t* wheel)
+{
+    uint64_t base = 0;
+    uint64_t bits = 0;
+    uint64_t digit = 0;
+    int shift = 0;
+    int level = 0;
+
+    assert(NULL != wheel);
+
+    if (!ListIsEmpty(&wheel->expired))
+    {
+        return wheel->now * wheel->tick;
+    }
+
+    /* the lowest non-empty level holds the earliest slot */
+    for (level = 0; level < LEVELS; ++level)
+    {
+        if (0 == wheel->pending[level])
+        {
+            continue;
+        }
+
+        shift = level * LEVEL_BITS;
+        digit = (wheel->now >> shift) & SLOT_MASK;
+        base = (wheel->now >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+        bits = (SLOT_MASK == digit) ? 0 : wheel->pending[level] & (~(uint64_t)0 << (digit + 1));
+        if (0 == bits)
+        {
+            /* slot belongs to the next rotation of this level */
+            base += (uint64_t)1 << (shift + LEVEL_BITS);
+            bits = wheel->pending[level];
+        }
+
+        return (base | ((uint64_t)FirstSetBit(bits) << shift)) * wheel->tick;
+    }
+
+    return UINT64_MAX;
+}
+
+size_t TWheelSize(const twheel_t* wheel)
+{
+    assert(NULL != wheel);
+
+    return wheel->size;
+}
+
+int TWheelIsEmpty(const twheel_t* wheel)
+{
+    assert(NULL != wheel);
+
+    return 0 == wheel->size;
+}
+
+static void Place(twheel_t* wheel, twheel_node_t* node)
+{
+    uint64_t diff = 0;
+    int level = 0;
+    int slot = 0;
+
+    if (node->expires <= wheel->now)
+    {
+        ListPushBack(&wheel->expired, node);
+        return;
+    }
+
+    /* the highest bit that differs from now picks the level */
+    diff = node->expires ^ wheel->now;
+    level = LastSetBit(diff) / LEVEL_BITS;
+    if (level >= LEVELS)
+    {
+        /* beyond the wheel's range - park in the last slot, it cascades back in */
+        level = LEVELS - 1;
+        slot = (int)(((wheel->now >> (level * LEVEL_BITS)) + SLOT_MASK) & SLOT_MASK);
+    }
+    else
+    {
+        slot = (int)((node->expires >> (level * LEVEL_BITS)) & SLOT_MASK);
+    }
+
+    ListPushBack(&wheel->slots[level][slot], node);
+    wheel->pending[level] |= (uint64_t)1 << slot;
+}
+
+static uint64_t PassedSlots(uint64_t from, uint64_t to, int level)
+{
+    int shift = level * LEVEL_BITS;
+    uint64_t elapsed = (to >> shift) - (from >> shift);
+    int first = (int)(((from >> shift) + 1) & SLOT_MASK);
+    int last = (int)((to >> shift) & SLOT_MASK);
+
+    if (elapsed >= SLOTS)
+    {
+        return ~(uint64_t)0;
+    }
+
+    /* slots (first..last) inclusive, wrapping around the level */
+    if (first <= last)
+    {
+        return (~(uint64_t)0 >> (SLOT_MASK - last)) & (~(uint64_t)0 << first);
+    }
+
+    return (~(uint64_t)0 >> (SLOT_MASK - last)) | (~(uint64_t)0 << first);
+}
+
+static size_t ListRemoveIf(twheel_t* wheel, twheel_node_t* sentinel, twheel_is_match_t is_match, void* params)
+{
+    twheel_node_t* runner = sentinel->next;
+    size_t removed = 0;
+
+    while (runner != sentinel)
+    {
+        twheel_node_t* next = runner->next;
+
+        if (is_match(runner->data, params))
+        {
+            ListUnlink(runner);
+            FreeNode(wheel, runner);
+            ++removed;
+        }
+        runner = next;
+    }
+
+    return removed;
+}
+
+static twheel_node_t* AllocNode(twheel_t* wheel)
+{
+    twheel_node_t* node = NULL;
+
+    if (NULL == wheel->free_nodes)
+    {
+        node_block_t* block = (node_block_t*)malloc(sizeof(node_block_t));
+        size_t i = 0;
+
+        if (NULL == block)
+        {
+            return NULL;
+        }
+
+        block->next = wheel->blocks;
+        wheel->blocks = block;
+        for (i = 0; i < NODES_PER_BLOCK; ++i)
+        {
+            FreeNode(wheel, &block->nodes[i]);
+        }
+    }
+
+    node = wheel->free_nodes;
+    wheel->free_nodes = node->next;
+
+    return node;
+}
+
+static void FreeNode(twheel_t* wheel, twheel_node_t* node)
+{
+    node->next = wheel->free_nodes;
+    wheel->free_nodes = node;
+}
+
+static void ListInit(twheel_node_t* sentinel)
+{
+    sentinel->next = sentinel;
+    sentinel->prev = sentinel;
+}
+
+static int ListIsEmpty(const twheel_node_t* sentinel)
+{
+    return sentinel->next == sentinel;
+}
+
+static void ListPushBack(twheel_node_t* sentinel, twheel_node_t* node)
+{
+    node->prev = sentinel->prev;
+    node->next = sentinel;
+    sentinel->prev->next = node;
+    sentinel->prev = node;
+}
+
+static void ListUnlink(twheel_node_t* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+}
+
+static void ListSplice(twheel_node_t* to, twheel_node_t* from)
+{
+    if (ListIsEmpty(from))
+    {
+        return;
+    }
+
+    from->next->prev = to->prev;
+    to->prev->next = from->next;
+    from->prev->next = to;
+    to->prev = from->prev;
+    ListInit(from);
+}
+
+static int FirstSetBit(uint64_t bits)
+{
+    return __builtin_ctzll(bits);
+}
+
+static int LastSetBit(uint64_t bits)
+{
+    return 63 - __builtin_clzll(bits);
+}
@@ -3,80 +3,93 @@ Author: Roi Sasson
 Date: 19-12-2024
 Reviewer: Chen Sasson
 */
-#include <string.h> /* memcmp */
-#include <ifaddrs.h> /* ifaddr */
-#include <arpa/inet.h> /* inet_ntop */
+#include <string.h> /* strcmp */
+#include <ifaddrs.h> /* getifaddrs */
+#include <arpa/inet.h> /* ntohl */
 #include <unistd.h> /* getpid */
-#include <pthread.h> /* pthread_mutex */
+#include <time.h> /* time */
+#include <pthread.h> /* pthread_once, pthread_atfork */
+#include <stdatomic.h> /* atomic_fetch_add_explicit */
 
 #include "uid.h" /* API */
 
 #define LOCAL_NAME "lo"
+#define PID_BITS (32)
+#define PID_MASK ((((uint64_t)1) << PID_BITS) - 1)
+#define COUNTER_BITS (40)
+#define COUNTER_MASK ((((uint64_t)1) << COUNTER_BITS) - 1)
+#define BLOCK_SIZE (1024)
 
-typedef enum
-{
-	SUCCESS,
-	FAIL
-} status_t;
+/* resolved once per process, the pid and key time again in a forked child */
+static pthread_once_t identity_once = PTHREAD_ONCE_INIT;
+static uint64_t identity_high = 0;
+static uint64_t identity_low = 0;
+
+/* every thread takes counters from a block of its own, the shared counter moves once per block */
+static _Atomic(uint64_t) next_block = 0;
+static _Thread_local uint64_t block_next = 0;
+static _Thread_local uint64_t block_end = 0;
 
-static size_t counter_uid = 0;
-static pthread_mutex_t uid_mutex = PTHREAD_MUTEX_INITIALIZER;
-const UID_t BadUID = {0};
+const UID_t BadUID = {0, 0};
 
-static status_t GetIPAddress(unsigned char* ipBuffer, size_t bufferSize)
+static uint32_t GetIPAddress(void)
 {
 	struct ifaddrs* ifaddrs = NULL;
 	struct ifaddrs* runner = NULL;
+	uint32_t address = 0;
 
 	if (-1 == getifaddrs(&ifaddrs))
 	{
-		return FAIL;
+		return 0;
 	}
 	
-	runner = ifaddrs;
-	while (NULL != runner)
+	for (runner = ifaddrs; NULL != runner && 0 == address; runner = runner->ifa_next)
 	{
-		if (runner->ifa_addr->sa_family == AF_INET 
+		if (NULL != runner->ifa_addr && AF_INET == runner->ifa_addr->sa_family
 			&& 0 != strcmp((const char*)runner->ifa_name, LOCAL_NAME))
 		{
-			struct sockaddr_in* pAddr = (struct sockaddr_in*)runner->ifa_addr;
-			if (NULL != inet_ntop(AF_INET, &pAddr->sin_addr, (char*)ipBuffer, bufferSize))
-			{
-				break;
-			}
+			address = ntohl(((struct sockaddr_in*)runner->ifa_addr)->sin_addr.s_addr);
 		}
-		
-		runner = runner->ifa_next;
 	}
 
 	freeifaddrs(ifaddrs);
-	runner = NULL;
 	
-	return SUCCESS;
+	return address;
+}
+
+/* the host part is kept - a child only needs its own pid, its counters still go on from the parent's */
+static void RekeyProcess(void)
+{
+	identity_high = (identity_high & ~PID_MASK) | ((uint64_t)getpid() & PID_MASK);
+	identity_low = ((uint64_t)time(NULL) << COUNTER_BITS);
+}
+
+static void ResolveIdentity(void)
+{
+	identity_high = (uint64_t)GetIPAddress() << PID_BITS;
+	RekeyProcess();
+	pthread_atfork(NULL, NULL, RekeyProcess);
 }
 
 UID_t UIDCreate()
 {
-	UID_t uid = {0};
+	UID_t uid = {0, 0};
 
-	if (SUCCESS != GetIPAddress(uid.ip, sizeof(uid.ip)))
+	pthread_once(&identity_once, ResolveIdentity);
+	
+	if (block_next == block_end)
 	{
-		return BadUID;
+		block_next = atomic_fetch_add_explicit(&next_block, BLOCK_SIZE, memory_order_relaxed);
+		block_end = block_next + BLOCK_SIZE;
 	}
-	
-	pthread_mutex_lock(&uid_mutex);
-	uid.counter = counter_uid++;
-	uid.pid = getpid();
-	uid.time = time(NULL);
-	pthread_mutex_unlock(&uid_mutex);
+
+	uid.high = identity_high;
+	uid.low = identity_low | (block_next++ & COUNTER_MASK);
 
 	return uid;
 }
 
 int UIDIsEqual(UID_t uid1, UID_t uid2)
 {
-	return uid1.counter == uid2.counter &&
-		uid1.pid == uid2.pid &&
-		(0 == difftime(uid1.time, uid2.time)) &&
-		(0 == memcmp(&uid1, &uid2, sizeof(uid1)));
+	return 0 == ((uid1.high ^ uid2.high) | (uid1.low ^ uid2.low));
 }
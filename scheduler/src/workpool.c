@@ -0,0 +1,332 @@
+/*
+Author: Roi Sasson
+Date: 09-03-2025
+Reviewer:
+*/
+#include <stdlib.h>    /* malloc, realloc, free */
+#include <assert.h>    /* assert */
+#include <pthread.h>   /* pthread_create, pthread_mutex_t, pthread_cond_t */
+#include <stdatomic.h> /* atomic_long, atomic_int */
+
+#include "workpool.h" /* API */
+
+#define SUCCESS (0)
+#define FAIL (1)
+#define TRUE (1)
+#define FALSE (0)
+#define MIN_DEQUE_CAPACITY (64)
+#define GROWTH_FACTOR (2)
+
+/* ring buffer - jobs come in at the back in deadline order, the owner takes the
+   earliest from the front, thieves take from the back */
+typedef struct deque
+{
+    pthread_mutex_t lock;
+    void** jobs;
+    size_t capacity;
+    size_t front;
+    size_t count;
+} deque_t;
+
+typedef struct worker
+{
+    pthread_t thread;
+    workpool_t* pool;
+    size_t index;
+} worker_t;
+
+struct workpool
+{
+    deque_t* deques;
+    worker_t* workers;
+    size_t n_workers;
+    size_t next_worker;
+    workpool_run_t run;
+    void* context;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    atomic_long pending;   /* queued jobs nobody took yet */
+    atomic_int is_running;
+};
+
+static void* WorkerLoop(void* args);
+static void* TakeJob(workpool_t* pool, size_t index);
+static int DequeInit(deque_t* deque);
+static void DequeDestroy(deque_t* deque);
+static int DequePushBack(deque_t* deque, void* job);
+static void* DequePopBack(deque_t* deque);
+static void* DequePopFront(deque_t* deque);
+static void StopWorkers(workpool_t* pool, size_t started);
+
+workpool_t* WorkPoolCreate(size_t n_workers, workpool_run_t run, void* context)
+{
+    workpool_t* pool = NULL;
+    size_t i = 0;
+
+    assert(0 < n_workers);
+    assert(NULL != run);
+
+    pool = (workpool_t*)malloc(sizeof(workpool_t));
+    if (NULL == pool)
+    {
+        return NULL;
+    }
+
+    pool->deques = (deque_t*)malloc(n_workers * sizeof(deque_t));
+    pool->workers = (worker_t*)malloc(n_workers * sizeof(worker_t));
+    if (NULL == pool->deques || NULL == pool->workers)
+    {
+        free(pool->deques);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    for (i = 0; i < n_workers; ++i)
+    {
+        if (SUCCESS != DequeInit(&pool->deques[i]))
+        {
+            while (i > 0)
+            {
+                DequeDestroy(&pool->deques[--i]);
+            }
+            free(pool->deques);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+    }
+
+    pool->n_workers = n_workers;
+    pool->next_worker = 0;
+    pool->run = run;
+    pool->context = context;
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->is_running, TRUE);
+
+    for (i = 0; i < n_workers; ++i)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (0 != pthread_create(&pool->workers[i].thread, NULL, WorkerLoop, &pool->workers[i]))
+        {
+            StopWorkers(pool, i);
+            for (i = 0; i < n_workers; ++i)
+            {
+                DequeDestroy(&pool->deques[i]);
+            }
+            pthread_mutex_destroy(&pool->idle_lock);
+            pthread_cond_destroy(&pool->idle_cond);
+            free(pool->deques);
+            free(pool->workers);
+            free(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void WorkPoolDestroy(workpool_t* pool)
+{
+    size_t i = 0;
+
+    assert(NULL != pool);
+
+    StopWorkers(pool, pool->n_workers);
+
+    for (i = 0; i < pool->n_workers; ++i)
+    {
+        DequeDestroy(&pool->deques[i]);
+    }
+
+    pthread_mutex_destroy(&pool->idle_lock);
+    pthread_cond_destroy(&pool->idle_cond);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
+
+int WorkPoolSubmit(workpool_t* pool, void* job)
+{
+    deque_t* deque = NULL;
+
+    assert(NULL != pool);
+
+    deque = &pool->deques[pool->next_worker];
+    pool->next_worker = (pool->next_worker + 1) % pool->n_workers;
+
+    if (SUCCESS != DequePushBack(deque, job))
+    {
+        return FAIL;
+    }
+
+    /* counted under the idle lock - a worker can't miss the wakeup */
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_fetch_add(&pool->pending, 1);
+    pthread_cond_signal(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    return SUCCESS;
+}
+
+size_t WorkPoolSize(const workpool_t* pool)
+{
+    assert(NULL != pool);
+
+    return pool->n_workers;
+}
+
+static void* WorkerLoop(void* args)
+{
+    worker_t* worker = (worker_t*)args;
+    workpool_t* pool = worker->pool;
+    void* job = NULL;
+
+    while (TRUE)
+    {
+        job = TakeJob(pool, worker->index);
+        if (NULL != job)
+        {
+            atomic_fetch_sub(&pool->pending, 1);
+            pool->run(job, pool->context);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->idle_lock);
+        while (atomic_load(&pool->pending) <= 0 && atomic_load(&pool->is_running))
+        {
+            pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+        }
+        pthread_mutex_unlock(&pool->idle_lock);
+
+        if (!atomic_load(&pool->is_running) && atomic_load(&pool->pending) <= 0)
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void* TakeJob(workpool_t* pool, size_t index)
+{
+    void* job = DequePopFront(&pool->deques[index]);
+    size_t i = 0;
+
+    /* own deque is empty - steal the latest job of another worker, its owner keeps the earliest */
+    for (i = 1; NULL == job && i < pool->n_workers; ++i)
+    {
+        job = DequePopBack(&pool->deques[(index + i) % pool->n_workers]);
+    }
+
+    return job;
+}
+
+static void StopWorkers(workpool_t* pool, size_t started)
+{
+    size_t i = 0;
+
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_store(&pool->is_running, FALSE);
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (i = 0; i < started; ++i)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+static int DequeInit(deque_t* deque)
+{
+    deque->jobs = (void**)malloc(MIN_DEQUE_CAPACITY * sizeof(void*));
+    if (NULL == deque->jobs)
+    {
+        return FAIL;
+    }
+
+    deque->capacity = MIN_DEQUE_CAPACITY;
+    deque->front = 0;
+    deque->count = 0;
+    pthread_mutex_init(&deque->lock, NULL);
+
+    return SUCCESS;
+}
+
+static void DequeDestroy(deque_t* deque)
+{
+    pthread_mutex_destroy(&deque->lock);
+    free(deque->jobs);
+}
+
+static int DequePushBack(deque_t* deque, void* job)
+{
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity)
+    {
+        size_t new_capacity = deque->capacity * GROWTH_FACTOR;
+        void** jobs = (void**)realloc(deque->jobs, new_capacity * sizeof(void*));
+        size_t i = 0;
+
+        if (NULL == jobs)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return FAIL;
+        }
+
+        /* unwrap the ring into the new tail */
+        for (i = 0; i < deque->front; ++i)
+        {
+            jobs[deque->capacity + i] = jobs[i];
+        }
+
+        deque->jobs = jobs;
+        deque->capacity = new_capacity;
+    }
+
+    deque->jobs[(deque->front + deque->count) % deque->capacity] = job;
+    ++deque->count;
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return SUCCESS;
+}
+
+static void* DequePopBack(deque_t* deque)
+{
+    void* job = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (0 != deque->count)
+    {
+        --deque->count;
+        job = deque->jobs[(deque->front + deque->count) % deque->capacity];
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return job;
+}
+
+static void* DequePopFront(deque_t* deque)
+{
+    void* job = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (0 != deque->count)
+    {
+        job = deque->jobs[deque->front];
+        deque->front = (deque->front + 1) % deque->capacity;
+        --deque->count;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+
+    return job;
+}
@@ -1,4 +1,8 @@
 #include <stdio.h>
+#include <time.h> /* clock_gettime */
+#include <unistd.h> /* usleep */
+#include <pthread.h> /* pthread_create */
+#include <stdatomic.h> /* atomic_int */
 
 #include "scheduler.h"
 
@@ -48,6 +52,161 @@ static int MultplyBy2(void* x)
 	return 0; 
 }
 
+static int CountTo10(void* x)
+{
+	++*(int*)x;
+	
+	return *(int*)x < 10; 
+}
+
+static int order[8] = {0};
+static size_t order_index = 0;
+
+static int RecordOrder(void* x)
+{
+	order[order_index++] = *(int*)x;
+	
+	return 0; 
+}
+
+typedef struct poster
+{
+	scheduler_t* scheduler;
+	UID_t to_remove;
+	int id;
+} poster_t;
+
+static void* PostFromThread(void* args)
+{
+	poster_t* poster = (poster_t*)args;
+	
+	usleep(10000);
+	SchedulerPostTaskUs(poster->scheduler, RecordOrder, &poster->id, 1000, NULL, NULL);
+	SchedulerPostRemove(poster->scheduler, poster->to_remove);
+	SchedulerPostTaskUs(poster->scheduler, StopOp, poster->scheduler, 5000, NULL, NULL);
+	
+	return NULL;
+}
+
+static int SlowCountTo10(void* x)
+{
+	usleep(4000);
+	
+	return ++*(int*)x < 10; 
+}
+
+static int Forever(void* x)
+{
+	(void)x;
+	
+	return 1; 
+}
+
+static int CountTo2000(void* x)
+{
+	return ++*(int*)x < 2000; 
+}
+
+typedef struct stats_reader
+{
+	task_stats_record_t* record;
+	atomic_int is_running;
+	int is_consistent;
+	size_t snapshots;
+} stats_reader_t;
+
+/* every snapshot must be a whole number of runs - the histogram adds up to the run count */
+static void* ReadStats(void* args)
+{
+	stats_reader_t* reader = (stats_reader_t*)args;
+	task_stats_t snapshot = {0};
+	uint64_t histogram_runs = 0;
+	size_t i = 0;
+	
+	while (atomic_load(&reader->is_running))
+	{
+		TaskStatsSnapshot(reader->record, &snapshot);
+		for (histogram_runs = 0, i = 0; i < TASK_LATENESS_BUCKETS; ++i)
+		{
+			histogram_runs += snapshot.lateness[i];
+		}
+		reader->is_consistent &= (histogram_runs == snapshot.runs);
+		++reader->snapshots;
+	}
+	
+	return NULL;
+}
+
+typedef struct remover
+{
+	scheduler_t* scheduler;
+	UID_t victim;
+} remover_t;
+
+static int RemoveOp(void* args)
+{
+	remover_t* remover = (remover_t*)args;
+	
+	SchedulerRemove(remover->scheduler, remover->victim);
+	
+	return 0; 
+}
+
+typedef struct canceller
+{
+	scheduler_t* scheduler;
+	sched_handle_t handle;
+	int* cleanups;
+	int cleanups_in_run;
+} canceller_t;
+
+static int CancelSelfOp(void* args)
+{
+	canceller_t* canceller = (canceller_t*)args;
+	
+	SchedulerCancel(canceller->scheduler, canceller->handle);
+	canceller->cleanups_in_run = *canceller->cleanups;
+	
+	return 1; 
+}
+
+typedef struct slow_runner
+{
+	scheduler_t* scheduler;
+	UID_t self;
+	atomic_int runs;
+} slow_runner_t;
+
+static int SlowRun(void* x)
+{
+	slow_runner_t* runner = (slow_runner_t*)x;
+	
+	atomic_fetch_add(&runner->runs, 1);
+	usleep(20000);
+	
+	return 1; 
+}
+
+/* the remove comes while the task is in flight on a worker */
+static void* RemoveWhileRunning(void* args)
+{
+	slow_runner_t* runner = (slow_runner_t*)args;
+	
+	while (0 == atomic_load(&runner->runs))
+	{
+		usleep(100);
+	}
+	SchedulerPostRemove(runner->scheduler, runner->self);
+	SchedulerPostTaskUs(runner->scheduler, StopOp, runner->scheduler, 50000, NULL, NULL);
+	
+	return NULL;
+}
+
+static void CountCleanup(void* x)
+{
+	++*(int*)x;
+}
+
 static int Print(void* x)
 {
 	printf("%d\n", *(int*)x);
@@ -314,6 +473,593 @@ void SchedulerSizeTest()
 	SchedulerDestroy(scheduler);
 }
 
+void SchedulerAddTaskUsTest()
+{
+	const size_t count_tests = 2;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	struct timespec start = {0};
+	struct timespec end = {0};
+	double elapsed = 0;
+	int count = 0;
+	
+	printf("**SchedulerAddTaskUs test:**\n");
+	/* 10 runs, 10ms apart */
+	SchedulerAddTaskUs(scheduler, CountTo10, &count, 10000, NULL, NULL);
+	
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	SchedulerRun(scheduler);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	
+	if (10 != count)
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (elapsed < 0.1 || elapsed > 0.2)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerAddTaskUs: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerRemoveKeepsOrderTest()
+{
+	const size_t count_tests = 1;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	UID_t uids[6] = {0};
+	int ids[6] = {1, 2, 3, 4, 5, 6};
+	size_t i = 0;
+	
+	order_index = 0;
+	printf("**SchedulerRemoveKeepsOrder test:**\n");
+	for (i = 0; i < 6; ++i)
+	{
+		uids[i] = SchedulerAddTaskUs(scheduler, RecordOrder, &ids[i], 60000 - i * 10000, NULL, NULL);
+	}
+	
+	/* remove from the middle of the heap - the rest must still run by deadline */
+	SchedulerRemove(scheduler, uids[4]);
+	SchedulerRemove(scheduler, uids[1]);
+	SchedulerRun(scheduler);
+	
+	if (4 != order_index || 6 != order[0] || 4 != order[1] || 3 != order[2] || 1 != order[3])
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerRemoveKeepsOrder: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerWheelBackendTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_config_t config = {0};
+	scheduler_t* scheduler = NULL;
+	UID_t uid = {0};
+	int ids[4] = {1, 2, 3, 4};
+	
+	config.backend = SCHED_BACKEND_WHEEL;
+	scheduler = SchedulerCreateWithConfig(&config);
+	order_index = 0;
+	
+	printf("**SchedulerWheelBackend test:**\n");
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[2], 30000, NULL, NULL);
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[0], 10000, NULL, NULL);
+	uid = SchedulerAddTaskUs(scheduler, RecordOrder, &ids[3], 15000, NULL, NULL);
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[1], 20000, NULL, NULL);
+	
+	SchedulerRemove(scheduler, uid);
+	if (3 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	SchedulerRun(scheduler);
+	if (1 != order[0] || 2 != order[1] || 3 != order[2])
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerWheelBackend: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerPQueueBackendTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_config_t config = {0};
+	scheduler_t* scheduler = NULL;
+	UID_t uid = {0};
+	int ids[4] = {1, 2, 3, 4};
+	
+	config.backend = SCHED_BACKEND_PQUEUE;
+	scheduler = SchedulerCreateWithConfig(&config);
+	order_index = 0;
+	
+	printf("**SchedulerPQueueBackend test:**\n");
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[2], 30000, NULL, NULL);
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[0], 10000, NULL, NULL);
+	uid = SchedulerAddTaskUs(scheduler, RecordOrder, &ids[3], 15000, NULL, NULL);
+	SchedulerAddTaskUs(scheduler, RecordOrder, &ids[1], 20000, NULL, NULL);
+	
+	SchedulerRemove(scheduler, uid);
+	if (3 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	SchedulerRun(scheduler);
+	if (1 != order[0] || 2 != order[1] || 3 != order[2])
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerPQueueBackend: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerRunParallelTest()
+{
+	const size_t count_tests = 5;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	int counters[4] = {0};
+	size_t i = 0;
+	slow_runner_t runner = {0};
+	pthread_t thread;
+	
+	printf("**SchedulerRunParallel test:**\n");
+	for (i = 0; i < 4; ++i)
+	{
+		SchedulerAddTaskUs(scheduler, CountTo10, &counters[i], 1000, NULL, NULL);
+	}
+	
+	if (SUCCESSFULL_RUN != SchedulerRunParallel(scheduler, 2))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (10 != counters[0] || 10 != counters[1] || 10 != counters[2] || 10 != counters[3] ||
+		0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	counters[0] = -1000;
+	SchedulerAddTaskUs(scheduler, CountTo10, &counters[0], 1000, NULL, NULL);
+	SchedulerAddTaskUs(scheduler, StopOp, scheduler, 5000, NULL, NULL);
+	if (STOP != SchedulerRunParallel(scheduler, 2) || 1 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	SchedulerClear(scheduler);
+	runner.scheduler = scheduler;
+	runner.self = SchedulerAddTaskUs(scheduler, SlowRun, &runner, 1000, NULL, NULL);
+	pthread_create(&thread, NULL, RemoveWhileRunning, &runner);
+	if (STOP != SchedulerRunParallel(scheduler, 2))
+	{
+		printf("%sTest 4 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	pthread_join(thread, NULL);
+	
+	if (1 != atomic_load(&runner.runs) || 0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 5 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerRunParallel: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerPostTaskTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_config_t config = {0};
+	scheduler_t* scheduler = NULL;
+	poster_t poster = {0};
+	pthread_t thread;
+	struct timespec start = {0};
+	struct timespec end = {0};
+	double elapsed = 0;
+	
+	config.backend = SCHED_BACKEND_HEAP;
+	config.wait_when_empty = 1;
+	scheduler = SchedulerCreateWithConfig(&config);
+	order_index = 0;
+	poster.scheduler = scheduler;
+	poster.id = 7;
+	
+	printf("**SchedulerPostTask test:**\n");
+	/* the runner sleeps towards this deadline when the posts arrive */
+	poster.to_remove = SchedulerAddTask(scheduler, RecordOrder, &poster.id, 5, NULL, NULL);
+	
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&thread, NULL, PostFromThread, &poster);
+	if (STOP != SchedulerRun(scheduler))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	pthread_join(thread, NULL);
+	
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	if (elapsed > 1 || 1 != order_index || 7 != order[0])
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerPostTask: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerAddTasksTest()
+{
+	const size_t count_tests = 4;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	scheduler_task_desc_t tasks[8] = {0};
+	UID_t uids[8];
+	int ids[5] = {0, 1, 2, 3, 4};
+	int counters[8] = {0};
+	remover_t remover = {0};
+	size_t i = 0;
+	
+	printf("**SchedulerAddTasks test:**\n");
+	for (i = 0; i < 5; ++i)
+	{
+		tasks[i].operation = RecordOrder;
+		tasks[i].args = &ids[i];
+		tasks[i].interval_us = (5 - i) * 1000;
+	}
+	
+	order_index = 0;
+	if (0 != SchedulerAddTasks(scheduler, tasks, 5, uids) || 5 != SchedulerSize(scheduler) ||
+		UIDIsEqual(uids[0], uids[4]))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	SchedulerRun(scheduler);
+	if (5 != order_index || 4 != order[0] || 3 != order[1] || 2 != order[2] ||
+		1 != order[3] || 0 != order[4])
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* all due together - every batch runs them all before re-inserting */
+	for (i = 0; i < 8; ++i)
+	{
+		tasks[i].operation = CountTo10;
+		tasks[i].args = &counters[i];
+		tasks[i].interval_us = 1000;
+	}
+	
+	SchedulerAddTasks(scheduler, tasks, 8, NULL);
+	if (SUCCESSFULL_RUN != SchedulerRun(scheduler) || 0 != SchedulerSize(scheduler) ||
+		10 != counters[0] || 10 != counters[3] || 10 != counters[7])
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* the victim may already wait for re-insert when it is removed */
+	counters[0] = 0;
+	tasks[0].args = &counters[0];
+	tasks[1].operation = RemoveOp;
+	tasks[1].args = &remover;
+	remover.scheduler = scheduler;
+	SchedulerAddTasks(scheduler, tasks, 2, uids);
+	remover.victim = uids[0];
+	SchedulerRun(scheduler);
+	if (1 < counters[0] || 0 != SchedulerSize(scheduler))
+	{
+		printf("%sTest 4 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerAddTasks: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+static double TimeRun(scheduler_t* scheduler)
+{
+	struct timespec start = {0};
+	struct timespec end = {0};
+	
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	SchedulerRun(scheduler);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	
+	return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+void SchedulerFixedRateTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	scheduler_task_desc_t tasks[2] = {0};
+	task_lateness_t lateness = {0};
+	UID_t uids[2];
+	int counter = 0;
+	double fixed_delay = 0;
+	double fixed_rate = 0;
+	
+	printf("**SchedulerFixedRate test:**\n");
+	/* 10 runs of 4ms each 10ms - delay mode adds the run time to every period */
+	tasks[0].operation = SlowCountTo10;
+	tasks[0].args = &counter;
+	tasks[0].interval_us = 10000;
+	SchedulerAddTasks(scheduler, tasks, 1, NULL);
+	fixed_delay = TimeRun(scheduler);
+	
+	counter = 0;
+	tasks[0].mode = TASK_FIXED_RATE;
+	tasks[0].overrun = TASK_OVERRUN_SKIP;
+	SchedulerAddTasks(scheduler, tasks, 1, NULL);
+	fixed_rate = TimeRun(scheduler);
+	if (10 != counter || fixed_rate > fixed_delay - 0.02 || fixed_rate < 0.1)
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	tasks[0].operation = Forever;
+	tasks[1].operation = StopOp;
+	tasks[1].args = scheduler;
+	tasks[1].interval_us = 55000;
+	SchedulerAddTasks(scheduler, tasks, 2, uids);
+	SchedulerRun(scheduler);
+	if (0 != SchedulerGetLateness(scheduler, uids[0], &lateness) || 5 != lateness.runs ||
+		lateness.max < lateness.last || lateness.total < lateness.max)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (0 == SchedulerGetLateness(scheduler, uids[1], &lateness))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerFixedRate: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerTaskStatsTest()
+{
+	const size_t count_tests = 2;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_t* scheduler = SchedulerCreate();
+	scheduler_task_desc_t task = {0};
+	task_stats_record_t record;
+	task_stats_t snapshot = {0};
+	stats_reader_t reader = {0};
+	pthread_t thread;
+	int counter = 0;
+	
+	printf("**SchedulerTaskStats test:**\n");
+	TaskStatsInit(&record);
+	task.operation = CountTo2000;
+	task.args = &counter;
+	task.stats = &record;
+	SchedulerAddTasks(scheduler, &task, 1, NULL);
+	
+	reader.record = &record;
+	atomic_store(&reader.is_running, 1);
+	reader.is_consistent = 1;
+	pthread_create(&thread, NULL, ReadStats, &reader);
+	SchedulerRun(scheduler);
+	atomic_store(&reader.is_running, 0);
+	pthread_join(thread, NULL);
+	
+	TaskStatsSnapshot(&record, &snapshot);
+	if (2000 != snapshot.runs || 0 != snapshot.failures || 0 == snapshot.exec_total)
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (!reader.is_consistent)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerTaskStats: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	SchedulerDestroy(scheduler);
+}
+
+void SchedulerCancelTest()
+{
+	const size_t count_tests = 4;
+	size_t count_tests_success = count_tests;
+	
+	scheduler_config_t config = {0};
+	scheduler_t* scheduler = SchedulerCreate();
+	scheduler_task_desc_t task = {0};
+	sched_handle_t handles[300];
+	sched_handle_t stale = BadHandle;
+	canceller_t canceller = {0};
+	int counter = 0;
+	int cleanups = 0;
+	int backend = 0;
+	size_t i = 0;
+	
+	printf("**SchedulerCancel test:**\n");
+	task.operation = CountTo10;
+	task.args = &counter;
+	task.interval_us = 1000;
+	task.cleanup_op = CountCleanup;
+	task.cleanup_args = &cleanups;
+	handles[0] = SchedulerAddTaskHandle(scheduler, &task, NULL);
+	if (0 != SchedulerCancel(scheduler, handles[0]) || 0 != SchedulerSize(scheduler) || 1 != cleanups ||
+		0 == SchedulerCancel(scheduler, handles[0]) || 0 == SchedulerCancel(scheduler, BadHandle))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* the tombstone is dropped when due, without running or cleaning up again */
+	SchedulerAddTaskUs(scheduler, MultplyBy2, &counter, 3000, NULL, NULL);
+	SchedulerRun(scheduler);
+	if (0 != counter || 1 != cleanups || 0 == SchedulerCancel(scheduler, handles[0]))
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* cancelled while running - the cleanup waits for the end of the run */
+	cleanups = 0;
+	canceller.scheduler = scheduler;
+	canceller.cleanups = &cleanups;
+	task.operation = CancelSelfOp;
+	task.args = &canceller;
+	canceller.handle = SchedulerAddTaskHandle(scheduler, &task, NULL);
+	SchedulerRun(scheduler);
+	if (0 != canceller.cleanups_in_run || 1 != cleanups || !SchedulerIsEmpty(scheduler))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	SchedulerDestroy(scheduler);
+	
+	/* enough tombstones to purge the queue, none of them may run - Forever would never return */
+	for (backend = SCHED_BACKEND_HEAP; backend <= SCHED_BACKEND_PQUEUE; ++backend)
+	{
+		config.backend = (sched_backend_t)backend;
+		scheduler = SchedulerCreateWithConfig(&config);
+		cleanups = 0;
+		counter = 0;
+		for (i = 0; i < 300; ++i)
+		{
+			task.operation = (0 == i % 3) ? CountTo10 : Forever;
+			task.args = &counter;
+			task.interval_us = 1000 + i;
+			handles[i] = SchedulerAddTaskHandle(scheduler, &task, NULL);
+		}
+		for (i = 0; i < 300; ++i)
+		{
+			if (0 != i % 3)
+			{
+				SchedulerCancel(scheduler, handles[i]);
+			}
+		}
+		if (100 != SchedulerSize(scheduler) || 200 != cleanups || SUCCESSFULL_RUN != SchedulerRun(scheduler) ||
+			300 != cleanups)
+		{
+			printf("%sTest 4 failed!%s\n", red, reset);
+			--count_tests_success;
+		}
+		
+		/* slots are reused with a new generation, old handles stay dead */
+		stale = handles[0];
+		SchedulerClear(scheduler);
+		handles[0] = SchedulerAddTaskHandle(scheduler, &task, NULL);
+		if (0 == SchedulerCancel(scheduler, stale) || 0 != SchedulerCancel(scheduler, handles[0]))
+		{
+			printf("%sTest 4 failed!%s\n", red, reset);
+			--count_tests_success;
+		}
+		SchedulerDestroy(scheduler);
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of SchedulerCancel: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+}
+
 int main()
 {
 	SchedulerCreateTest();
@@ -323,6 +1069,16 @@ int main()
 	SchedulerRunTest();
 	SchedulerStopTest();
 	SchedulerSizeTest();
+	SchedulerAddTaskUsTest();
+	SchedulerRemoveKeepsOrderTest();
+	SchedulerWheelBackendTest();
+	SchedulerPQueueBackendTest();
+	SchedulerRunParallelTest();
+	SchedulerPostTaskTest();
+	SchedulerAddTasksTest();
+	SchedulerFixedRateTest();
+	SchedulerTaskStatsTest();
+	SchedulerCancelTest();
 	
 	return 0;
 }
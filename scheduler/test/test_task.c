@@ -9,6 +9,9 @@ static const char *red = "\033[31m";
 static const char *green = "\033[32m";
 static const char *reset = "\033[0m";
 
+#define NSEC_PER_SEC (1000000000ULL)
+#define TIME_SLACK_NS (100000000ULL)
+
 static int IsGreater(void* a)
 {
 	return *(int*)a;
@@ -28,8 +31,8 @@ void TaskCreateTest()
 	
 	size_t interval = 2;
 	
+	task_time_t timer = TaskTimeNow();
 	task_t* task = TaskCreate(IsGreater, NULL, interval, NULL, NULL);
-	time_t timer = time(NULL);
 	UID_t uid = {0};
 	
 	printf("**TaskCreate test:**\n");
@@ -40,13 +43,14 @@ void TaskCreateTest()
 		--count_tests_success;
 	}
 	
-	if (TaskGetTimeToRun(task) != timer + (time_t)interval)
+	if (TaskGetTimeToRun(task) < timer + interval * NSEC_PER_SEC ||
+		TaskGetTimeToRun(task) > timer + interval * NSEC_PER_SEC + TIME_SLACK_NS)
 	{
 		printf("%sTest 2 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
 	
-	if (task->interval != 2)
+	if (task->interval != 2 * NSEC_PER_SEC)
 	{
 		printf("%sTest 3 failed!%s\n", red, reset);
 		--count_tests_success;
@@ -144,13 +148,14 @@ void TaskTimeToRunTest()
 	task_t* task1 = NULL;
 	size_t interval1 = 2;
 	int num = 10;
-	time_t curr_time = 0;
+	task_time_t curr_time = 0;
 	
 	task1 = TaskCreate(MultplyBy2, &num, interval1, NULL, NULL);
 	printf("**TaskGetTimeToRun test:**\n");
 	
 	curr_time = TaskGetTimeToRun(task1);
-	if (curr_time != time(NULL) + (time_t)interval1)
+	if (curr_time > TaskTimeNow() + interval1 * NSEC_PER_SEC ||
+		curr_time + TIME_SLACK_NS < TaskTimeNow() + interval1 * NSEC_PER_SEC)
 	{
 		printf("%sTest 1 failed!%s\n", red, reset);
 		--count_get_tests_success;
@@ -165,7 +170,8 @@ void TaskTimeToRunTest()
 	sleep(1);
 	TaskUpdateTimeToRun(task1);
 	
-	if(curr_time + 1 != TaskGetTimeToRun(task1))
+	if (TaskGetTimeToRun(task1) < curr_time + NSEC_PER_SEC ||
+		TaskGetTimeToRun(task1) > curr_time + NSEC_PER_SEC + TIME_SLACK_NS)
 	{
 		printf("%sTest 2 failed!%s\n", red, reset);
 		--count_update_tests_success;
@@ -191,6 +197,209 @@ static void FreeWrapper(void* arg)
 	free(*((int**)arg));
 }
 
+void TaskCreateNsTest()
+{
+	const size_t count_tests = 2;
+	size_t count_tests_success = count_tests;
+	
+	task_time_t interval = 5000000; /* 5ms */
+	task_time_t timer = TaskTimeNow();
+	task_t* task = TaskCreateNs(IsGreater, NULL, interval, NULL, NULL);
+	
+	printf("**TaskCreateNs test:**\n");
+	if (task->interval != interval)
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (TaskGetTimeToRun(task) < timer + interval ||
+		TaskGetTimeToRun(task) > timer + interval + TIME_SLACK_NS)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of TaskCreateNs: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	TaskDestroy(task);
+}
+
+void TaskCreateFromSlabTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	slab_t* slab = SlabCreate(sizeof(task_t), 2);
+	task_t* task1 = TaskCreateFromSlab(slab, IsGreater, NULL, 1000, NULL, NULL);
+	task_t* task2 = TaskCreateFromSlab(slab, IsGreater, NULL, 1000, NULL, NULL);
+	task_t* task3 = NULL;
+	
+	printf("**TaskCreateFromSlab test:**\n");
+	if (NULL == task1 || NULL == task2 || 1 != SlabChunks(slab) || TaskIsMatch(task1, task2))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* destroyed tasks are handed out again before a new chunk is taken */
+	TaskDestroy(task1);
+	task3 = TaskCreateFromSlab(slab, IsGreater, NULL, 1000, NULL, NULL);
+	if (task3 != task1 || 1 != SlabChunks(slab))
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	TaskDestroy(task3);
+	task3 = TaskCreateFromSlab(slab, IsGreater, NULL, 1000, NULL, NULL);
+	task1 = TaskCreateFromSlab(slab, IsGreater, NULL, 1000, NULL, NULL);
+	if (2 != SlabChunks(slab))
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of TaskCreateFromSlab: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	TaskDestroy(task1);
+	TaskDestroy(task2);
+	TaskDestroy(task3);
+	SlabDestroy(slab);
+}
+
+void TaskFixedRateTest()
+{
+	const size_t count_tests = 4;
+	size_t count_tests_success = count_tests;
+	
+	const task_time_t interval = 10000000; /* 10ms */
+	task_t* task = TaskCreateNs(IsGreater, NULL, interval, NULL, NULL);
+	task_time_t first = TaskGetTimeToRun(task);
+	task_time_t now = 0;
+	int num = 0;
+	
+	printf("**TaskFixedRate test:**\n");
+	/* on time - exactly one period after the last deadline */
+	TaskSetMode(task, TASK_FIXED_RATE, TASK_OVERRUN_SKIP);
+	TaskUpdateTimeToRun(task);
+	if (first + interval != TaskGetTimeToRun(task))
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* three periods behind - next deadline in the future, still on the grid */
+	usleep(55000);
+	TaskUpdateTimeToRun(task);
+	now = TaskTimeNow();
+	if (TaskGetTimeToRun(task) <= now || TaskGetTimeToRun(task) > now + interval ||
+		0 != (TaskGetTimeToRun(task) - first) % interval || 0 == TaskGetLateness(task).skipped_periods)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* coalesce - the last missed deadline, due right away */
+	first = TaskGetTimeToRun(task);
+	TaskSetMode(task, TASK_FIXED_RATE, TASK_OVERRUN_COALESCE);
+	usleep(35000);
+	TaskUpdateTimeToRun(task);
+	now = TaskTimeNow();
+	if (TaskGetTimeToRun(task) > now || TaskGetTimeToRun(task) + interval <= now ||
+		0 != (TaskGetTimeToRun(task) - first) % interval)
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	/* catch up - every period runs, the run reports it started late */
+	first = TaskGetTimeToRun(task);
+	TaskSetMode(task, TASK_FIXED_RATE, TASK_OVERRUN_CATCH_UP);
+	usleep(25000);
+	TaskUpdateTimeToRun(task);
+	task->args = &num;
+	TaskRun(task);
+	if (first + interval != TaskGetTimeToRun(task) || TaskGetLateness(task).last < interval ||
+		1 != TaskGetLateness(task).runs)
+	{
+		printf("%sTest 4 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of TaskFixedRate: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	TaskDestroy(task);
+}
+
+static int FailOnThird(void* x)
+{
+	usleep(1000);
+	
+	return (3 == ++*(int*)x) ? -1 : 1;
+}
+
+void TaskStatsTest()
+{
+	const size_t count_tests = 3;
+	size_t count_tests_success = count_tests;
+	
+	task_stats_record_t record;
+	task_stats_t snapshot = {0};
+	int runs = 0;
+	task_t* task = TaskCreateNs(FailOnThird, &runs, 0, NULL, NULL);
+	size_t i = 0;
+	uint64_t histogram_runs = 0;
+	
+	printf("**TaskStats test:**\n");
+	TaskStatsInit(&record);
+	TaskRun(task);
+	TaskSetStats(task, &record);
+	TaskRun(task);
+	TaskRun(task);
+	TaskStatsSnapshot(&record, &snapshot);
+	
+	/* the run before the record was attached is not timed */
+	if (2 != snapshot.runs || 1 != snapshot.failures || 3 != TaskGetLateness(task).runs)
+	{
+		printf("%sTest 1 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (snapshot.exec_max < 1000000 || snapshot.exec_total < 2000000 || snapshot.exec_total < snapshot.exec_max)
+	{
+		printf("%sTest 2 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	for (i = 0; i < TASK_LATENESS_BUCKETS; ++i)
+	{
+		histogram_runs += snapshot.lateness[i];
+	}
+	
+	if (2 != histogram_runs)
+	{
+		printf("%sTest 3 failed!%s\n", red, reset);
+		--count_tests_success;
+	}
+	
+	if (count_tests_success == count_tests)
+	{
+		printf("%s%ld out of %ld tests of TaskStats: SUCCESS!%s\n", green, count_tests_success, count_tests, reset);
+	}
+	
+	TaskDestroy(task);
+}
+
 void CleanupTaskTest()
 {
 	int* arr = NULL;
@@ -210,6 +419,10 @@ int main()
 	TaskIsMatchTest();
 	TaskRunTest();
 	TaskTimeToRunTest();
+	TaskCreateNsTest();
+	TaskCreateFromSlabTest();
+	TaskFixedRateTest();
+	TaskStatsTest();
 	CleanupTaskTest();
 	
 	return 0;
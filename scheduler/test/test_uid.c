@@ -1,6 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h> /* qsort */
 #include <string.h>
-#include <unistd.h> /* getpid */
+#include <unistd.h> /* getpid, fork, pipe */
+#include <pthread.h> /* pthread_create */
+#include <sys/wait.h> /* waitpid */
 
 #include "uid.h"
 
@@ -8,45 +11,107 @@ static const char *red = "\033[31m";
 static const char *green = "\033[32m";
 static const char *reset = "\033[0m";
 
+#define THREADS (4)
+#define UIDS_PER_THREAD (5000)
+
+static void* CreateMany(void* args)
+{
+	UID_t* uids = (UID_t*)args;
+	size_t i = 0;
+	
+	for (i = 0; i < UIDS_PER_THREAD; ++i)
+	{
+		uids[i] = UIDCreate();
+	}
+	
+	return NULL;
+}
+
+static int CompareUIDs(const void* uid1, const void* uid2)
+{
+	const UID_t* first = (const UID_t*)uid1;
+	const UID_t* second = (const UID_t*)uid2;
+	
+	if (first->high != second->high)
+	{
+		return (first->high > second->high) - (first->high < second->high);
+	}
+	
+	return (first->low > second->low) - (first->low < second->low);
+}
+
 void UIDCreateTest()
 {
 	const size_t count_tests = 5;
 	size_t count_tests_success = count_tests;
 	
+	static UID_t uids[THREADS * UIDS_PER_THREAD];
+	pthread_t threads[THREADS];
 	UID_t uid1 = UIDCreate();
 	UID_t uid2 = UIDCreate();
-	time_t timer = time(NULL);
+	UID_t child_uid = {0, 0};
+	int fds[2] = {0};
+	pid_t pid = 0;
+	size_t i = 0;
 
 	printf("**UIDCreate test:**\n");
-	if (uid1.counter != 0)
+	if (UIDIsEqual(uid1, BadUID) || UIDIsEqual(uid1, uid2))
 	{
 		printf("%sTest 1 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
 	
-	if (uid1.counter == uid2.counter)
+	if (uid1.high != uid2.high || uid1.low + 1 != uid2.low)
 	{
 		printf("%sTest 2 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
 	
-	if (uid1.time != timer)
+	if ((uint32_t)uid1.high != (uint32_t)getpid())
 	{
 		printf("%sTest 3 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
 	
-	if (uid1.pid != getpid())
+	/* every thread counts from its own block - no two threads may hand out the same UID */
+	for (i = 0; i < THREADS; ++i)
+	{
+		pthread_create(&threads[i], NULL, CreateMany, &uids[i * UIDS_PER_THREAD]);
+	}
+	for (i = 0; i < THREADS; ++i)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	qsort(uids, THREADS * UIDS_PER_THREAD, sizeof(UID_t), CompareUIDs);
+	for (i = 1; i < THREADS * UIDS_PER_THREAD && !UIDIsEqual(uids[i - 1], uids[i]); ++i)
+	{
+	}
+	if (i != THREADS * UIDS_PER_THREAD)
 	{
 		printf("%sTest 4 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
 	
-	if (0 != memcmp(uid1.ip, "192.168.1.106", strlen("192.168.1.110") + 1))
+	/* a forked child goes on with the parent's counter, under its own pid */
+	if (0 != pipe(fds))
+	{
+		return;
+	}
+	pid = fork();
+	if (0 == pid)
+	{
+		child_uid = UIDCreate();
+		_exit(sizeof(child_uid) != write(fds[1], &child_uid, sizeof(child_uid)));
+	}
+	if (pid < 0 || sizeof(child_uid) != read(fds[0], &child_uid, sizeof(child_uid)) ||
+		(uint32_t)child_uid.high != (uint32_t)pid || UIDIsEqual(child_uid, UIDCreate()))
 	{
-		printf("%sTest 5 failed!\n%s", red, reset);
+		printf("%sTest 5 failed!%s\n", red, reset);
 		--count_tests_success;
 	}
+	waitpid(pid, NULL, 0);
+	close(fds[0]);
+	close(fds[1]);
 
 	if (count_tests_success == count_tests)
 	{
@@ -1,15 +1,18 @@
 #define _GNU_SOURCE
 #include <stdio.h>    /* printf, fprintf */
-#include <stdlib.h>   /* atoi */
-#include <unistd.h>   /* execvp */
+#include <stdlib.h>   /* atoi, atof, getenv, unsetenv */
+#include <unistd.h>   /* execvp, getppid, getpid */
 #include <signal.h>   /* sigaction, kill, SIGUSR1, SIGUSR2 */
 #include <pthread.h>  /* pthread_create, pthread_exit */
 
 #include "scheduler.h" /* scheduler API */
 #include "wd_common.h" /* shared objects API */
+#include "wd_log.h"    /* flight log API */
 
 static sem_t* wd_sem_local = NULL;
 static sem_t* user_sem_local = NULL;
+static scheduler_t* volatile scheduler_local = NULL; /* stopped by WDSigStopHandler */
+static volatile sig_atomic_t is_stop_requested = FALSE;
 
 void WDProcess(char** argv);
 void WDSigStopHandler(int sig);
@@ -24,19 +27,53 @@ int main(int argc, char** argv)
 void WDProcess(char** argv)
 {
     watchdog_data_t watchdog = {0};
+    char* phi_threshold = getenv(PHI_ENV);
     struct sigaction wd_stop = {0};
     struct sigaction wd = {0};
+    char* standby_fd = getenv(STANDBY_FD_ENV);
+    int activation_fd = (NULL != standby_fd) ? atoi(standby_fd) : -1;
+    run_status_t status = SUCCESSFULL_RUN;
+
+    /* the user process this watchdog may exec later is not a spare */
+    unsetenv(STANDBY_FD_ENV);
 
     /* setup watchdog data */
     watchdog.args = argv;
     watchdog.is_watchdog = TRUE;
     watchdog.interval = atoi(argv[1]);
     watchdog.tolerance = atoi(argv[2]);
+    watchdog.phi_threshold = (NULL != phi_threshold) ? atof(phi_threshold) : 0;
+    watchdog.kick_report_only = (NULL != getenv(KICK_REPORT_ENV));
+
+    /* the user process exports the heartbeat region only for the shared-memory transport */
+    if (NULL != getenv(HEARTBEAT_ENV))
+    {
+        if (SUCCESS != SetupHeartbeat(TRUE))
+        {
+            fprintf(stderr, "[Watchdog] Failed to attach heartbeat region\n");
+            return;
+        }
+    }
+    else
+    {
+        if (SUCCESS != SetupPingEvent())
+        {
+            fprintf(stderr, "[Watchdog] Failed to setup ping event\n");
+            return;
+        }
+
+        wd.sa_handler = HandleSignal;
+        sigaction(SIGUSR1, &wd, NULL);
+    }
 
-    /* setup signal handlers - signal handler and stopWD handler */
-    wd.sa_handler = HandleSignal;
+    /* counts into the page of the user process, if it has one */
+    SetupMetrics(TRUE);
+
+    /* and checks the threads it registers, if it has a kick table */
+    SetupKicks(TRUE);
+
+    /* stop requests are still signals - WDStop is not on the heartbeat path */
     wd_stop.sa_handler = WDSigStopHandler;
-    sigaction(SIGUSR1, &wd, NULL);
     sigaction(SIGUSR2, &wd_stop, NULL);
 
     if (0 != SetupSemaphores(&wd_sem_local, &user_sem_local, TRUE))
@@ -45,23 +82,60 @@ void WDProcess(char** argv)
         return;
     }
 
+    /* a spare sleeps here until the user process needs a new watchdog, or is gone */
+    if (-1 != activation_fd)
+    {
+        if (SUCCESS != ParkStandby(activation_fd))
+        {
+            return;
+        }
+        printf("[Watchdog] Standby activated (PID: %d)\n", getpid());
+    }
+
     /* the wd scheduler needs to wait for the user process scheduler */
     sem_post(user_sem_local);
     sem_wait(wd_sem_local);
 
+    /* opened once monitoring - a spare that is never activated leaves no log */
+    if (SUCCESS != SetupLog(TRUE))
+    {
+        printf("[Watchdog] No flight log, nothing is logged\n");
+    }
+
     watchdog.scheduler = SchedulerCreate();
     if (NULL == watchdog.scheduler)
     {
         CleanupResources(NULL, NULL, wd_sem_local, user_sem_local);
         return;
     }
+    scheduler_local = watchdog.scheduler;
 
     /* add monitoring tasks */
-    SchedulerAddTask(watchdog.scheduler, SendPingSignal, &watchdog, 1, NULL, NULL);
-    SchedulerAddTask(watchdog.scheduler, CheckPingResponse, &watchdog, 2, NULL, NULL);
+    AddMonitorTasks(&watchdog, 2);
+    if (SUCCESS != WatchPeer(&watchdog, getppid()))
+    {
+        printf("[Watchdog] No pidfd for the user process, exits are found by missed pings only\n");
+    }
+    WatchKicks(&watchdog);
+
+    /* a stop signal after the check is not lost for long - the stopped user sends no more pings */
+    status = is_stop_requested ? STOP : SchedulerRun(watchdog.scheduler);
+    scheduler_local = NULL;
+
+    /* WDStop - the user process goes on without a watchdog. It unlinks the
+       semaphores itself, a new pair may already use the names */
+    if (is_stop_requested)
+    {
+        CleanupResources(watchdog.scheduler, NULL, NULL, NULL);
+        sem_close(wd_sem_local);
+        sem_close(user_sem_local);
+        return;
+    }
 
-    if (STOP == SchedulerRun(watchdog.scheduler))
+    if (STOP == status)
     {
+        MarkRestartBegin(TRUE);
+        KillPeer();
         CleanupResources(watchdog.scheduler, NULL, wd_sem_local, user_sem_local);
         printf("[Watchdog] User process is unresponsive. Restarting user process...\n");
         execvp(USER_PROCESS, argv);
@@ -70,8 +144,13 @@ void WDProcess(char** argv)
 
 void WDSigStopHandler(int sig)
 {
-    (void)sig;
-    printf("[Watchdog] Received stop signal (SIGUSR2). Cleaning up resources...\n");
-    CleanupResources(NULL, NULL, wd_sem_local, user_sem_local);
-    raise(SIGKILL);
+    scheduler_t* scheduler = scheduler_local;
+
+    /* only async-signal-safe calls - WDProcess cleans up once SchedulerRun returns */
+    WD_LOG(LOG_INFO, LOG_STOP_SIGNAL, sig, 0);
+    is_stop_requested = TRUE;
+    if (NULL != scheduler)
+    {
+        SchedulerStop(scheduler);
+    }
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #define _GNU_SOURCE
 #include <stdio.h>     /* printf */
-#include <stdlib.h>    /* malloc, getenv, atoi, setenv */
+#include <stdlib.h>    /* malloc, getenv, atoi, atof, setenv, unsetenv */
 #include <string.h>    /* strdup */
 #include <assert.h>    /* assert */
 #include <unistd.h>    /* fork, execvp, getpid, getppid */
 #include <signal.h>    /* sigaction, kill, SIGUSR1, SIGUSR2 */
 #include <pthread.h>   /* pthread_create, pthread_exit */
+#include <stdatomic.h> /* atomic_int */
+#include <fcntl.h>     /* fcntl, F_SETFD */
+#include <sys/wait.h>  /* waitpid */
+#include <sys/socket.h> /* socketpair */
 
 #include "wd.h"        /* API definitions */
 #include "scheduler.h" /* scheduler API */
@@ -15,31 +19,124 @@ typedef struct
 {
     pthread_t monitor_thread;
     watchdog_data_t data;
+    wd_transport_t transport;
+    int warm_standby;
+    pid_t standby_pid; /* parked spare watchdog, 0 if none */
+    int standby_fd;    /* wakes the spare */
 } watchdog_process_t;
 
 static watchdog_process_t wd_g = {0}; /* global wd for cleanup func */
 static sem_t* wd_sem_g = NULL;
 static sem_t* user_sem_g = NULL;
+static atomic_int is_stopping_g = FALSE; /* set by WDStop - the watchdog is not revived */
+static __thread kick_slot_t* kick_slot_g = NULL; /* progress slot of the calling thread */
 
 static void* UserScheduler(void* args);
+static void* ClientScheduler(void* args);
+static int StopClient(void* args);
+static wd_status_t StartDaemonClient(void);
+static void SpawnStandby(watchdog_data_t* data);
+static pid_t TakeStandby(void);
+static void DropStandby(void);
 static char** GenerateArgs(int argc, char** argv, size_t interval, unsigned int tolerance);
 
 wd_status_t WDStart(int argc, const char* argv[], size_t interval, unsigned int tolerance)
+{
+    wd_config_t config = {0};
+
+    config.interval = interval;
+    config.tolerance = tolerance;
+    config.transport = (NULL != getenv(DAEMON_ENV)) ? WD_TRANSPORT_DAEMON : WD_TRANSPORT_SHM;
+    config.warm_standby = (NULL != getenv(STANDBY_ENV));
+    config.phi_threshold = (NULL != getenv(PHI_ENV)) ? atof(getenv(PHI_ENV)) : 0;
+    config.kick_report_only = (NULL != getenv(KICK_REPORT_ENV));
+
+    return WDStartWithConfig(argc, argv, &config);
+}
+
+wd_status_t WDStartWithConfig(int argc, const char* argv[], const wd_config_t* config)
 {
     pid_t pid;
     char buffer_g[BUFFER_LEN];
     struct sigaction user = {0};
 
     assert(NULL != argv);
+    assert(NULL != config);
 
     /* setup watchdog data */
-    wd_g.data.interval = interval;
-    wd_g.data.tolerance = tolerance;
-    wd_g.data.args = GenerateArgs(argc, (char**)argv, interval, tolerance);
+    wd_g.data.interval = config->interval;
+    wd_g.data.tolerance = config->tolerance;
+    wd_g.data.args = GenerateArgs(argc, (char**)argv, config->interval, config->tolerance);
     wd_g.data.is_watchdog = FALSE;
+    wd_g.data.phi_threshold = config->phi_threshold;
+    wd_g.data.kick_report_only = config->kick_report_only;
+    wd_g.transport = config->transport;
+    wd_g.warm_standby = config->warm_standby;
+    wd_g.standby_pid = 0;
+    wd_g.standby_fd = -1;
+    atomic_store(&is_stopping_g, FALSE);
+
+    if (WD_TRANSPORT_DAEMON == config->transport)
+    {
+        return StartDaemonClient();
+    }
+
+    /* the watchdog picks its transport by the presence of HEARTBEAT_ENV */
+    if (WD_TRANSPORT_SHM == config->transport)
+    {
+        if (SUCCESS != SetupHeartbeat(FALSE))
+        {
+            return HEARTBEAT_FAILED;
+        }
+    }
+    else
+    {
+        unsetenv(HEARTBEAT_ENV);
 
-    user.sa_handler = HandleSignal;
-    sigaction(SIGUSR1, &user, NULL);
+        if (SUCCESS != SetupPingEvent())
+        {
+            return PING_EVENT_FAILED;
+        }
+
+        user.sa_handler = HandleSignal;
+        sigaction(SIGUSR1, &user, NULL);
+    }
+
+    /* the watchdog and a restarted user process detect the same way */
+    if (0 < config->phi_threshold)
+    {
+        sprintf(buffer_g, "%g", config->phi_threshold);
+        setenv(PHI_ENV, buffer_g, TRUE);
+    }
+    else
+    {
+        unsetenv(PHI_ENV);
+    }
+
+    if (config->kick_report_only)
+    {
+        setenv(KICK_REPORT_ENV, "1", TRUE);
+    }
+    else
+    {
+        unsetenv(KICK_REPORT_ENV);
+    }
+
+    /* optional - the pair runs the same without a metrics page */
+    if (SUCCESS != SetupMetrics(FALSE))
+    {
+        printf("[User] No metrics page, nothing is counted\n");
+    }
+
+    if (SUCCESS != SetupLog(FALSE))
+    {
+        printf("[User] No flight log, nothing is logged\n");
+    }
+
+    if (SUCCESS != SetupKicks(FALSE))
+    {
+        printf("[User] No kick table, threads are not checked\n");
+    }
 
     if (0 != SetupSemaphores(&wd_sem_g, &user_sem_g, FALSE))
     {
@@ -70,6 +167,17 @@ wd_status_t WDStart(int argc, const char* argv[], size_t interval, unsigned int
         sem_post(wd_sem_g);
         sem_wait(user_sem_g);
 
+        /* this process may be the restart of a watchdog that found its user dead */
+        MarkRestartDone(TRUE);
+
+        /* created here - WDStop may come before the thread runs */
+        wd_g.data.scheduler = SchedulerCreate();
+        if (NULL == wd_g.data.scheduler)
+        {
+            CleanupResources(NULL, wd_g.data.args, wd_sem_g, user_sem_g);
+            return SCHEDULER_FAILED;
+        }
+
         /* create thread for monitoring */
         if (0 != pthread_create(&wd_g.monitor_thread, NULL, UserScheduler, &wd_g.data))
         {
@@ -86,10 +194,52 @@ void WDStop()
     pid_t pid = 0;
     char* pid_str = getenv(PID_ENV);
 
-    CleanupResources(wd_g.data.scheduler, wd_g.data.args, wd_sem_g, user_sem_g);
-    pthread_detach(wd_g.monitor_thread);
+    /* the daemon only sees the slot released, nobody is signalled */
+    if (WD_TRANSPORT_DAEMON == wd_g.transport)
+    {
+        /* SchedulerRun clears a stop set before it - a posted one is applied once it runs */
+        atomic_store(&is_stopping_g, TRUE);
+        SchedulerPostTask(wd_g.data.scheduler, StopClient, wd_g.data.scheduler, 0, NULL, NULL);
+        SchedulerStop(wd_g.data.scheduler);
+        pthread_join(wd_g.monitor_thread, NULL);
+        CleanupResources(wd_g.data.scheduler, wd_g.data.args, NULL, NULL);
+        return;
+    }
+
+    /* the monitor thread sees the watchdog exit and leaves instead of reviving it */
+    atomic_store(&is_stopping_g, TRUE);
     pid = atoi(pid_str);
     kill(pid, SIGUSR2);
+    SchedulerStop(wd_g.data.scheduler);
+    pthread_join(wd_g.monitor_thread, NULL);
+    DropStandby();
+
+    CleanupResources(wd_g.data.scheduler, wd_g.data.args, wd_sem_g, user_sem_g);
+}
+
+int WDRegisterThread(const char* name, size_t deadline_ms)
+{
+    WDUnregisterThread();
+    kick_slot_g = TakeKickSlot(name, deadline_ms);
+
+    return (NULL != kick_slot_g) ? SUCCESS : FAIL;
+}
+
+void WDKick(void)
+{
+    if (NULL != kick_slot_g)
+    {
+        Kick(kick_slot_g);
+    }
+}
+
+void WDUnregisterThread(void)
+{
+    if (NULL != kick_slot_g)
+    {
+        KickRelease(kick_slot_g);
+        kick_slot_g = NULL;
+    }
 }
 
 static void* UserScheduler(void* args)
@@ -97,22 +247,37 @@ static void* UserScheduler(void* args)
     watchdog_data_t* data = (watchdog_data_t*)args;
     pid_t pid;
     char buffer_g[BUFFER_LEN];
-    
-    data->scheduler = SchedulerCreate();
-    if (NULL == data->scheduler)
+
+    /* Add tasks for monitoring */
+    AddMonitorTasks(data, 3);
+    if (SUCCESS != WatchPeer(data, atoi(getenv(PID_ENV))))
     {
-        CleanupResources(NULL, data->args, wd_sem_g, user_sem_g);
-        return NULL;
+        printf("[User] No pidfd for the watchdog, exits are found by missed pings only\n");
     }
 
-    /* Add tasks for monitoring */
-    SchedulerAddTask(data->scheduler, SendPingSignal, data, 1, NULL, NULL);
-    SchedulerAddTask(data->scheduler, CheckPingResponse, data, 3, NULL, NULL);
+    if (wd_g.warm_standby)
+    {
+        SpawnStandby(data);
+    }
 
     /* While wd is dead - revive wd */
-    while (STOP == SchedulerRun(data->scheduler))
+    while (!atomic_load(&is_stopping_g) && STOP == SchedulerRun(data->scheduler) &&
+           !atomic_load(&is_stopping_g))
     {
-        pid = fork();
+        MarkRestartBegin(FALSE);
+
+        /* a hung watchdog is replaced too - and a dead one must not stay a zombie */
+        pid = atoi(getenv(PID_ENV));
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+
+        /* a spare already went through exec and setup, it only has to be woken */
+        pid = TakeStandby();
+        if (0 == pid)
+        {
+            pid = fork();
+        }
+
         if (pid < 0)
         {
             return NULL;
@@ -132,8 +297,15 @@ static void* UserScheduler(void* args)
             sem_wait(user_sem_g);
 
             SchedulerClear(data->scheduler);
-            SchedulerAddTask(data->scheduler, SendPingSignal, data, 1, NULL, NULL);
-            SchedulerAddTask(data->scheduler, CheckPingResponse, data, 2, NULL, NULL);
+            AddMonitorTasks(data, 2);
+            WatchPeer(data, pid);
+            MarkRestartDone(FALSE);
+
+            /* the next spare starts while the new watchdog is already monitoring */
+            if (wd_g.warm_standby)
+            {
+                SpawnStandby(data);
+            }
         }
     }
 
@@ -141,6 +313,126 @@ static void* UserScheduler(void* args)
     return args;
 }
 
+static wd_status_t StartDaemonClient(void)
+{
+    if (SUCCESS != SetupDaemonClient(wd_g.data.interval, wd_g.data.tolerance))
+    {
+        CleanupResources(NULL, wd_g.data.args, NULL, NULL);
+        return DAEMON_ATTACH_FAILED;
+    }
+
+    /* created here - WDStop may come before the thread runs */
+    wd_g.data.scheduler = SchedulerCreate();
+    if (NULL == wd_g.data.scheduler || SUCCESS != AddPingTask(&wd_g.data))
+    {
+        CleanupResources(wd_g.data.scheduler, wd_g.data.args, NULL, NULL);
+        return SCHEDULER_FAILED;
+    }
+
+    if (0 != pthread_create(&wd_g.monitor_thread, NULL, ClientScheduler, &wd_g.data))
+    {
+        CleanupResources(wd_g.data.scheduler, wd_g.data.args, NULL, NULL);
+        return THREAD_CREATION_FAILED;
+    }
+
+    return SUCCESS;
+}
+
+/* forks a spare watchdog - it sets up and parks until TakeStandby */
+static void SpawnStandby(watchdog_data_t* data)
+{
+    int fds[2] = {-1, -1};
+    char fd_str[MAX_PID_DIGITS];
+    pid_t pid = 0;
+
+    if (0 != socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+    {
+        return;
+    }
+
+    sprintf(fd_str, "%d", fds[1]);
+    setenv(STANDBY_FD_ENV, fd_str, TRUE);
+
+    pid = fork();
+    if (0 == pid)
+    {
+        /* the spare's end is the only one left open after exec */
+        fcntl(fds[1], F_SETFD, 0);
+        execvp(WD_PROCESS, data->args);
+
+        /* found dead when activated, the revive falls back to fork */
+        raise(SIGKILL);
+    }
+
+    unsetenv(STANDBY_FD_ENV);
+    close(fds[1]);
+
+    if (pid < 0)
+    {
+        close(fds[0]);
+        return;
+    }
+
+    wd_g.standby_pid = pid;
+    wd_g.standby_fd = fds[0];
+}
+
+/* pid of the woken spare, 0 if there was none or it died while parked */
+static pid_t TakeStandby(void)
+{
+    pid_t pid = wd_g.standby_pid;
+
+    if (0 == pid)
+    {
+        return 0;
+    }
+
+    if (SUCCESS != ActivateStandby(wd_g.standby_fd))
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        pid = 0;
+    }
+
+    close(wd_g.standby_fd);
+    wd_g.standby_fd = -1;
+    wd_g.standby_pid = 0;
+
+    return pid;
+}
+
+static void DropStandby(void)
+{
+    if (0 != wd_g.standby_pid)
+    {
+        kill(wd_g.standby_pid, SIGKILL);
+        waitpid(wd_g.standby_pid, NULL, 0);
+        close(wd_g.standby_fd);
+        wd_g.standby_fd = -1;
+        wd_g.standby_pid = 0;
+    }
+}
+
+/* pings the daemon until WDStop */
+static void* ClientScheduler(void* args)
+{
+    watchdog_data_t* data = (watchdog_data_t*)args;
+
+    if (!atomic_load(&is_stopping_g))
+    {
+        SchedulerRun(data->scheduler);
+    }
+
+    return NULL;
+}
+
+static int StopClient(void* args)
+{
+    SchedulerStop((scheduler_t*)args);
+
+    return SUCCESS;
+}
+
 static char** GenerateArgs(int argc, char** argv, size_t interval, unsigned int tolerance)
 {
     char** returned_args = (char**)malloc((argc + 4) * sizeof(char*));
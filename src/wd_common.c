@@ -1,28 +1,95 @@
 #define _GNU_SOURCE
-#include <stdio.h>     /* printf */
-#include <stdlib.h>    /* getenv, atoi */
-#include <string.h>    /* strcpy */
+#include <stdio.h>     /* printf, sprintf */
+#include <stdlib.h>    /* getenv, setenv, atoi */
+#include <string.h>    /* strcpy, strlen */
 #include <signal.h>    /* kill, SIGUSR1 */
 #include <fcntl.h>     /* O_CREAT */
+#include <errno.h>     /* errno */
+#include <unistd.h>    /* write, close */
+#include <poll.h>      /* ppoll */
 #include <sys/stat.h>  /* S_IRUSR, S_IWUSR */
-#include <time.h>      /* time */
+#include <sys/eventfd.h> /* eventfd */
+#include <time.h>      /* clock_gettime */
+#include <stdint.h>    /* uint32_t */
+#include <pthread.h>   /* pthread_create, pthread_join, pthread_sigmask */
+#include <stdatomic.h> /* atomic_int */
+#include <sys/syscall.h> /* SYS_pidfd_open */
+#include <sys/socket.h> /* send, MSG_NOSIGNAL */
+#include <sys/mman.h>   /* shm_unlink */
 
-#include "wd_common.h" /* shared objects API */
+#include "wd_common.h"    /* shared objects API */
+#include "wd_heartbeat.h" /* shared-memory heartbeat API */
+#include "wd_table.h"     /* watchdog daemon table API */
+#include "wd_metrics.h"   /* metrics page API */
+#include "wd_log.h"       /* flight log API */
+#include "wd_phi.h"       /* phi-accrual detector API */
 
-#define WATCHDOG "Watchdog"
-#define USER "User"
+#define NSEC_PER_SEC (1000000000L)
+#define NSEC_PER_MSEC (1000000L)
+#define USEC_PER_SEC (1000000UL)
+#define PING_INTERVAL (1)
+#define HEARTBEAT_NAME "/wd_heartbeat_%d" /* pid of the user process */
+#define METRICS_NAME "/wd_metrics_%d"     /* pid of the first user process */
+#define KICKS_NAME "/wd_kicks_%d"         /* pid of the first user process */
+#define KICK_PERIOD_MS (100)              /* kick slots are sampled this often */
 
-atomic_int signal_flag = FALSE;
+static int ping_event_fd = -1; /* written by HandleSignal, drained by WaitForPing */
+static heartbeat_t* heartbeat = NULL; /* NULL - pings are SIGUSR1 signals */
+static char heartbeat_name[BUFFER_LEN];
+static uint32_t seen_beats = 0; /* peer beats already counted as a ping */
+static table_t* daemon_table = NULL; /* not NULL - a daemon watches this process */
+static int daemon_slot = TABLE_NO_SLOT;
+static uint32_t daemon_generation = 0;
+static int peer_pidfd = -1;      /* readable once the watched peer exited */
+static int watcher_stop_fd = -1;
+static pthread_t peer_watcher;
+static watchdog_data_t* watched_data = NULL; /* not NULL while peer_watcher runs */
+static atomic_int is_peer_dead = FALSE;
+static atomic_int is_peer_stalled = FALSE; /* a thread of the peer made no progress */
+static metrics_t* metrics = NULL; /* NULL - nothing is counted */
+static char metrics_name[BUFFER_LEN];
+static int is_metrics_owner = FALSE; /* the user process unlinks the page on cleanup */
+static phi_detector_t phi;        /* beats of the current peer */
+static int is_phi_ready = FALSE;  /* FALSE - a new peer, modelled from scratch on the next check */
+static kick_table_t* kick_table = NULL; /* NULL - threads of the user are not checked */
+static char kick_name[BUFFER_LEN];
+static int is_kick_owner = FALSE;
+static int kick_stop_fd = -1;
+static pthread_t kick_watcher;
+static watchdog_data_t* kicked_data = NULL; /* not NULL while kick_watcher runs */
+
+static int WaitForPing(size_t interval, int is_watchdog);
+static int CheckPhi(watchdog_data_t* data);
+static void* PeerWatcher(void* args);
+static void StopWatchingPeer(void);
+static void* KickWatcher(void* args);
+static void StopWatchingKicks(void);
+static void ReportStall(watchdog_data_t* data, const kick_state_t* state, uint64_t silence_ns);
+static void WakeCheck(watchdog_data_t* data);
+static void FillPingTask(scheduler_task_desc_t* task, watchdog_data_t* data);
+static void Count(const watchdog_data_t* data, metrics_counter_t counter);
+static void CountPing(const watchdog_data_t* data);
+static uint64_t NowNs(void);
 
 int SendPingSignal(void* args)
 {
     pid_t target_pid;
     watchdog_data_t* data = (watchdog_data_t*)args;
-    char process_name[BUFFER_LEN];
-    char target_str[BUFFER_LEN];
 
-    strcpy(process_name, data->is_watchdog ? WATCHDOG : USER);
-    strcpy(target_str, process_name);
+    if (NULL != daemon_table)
+    {
+        TableBeat(daemon_table, daemon_slot);
+        return CONTINUE;
+    }
+
+    Count(data, METRICS_PINGS_SENT);
+
+    if (NULL != heartbeat)
+    {
+        WD_LOG(LOG_DEBUG, LOG_HEARTBEAT_SENT, 0, 0);
+        HeartbeatBeat(heartbeat, data->is_watchdog ? HEARTBEAT_WATCHDOG : HEARTBEAT_USER);
+        return CONTINUE;
+    }
 
     if (data->is_watchdog) 
     {
@@ -34,8 +101,7 @@ int SendPingSignal(void* args)
         target_pid = atoi(pid_str);
     }
 
-    printf("[%s] Sending ping signal to %s (PID: %d)\n",
-           process_name, target_str, target_pid);
+    WD_LOG(LOG_DEBUG, LOG_PING_SENT, target_pid, 0);
 
     kill(target_pid, SIGUSR1); /* send signal to the other process */
     return CONTINUE;
@@ -44,42 +110,50 @@ int SendPingSignal(void* args)
 int CheckPingResponse(void* args)
 {
     watchdog_data_t* data = (watchdog_data_t*)args;
-    time_t start = time(NULL);
-    time_t updated_time = 0;
     int tolerance = data->tolerance;
-    char process_name[BUFFER_LEN];
-    char target_str[BUFFER_LEN];
 
-    strcpy(process_name, data->is_watchdog ? WATCHDOG : USER);
-    strcpy(target_str, process_name);
+    /* beat times are only known with the shared-memory heartbeat */
+    if (0 < data->phi_threshold && NULL != heartbeat)
+    {
+        return CheckPhi(data);
+    }
 
-    printf("[%s] Starting ping response check (Interval: %lu, Tolerance: %d)\n",
-           process_name, data->interval, tolerance);
+    WD_LOG(LOG_DEBUG, LOG_CHECK_STARTED, (int64_t)data->interval, tolerance);
 
-    /* while tolerance did not exceeded - check if got signal in time */
-    do
+    /* while tolerance did not exceeded - sleep until a ping arrives or the window ends */
+    while (tolerance > 0)
     {
-        updated_time = time(NULL);
-        /* if got signal - break and continue code */
-        if (signal_flag == TRUE)
+        int is_pinged = WaitForPing(data->interval, data->is_watchdog);
+
+        /* checked first - the watchers wake this wait with a fake ping */
+        if (atomic_load(&is_peer_dead))
+        {
+            WD_LOG(LOG_ERROR, LOG_PEER_EXITED, 0, 0);
+            tolerance = 0;
+            break;
+        }
+
+        if (atomic_load(&is_peer_stalled))
         {
-            atomic_store(&signal_flag, FALSE);
-            printf("[%s] Received ping response from %s\n", process_name, target_str);
+            tolerance = 0;
             break;
         }
-        /* if didn't get signal in time - try again */
-        else if (difftime(updated_time, start) >= (double)data->interval)
+
+        if (TRUE == is_pinged)
         {
-            atomic_fetch_sub(&tolerance, 1);
-            start = time(NULL);
-            printf("[%s] No response from %s. Remaining tolerance: %d\n", 
-                   process_name, target_str, tolerance);
+            WD_LOG(LOG_DEBUG, LOG_PING_RECEIVED, 0, 0);
+            CountPing(data);
+            break;
         }
-    } while (tolerance > 0);
+
+        Count(data, METRICS_MISSED_WINDOWS);
+        --tolerance;
+        WD_LOG(LOG_WARN, LOG_WINDOW_MISSED, tolerance, 0);
+    }
 
     if (tolerance <= 0)
     {
-        printf("[%s] %s is unresponsive. Stopping scheduler...\n", process_name, target_str);
+        WD_LOG(LOG_ERROR, LOG_PEER_UNRESPONSIVE, 0, 0);
         SchedulerStop(data->scheduler);
         return SUCCESS;
     }
@@ -87,10 +161,39 @@ int CheckPingResponse(void* args)
     return CONTINUE;
 }
 
+/* pings keep a fixed rate - the response check blocks the scheduler, late pings are skipped, not bunched */
+int AddMonitorTasks(watchdog_data_t* data, size_t check_interval)
+{
+    scheduler_task_desc_t tasks[2] = {0};
+
+    is_phi_ready = FALSE;
+    FillPingTask(&tasks[0], data);
+
+    tasks[1].operation = CheckPingResponse;
+    tasks[1].args = data;
+    tasks[1].interval_us = check_interval * USEC_PER_SEC;
+
+    return SchedulerAddTasks(data->scheduler, tasks, 2, NULL);
+}
+
+/* a daemon client only pings, the daemon does the checking */
+int AddPingTask(watchdog_data_t* data)
+{
+    scheduler_task_desc_t task = {0};
+
+    FillPingTask(&task, data);
+
+    return SchedulerAddTasks(data->scheduler, &task, 1, NULL);
+}
+
 void CleanupResources(scheduler_t* scheduler, char** argv, sem_t* wd_sem, sem_t* user_sem)
 {
     size_t i = 0;
 
+    /* first - the watchers stop the scheduler when the peer exits or stalls */
+    StopWatchingPeer();
+    StopWatchingKicks();
+
     if (NULL != scheduler)
     {
         SchedulerDestroy(scheduler);
@@ -119,12 +222,369 @@ void CleanupResources(scheduler_t* scheduler, char** argv, sem_t* wd_sem, sem_t*
         sem_unlink(USER_SEM);
         sem_destroy(user_sem);
     }
+
+    if (-1 != ping_event_fd)
+    {
+        close(ping_event_fd);
+        ping_event_fd = -1;
+    }
+
+    if (NULL != heartbeat)
+    {
+        HeartbeatClose(heartbeat, heartbeat_name);
+        heartbeat = NULL;
+    }
+
+    if (NULL != daemon_table)
+    {
+        TableRelease(daemon_table, daemon_slot, daemon_generation);
+        TableClose(daemon_table, NULL);
+        daemon_table = NULL;
+    }
+
+    if (NULL != metrics)
+    {
+        MetricsClose(metrics, is_metrics_owner ? metrics_name : NULL);
+        metrics = NULL;
+    }
+
+    /* threads of the user process may kick on - its table stays mapped, only the name goes */
+    if (NULL != kick_table)
+    {
+        if (is_kick_owner)
+        {
+            shm_unlink(kick_name);
+        }
+        else
+        {
+            KickClose(kick_table, NULL);
+        }
+        kick_table = NULL;
+    }
 }
 
 void HandleSignal(int sig)
 {
+    int saved_errno = errno;
+    eventfd_t one = 1;
+
     (void)sig;
-    atomic_store(&signal_flag, TRUE);
+    if (-1 != ping_event_fd)
+    {
+        /* write is async-signal-safe - wakes up the thread blocked in WaitForPing */
+        ssize_t written = write(ping_event_fd, &one, sizeof(one));
+        (void)written;
+    }
+
+    errno = saved_errno;
+}
+
+int SetupPingEvent(void)
+{
+    if (-1 == ping_event_fd)
+    {
+        ping_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    }
+
+    return (-1 == ping_event_fd) ? FAIL : SUCCESS;
+}
+
+/* the user process owns the region and hands its name to the watchdog in the environment */
+int SetupHeartbeat(int is_watchdog)
+{
+    char* name = NULL;
+
+    if (NULL != heartbeat)
+    {
+        return SUCCESS;
+    }
+
+    if (is_watchdog)
+    {
+        name = getenv(HEARTBEAT_ENV);
+        if (NULL == name || strlen(name) >= BUFFER_LEN)
+        {
+            return FAIL;
+        }
+        strcpy(heartbeat_name, name);
+    }
+    else
+    {
+        sprintf(heartbeat_name, HEARTBEAT_NAME, getpid());
+    }
+
+    heartbeat = HeartbeatOpen(heartbeat_name, !is_watchdog);
+    if (NULL == heartbeat)
+    {
+        return FAIL;
+    }
+
+    if (!is_watchdog && 0 != setenv(HEARTBEAT_ENV, heartbeat_name, TRUE))
+    {
+        HeartbeatClose(heartbeat, heartbeat_name);
+        heartbeat = NULL;
+        return FAIL;
+    }
+
+    return SUCCESS;
+}
+
+/* the user process names the page (WD_METRICS_ENV if already set) and hands
+   it down in the environment - restarted processes count on in the same page */
+int SetupMetrics(int is_watchdog)
+{
+    char* name = getenv(METRICS_ENV);
+
+    if (NULL != metrics)
+    {
+        return SUCCESS;
+    }
+
+    if (NULL != name && strlen(name) < BUFFER_LEN)
+    {
+        strcpy(metrics_name, name);
+    }
+    else if (is_watchdog)
+    {
+        return FAIL;
+    }
+    else
+    {
+        sprintf(metrics_name, METRICS_NAME, getpid());
+    }
+
+    metrics = MetricsOpen(metrics_name, TRUE);
+    if (NULL == metrics)
+    {
+        return FAIL;
+    }
+
+    if (!is_watchdog && 0 != setenv(METRICS_ENV, metrics_name, TRUE))
+    {
+        MetricsClose(metrics, NULL);
+        metrics = NULL;
+        return FAIL;
+    }
+    is_metrics_owner = !is_watchdog;
+
+    return SUCCESS;
+}
+
+/* the peer of this side failed, it is being started again */
+void MarkRestartBegin(int is_watchdog)
+{
+    if (NULL != metrics)
+    {
+        MetricsRestartBegin(metrics, is_watchdog ? METRICS_WATCHDOG : METRICS_USER);
+    }
+}
+
+/* the restarted peer monitors - a restart by the watchdog ends in the user process it started */
+void MarkRestartDone(int is_watchdog)
+{
+    if (NULL != metrics)
+    {
+        MetricsRestartDone(metrics, is_watchdog ? METRICS_WATCHDOG : METRICS_USER);
+    }
+}
+
+/* nothing is logged unless LOG_ENV names a file prefix - every process of the
+   pair then writes its own file, read back by wd_logdump.out */
+int SetupLog(int is_watchdog)
+{
+    char* prefix = getenv(LOG_ENV);
+    char* level = getenv(LOG_LEVEL_ENV);
+
+    if (NULL == prefix)
+    {
+        return SUCCESS;
+    }
+
+    return LogOpen(prefix, is_watchdog, (NULL == level) ? LOG_DEBUG : (log_level_t)atoi(level));
+}
+
+/* the user process creates the table, named by KICKS_ENV if already set, and
+   hands the name down - a restarted user reuses it with an empty table */
+int SetupKicks(int is_watchdog)
+{
+    char* name = getenv(KICKS_ENV);
+
+    if (NULL != kick_table)
+    {
+        return SUCCESS;
+    }
+
+    if (NULL != name && strlen(name) < BUFFER_LEN)
+    {
+        strcpy(kick_name, name);
+    }
+    else if (is_watchdog)
+    {
+        return FAIL;
+    }
+    else
+    {
+        sprintf(kick_name, KICKS_NAME, getpid());
+    }
+
+    kick_table = KickOpen(kick_name, !is_watchdog);
+    if (NULL == kick_table)
+    {
+        return FAIL;
+    }
+
+    if (!is_watchdog && 0 != setenv(KICKS_ENV, kick_name, TRUE))
+    {
+        KickClose(kick_table, kick_name);
+        kick_table = NULL;
+        return FAIL;
+    }
+    is_kick_owner = !is_watchdog;
+
+    return SUCCESS;
+}
+
+/* a slot for the calling thread of the user process, NULL without a table or a free slot */
+kick_slot_t* TakeKickSlot(const char* name, size_t deadline_ms)
+{
+    if (NULL == kick_table || 0 == deadline_ms)
+    {
+        return NULL;
+    }
+
+    return KickClaim(kick_table, name, (uint64_t)deadline_ms * NSEC_PER_MSEC);
+}
+
+/* a thread of the watchdog samples the kick slots of the user's threads every
+   KICK_PERIOD_MS, apart from the scheduler - a blocking ping check never delays it */
+int WatchKicks(watchdog_data_t* data)
+{
+    sigset_t all;
+    sigset_t old;
+    int status = 0;
+
+    StopWatchingKicks();
+    atomic_store(&is_peer_stalled, FALSE);
+
+    kick_stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (NULL == kick_table || -1 == kick_stop_fd)
+    {
+        StopWatchingKicks();
+        return FAIL;
+    }
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    status = pthread_create(&kick_watcher, NULL, KickWatcher, data);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (0 != status)
+    {
+        StopWatchingKicks();
+        return FAIL;
+    }
+
+    kicked_data = data;
+
+    return SUCCESS;
+}
+
+/* the peer found failed is killed before it is replaced - a hung or stalled
+   process must not run on next to the new one. Through the pidfd, so never
+   a recycled pid */
+int KillPeer(void)
+{
+    if (-1 == peer_pidfd)
+    {
+        return FAIL;
+    }
+
+    return (0 == syscall(SYS_pidfd_send_signal, peer_pidfd, SIGKILL, NULL, 0)) ? SUCCESS : FAIL;
+}
+
+/* claims a slot in the table of the daemon named by DAEMON_ENV (DAEMON_TABLE if unset) */
+int SetupDaemonClient(size_t interval, unsigned int tolerance)
+{
+    char* name = getenv(DAEMON_ENV);
+
+    if (NULL != daemon_table)
+    {
+        return SUCCESS;
+    }
+
+    daemon_table = TableOpen((NULL == name || '\0' == *name) ? DAEMON_TABLE : name, FALSE);
+    if (NULL == daemon_table)
+    {
+        return FAIL;
+    }
+
+    daemon_slot = TableClaim(daemon_table, getpid(), (uint64_t)interval * NSEC_PER_SEC, tolerance, &daemon_generation);
+    if (TABLE_NO_SLOT == daemon_slot)
+    {
+        TableClose(daemon_table, NULL);
+        daemon_table = NULL;
+        return FAIL;
+    }
+
+    return SUCCESS;
+}
+
+/* a thread blocks on a pidfd of pid - the exit of the peer stops data's
+   scheduler at once, not after tolerance missed windows */
+int WatchPeer(watchdog_data_t* data, pid_t pid)
+{
+    sigset_t all;
+    sigset_t old;
+    int status = 0;
+
+    StopWatchingPeer();
+    atomic_store(&is_peer_dead, FALSE);
+
+    peer_pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+    watcher_stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (-1 == peer_pidfd || -1 == watcher_stop_fd)
+    {
+        StopWatchingPeer();
+        return FAIL;
+    }
+
+    /* the watcher never takes the ping and stop signals */
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    status = pthread_create(&peer_watcher, NULL, PeerWatcher, data);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (0 != status)
+    {
+        StopWatchingPeer();
+        return FAIL;
+    }
+
+    watched_data = data;
+
+    return SUCCESS;
+}
+
+/* a spare watchdog sleeps here, already set up. SUCCESS once activated,
+   FAIL when the user process is gone and the socket is closed */
+int ParkStandby(int fd)
+{
+    char command = 0;
+    ssize_t bytes = 0;
+
+    while ((bytes = read(fd, &command, sizeof(command))) < 0 && EINTR == errno)
+    {
+    }
+    close(fd);
+
+    return (sizeof(command) == bytes) ? SUCCESS : FAIL;
+}
+
+/* wakes the spare parked on the other end of fd. FAIL if the spare died */
+int ActivateStandby(int fd)
+{
+    char command = TRUE;
+
+    /* a dead spare is an EPIPE, not a SIGPIPE for the user process */
+    return (sizeof(command) == send(fd, &command, sizeof(command), MSG_NOSIGNAL)) ? SUCCESS : FAIL;
 }
 
 int SetupSemaphores(sem_t** wd_sem, sem_t** user_sem, int is_watchdog)
@@ -151,4 +611,280 @@ int SetupSemaphores(sem_t** wd_sem, sem_t** user_sem, int is_watchdog)
     }
 
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/* blocks (no CPU) until a ping arrives or interval seconds pass on the monotonic clock */
+static int WaitForPing(size_t interval, int is_watchdog)
+{
+    struct pollfd event = {0};
+    struct timespec now = {0};
+    struct timespec deadline = {0};
+    struct timespec remaining = {0};
+    eventfd_t pings = 0;
+
+    if (NULL != heartbeat)
+    {
+        /* the watchdog waits for the user's beats and the other way around */
+        return HeartbeatWait(heartbeat, is_watchdog ? HEARTBEAT_USER : HEARTBEAT_WATCHDOG, &seen_beats, interval)
+               ? TRUE : FALSE;
+    }
+
+    event.fd = ping_event_fd;
+    event.events = POLLIN;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)interval;
+
+    while (TRUE)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+        remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+        if (remaining.tv_nsec < 0)
+        {
+            remaining.tv_nsec += NSEC_PER_SEC;
+            --remaining.tv_sec;
+        }
+
+        if (remaining.tv_sec < 0)
+        {
+            return FALSE;
+        }
+
+        /* EINTR is expected - the ping signal itself may land on this thread */
+        if (ppoll(&event, 1, &remaining, NULL) > 0 && 0 == eventfd_read(ping_event_fd, &pings))
+        {
+            return TRUE;
+        }
+    }
+}
+
+static void* PeerWatcher(void* args)
+{
+    watchdog_data_t* data = (watchdog_data_t*)args;
+    struct pollfd events[2] = {{0}};
+
+    events[0].fd = peer_pidfd;
+    events[0].events = POLLIN;
+    events[1].fd = watcher_stop_fd;
+    events[1].events = POLLIN;
+
+    while (poll(events, 2, -1) < 0)
+    {
+    }
+
+    if (0 != (events[0].revents & POLLIN))
+    {
+        atomic_store(&is_peer_dead, TRUE);
+        SchedulerStop(data->scheduler);
+        WakeCheck(data);
+    }
+
+    return NULL;
+}
+
+static void StopWatchingPeer(void)
+{
+    if (NULL != watched_data)
+    {
+        eventfd_write(watcher_stop_fd, 1);
+        pthread_join(peer_watcher, NULL);
+        watched_data = NULL;
+    }
+
+    if (-1 != peer_pidfd)
+    {
+        close(peer_pidfd);
+        peer_pidfd = -1;
+    }
+
+    if (-1 != watcher_stop_fd)
+    {
+        close(watcher_stop_fd);
+        watcher_stop_fd = -1;
+    }
+}
+
+/* one wait per check: for the next beat, or until phi of the silence crosses the threshold */
+static int CheckPhi(watchdog_data_t* data)
+{
+    heartbeat_side_t peer = data->is_watchdog ? HEARTBEAT_USER : HEARTBEAT_WATCHDOG;
+    uint32_t before = seen_beats;
+    int is_pinged = FALSE;
+
+    if (!is_phi_ready)
+    {
+        PhiInit(&phi, PING_INTERVAL * NSEC_PER_SEC, NowNs());
+        is_phi_ready = TRUE;
+    }
+
+    is_pinged = HeartbeatWaitUntil(heartbeat, peer, &seen_beats, PhiSuspectAt(&phi, data->phi_threshold));
+
+    /* checked first - the watchers wake this wait with a fake ping */
+    if (atomic_load(&is_peer_dead))
+    {
+        WD_LOG(LOG_ERROR, LOG_PEER_EXITED, 0, 0);
+        SchedulerStop(data->scheduler);
+        return SUCCESS;
+    }
+
+    if (atomic_load(&is_peer_stalled))
+    {
+        SchedulerStop(data->scheduler);
+        return SUCCESS;
+    }
+
+    if (is_pinged)
+    {
+        PhiArrival(&phi, HeartbeatLastNs(heartbeat, peer), seen_beats - before);
+        WD_LOG(LOG_DEBUG, LOG_PING_RECEIVED, 0, 0);
+        CountPing(data);
+        return CONTINUE;
+    }
+
+    Count(data, METRICS_MISSED_WINDOWS);
+    WD_LOG(LOG_ERROR, LOG_PEER_SUSPECTED, (int64_t)((NowNs() - phi.last_ns) / NSEC_PER_MSEC),
+           (int64_t)(data->phi_threshold * 1000));
+    SchedulerStop(data->scheduler);
+
+    return SUCCESS;
+}
+
+static void FillPingTask(scheduler_task_desc_t* task, watchdog_data_t* data)
+{
+    task->operation = SendPingSignal;
+    task->args = data;
+    task->interval_us = PING_INTERVAL * USEC_PER_SEC;
+    task->mode = TASK_FIXED_RATE;
+    task->overrun = TASK_OVERRUN_SKIP;
+}
+
+static void Count(const watchdog_data_t* data, metrics_counter_t counter)
+{
+    if (NULL != metrics)
+    {
+        MetricsAdd(metrics, data->is_watchdog ? METRICS_WATCHDOG : METRICS_USER, counter, 1);
+    }
+}
+
+static void CountPing(const watchdog_data_t* data)
+{
+    uint64_t beat_ns = 0;
+
+    Count(data, METRICS_PINGS_RECEIVED);
+
+    /* both processes stamp beats with the same monotonic clock */
+    if (NULL != metrics && NULL != heartbeat)
+    {
+        beat_ns = HeartbeatLastNs(heartbeat, data->is_watchdog ? HEARTBEAT_USER : HEARTBEAT_WATCHDOG);
+        MetricsObserveLatency(metrics, data->is_watchdog ? METRICS_WATCHDOG : METRICS_USER, NowNs() - beat_ns);
+    }
+}
+
+/* last seen state of a kick slot */
+typedef struct kick_seen
+{
+    uint64_t generation; /* 0 - the slot was free */
+    uint64_t kicks;
+    uint64_t changed_ns;
+    int is_reported;
+} kick_seen_t;
+
+static void* KickWatcher(void* args)
+{
+    watchdog_data_t* data = (watchdog_data_t*)args;
+    kick_seen_t seen[KICK_SLOTS] = {{0}};
+    kick_state_t state = {0};
+    struct pollfd stop = {0};
+    uint64_t now = 0;
+    int i = 0;
+
+    stop.fd = kick_stop_fd;
+    stop.events = POLLIN;
+
+    while (poll(&stop, 1, KICK_PERIOD_MS) <= 0)
+    {
+        now = NowNs();
+        for (i = 0; i < KICK_SLOTS; ++i)
+        {
+            if (!KickScan(kick_table, i, &state))
+            {
+                seen[i].generation = 0;
+                continue;
+            }
+
+            /* a new owner of the slot, or a kick since the last look */
+            if (state.generation != seen[i].generation || state.kicks != seen[i].kicks)
+            {
+                seen[i].generation = state.generation;
+                seen[i].kicks = state.kicks;
+                seen[i].changed_ns = now;
+                seen[i].is_reported = FALSE;
+                continue;
+            }
+
+            if (!seen[i].is_reported && now - seen[i].changed_ns > state.deadline_ns)
+            {
+                seen[i].is_reported = TRUE;
+                ReportStall(data, &state, now - seen[i].changed_ns);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void StopWatchingKicks(void)
+{
+    if (NULL != kicked_data)
+    {
+        eventfd_write(kick_stop_fd, 1);
+        pthread_join(kick_watcher, NULL);
+        kicked_data = NULL;
+    }
+
+    if (-1 != kick_stop_fd)
+    {
+        close(kick_stop_fd);
+        kick_stop_fd = -1;
+    }
+}
+
+static void ReportStall(watchdog_data_t* data, const kick_state_t* state, uint64_t silence_ns)
+{
+    printf("[Watchdog] Thread %s (TID: %d) made no progress for %lu ms\n", state->name, state->tid,
+           silence_ns / NSEC_PER_MSEC);
+    WD_LOG(LOG_ERROR, LOG_THREAD_STALLED, state->tid, (int64_t)(silence_ns / NSEC_PER_MSEC));
+    Count(data, METRICS_THREAD_STALLS);
+
+    if (!data->kick_report_only)
+    {
+        atomic_store(&is_peer_stalled, TRUE);
+        SchedulerStop(data->scheduler);
+        WakeCheck(data);
+    }
+}
+
+/* wakes a running CheckPingResponse like a ping would - set is_peer_dead or
+   is_peer_stalled before, the check looks at them ahead of the ping and does
+   not count it. The scheduler it runs on is already stopped */
+static void WakeCheck(watchdog_data_t* data)
+{
+    if (NULL != heartbeat)
+    {
+        HeartbeatWake(heartbeat, data->is_watchdog ? HEARTBEAT_USER : HEARTBEAT_WATCHDOG);
+    }
+    else if (-1 != ping_event_fd)
+    {
+        eventfd_write(ping_event_fd, 1);
+    }
+}
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
@@ -0,0 +1,336 @@
+#define _GNU_SOURCE
+#include <stdio.h>     /* printf, fprintf, sprintf */
+#include <stdlib.h>    /* malloc, realloc, free, getenv */
+#include <string.h>    /* strdup, strlen */
+#include <signal.h>    /* sigaction, signal, kill, SIGKILL, SIGTERM */
+#include <unistd.h>    /* fork, chdir, execvpe, read, readlink */
+#include <fcntl.h>     /* open, O_RDONLY */
+#include <limits.h>    /* PATH_MAX */
+
+#include "scheduler.h" /* scheduler API */
+#include "wd_common.h" /* shared objects API */
+#include "wd_table.h"  /* heartbeat table API */
+
+#define DISCOVERY_INTERVAL_US (100000)
+#define NSEC_PER_USEC (1000)
+#define PROC_PATH_LEN (64)
+#define READ_CHUNK (4096)
+#define WORD_BITS (64)
+#define EXEC_FAILED_STATUS (127)
+
+/* everything needed to start a client again after it is gone from /proc */
+typedef struct client
+{
+    int slot;
+    table_client_t registration;
+    uint32_t seen_beats;
+    unsigned int misses;
+    char* cmdline; /* NUL separated, as in /proc/<pid>/cmdline */
+    size_t cmdline_len;
+    char* env;
+    size_t env_len;
+    char* cwd;
+} client_t;
+
+static table_t* table = NULL;
+static scheduler_t* scheduler = NULL;
+static client_t clients[TABLE_CAPACITY];
+static uint64_t watched[TABLE_WORDS]; /* slots that have a check task */
+static volatile sig_atomic_t is_stopping = FALSE;
+
+static int DiscoverClients(void* args);
+static int CheckClient(void* args);
+static void ForgetClient(void* args);
+static void WatchClient(int slot);
+static void ReviveClient(client_t* client);
+static char* ReadProcFile(pid_t pid, const char* file, size_t* length);
+static char** SplitNulls(char* buffer, size_t length);
+static void HandleStop(int sig);
+
+int main(int argc, char** argv)
+{
+    const char* name = (argc > 1) ? argv[1] : getenv(DAEMON_ENV);
+    scheduler_config_t config = {0};
+    struct sigaction stop = {0};
+
+    if (NULL == name)
+    {
+        name = DAEMON_TABLE;
+    }
+
+    /* revived clients are not waited for */
+    signal(SIGCHLD, SIG_IGN);
+    stop.sa_handler = HandleStop;
+    sigaction(SIGTERM, &stop, NULL);
+    sigaction(SIGINT, &stop, NULL);
+
+    table = TableOpen(name, TRUE);
+    if (NULL == table)
+    {
+        fprintf(stderr, "[Daemon] Failed to create heartbeat table %s\n", name);
+        return 1;
+    }
+
+    /* one check task per client, the wheel keeps inserts and expiries O(1) */
+    config.backend = SCHED_BACKEND_WHEEL;
+    scheduler = SchedulerCreateWithConfig(&config);
+    if (NULL == scheduler)
+    {
+        TableClose(table, name);
+        return 1;
+    }
+
+    SchedulerAddTaskUs(scheduler, DiscoverClients, NULL, DISCOVERY_INTERVAL_US, NULL, NULL);
+
+    printf("[Daemon] Supervising clients of %s (PID: %d)\n", name, getpid());
+    SchedulerRun(scheduler);
+    printf("[Daemon] Stopping...\n");
+
+    SchedulerDestroy(scheduler);
+    TableClose(table, name);
+
+    return 0;
+}
+
+/* new claims show up as bits that are set in the table but not in watched */
+static int DiscoverClients(void* args)
+{
+    uint64_t fresh = 0;
+    size_t word = 0;
+
+    (void)args;
+    if (is_stopping)
+    {
+        SchedulerStop(scheduler);
+        return CONTINUE;
+    }
+
+    for (word = 0; word < TABLE_WORDS; ++word)
+    {
+        fresh = TableClaimedWord(table, word) & ~watched[word];
+        while (0 != fresh)
+        {
+            WatchClient((int)(word * WORD_BITS + __builtin_ctzll(fresh)));
+            fresh &= fresh - 1;
+        }
+    }
+
+    return CONTINUE;
+}
+
+static void WatchClient(int slot)
+{
+    client_t* client = &clients[slot];
+    scheduler_task_desc_t task = {0};
+    char path[PROC_PATH_LEN];
+    char cwd[PATH_MAX];
+    ssize_t length = 0;
+
+    /* still filling in its registration - picked up on the next scan */
+    if (0 != TableGetClient(table, slot, &client->registration))
+    {
+        return;
+    }
+
+    client->slot = slot;
+    client->seen_beats = TableBeats(table, slot);
+    client->misses = 0;
+
+    /* a hung client still has its /proc entry, a killed one does not */
+    client->cmdline = ReadProcFile(client->registration.pid, "cmdline", &client->cmdline_len);
+    client->env = ReadProcFile(client->registration.pid, "environ", &client->env_len);
+    sprintf(path, "/proc/%d/cwd", client->registration.pid);
+    length = readlink(path, cwd, sizeof(cwd) - 1);
+    client->cwd = NULL;
+    if (length > 0)
+    {
+        cwd[length] = '\0';
+        client->cwd = strdup(cwd);
+    }
+
+    task.operation = CheckClient;
+    task.args = client;
+    task.interval_us = client->registration.interval_ns / NSEC_PER_USEC;
+    task.cleanup_op = ForgetClient;
+    task.cleanup_args = client;
+
+    /* ForgetClient may already have run as the cleanup, it can run twice */
+    if (BadHandle.slot == SchedulerAddTaskHandle(scheduler, &task, NULL).slot)
+    {
+        ForgetClient(client);
+        return;
+    }
+
+    watched[slot / WORD_BITS] |= (uint64_t)1 << (slot % WORD_BITS);
+    printf("[Daemon] Watching client (PID: %d, slot: %d)\n", client->registration.pid, slot);
+}
+
+static int CheckClient(void* args)
+{
+    client_t* client = (client_t*)args;
+    table_client_t current = {0};
+    uint32_t beats = 0;
+
+    /* released, or released and claimed by another process - discovery takes over */
+    if (0 != TableGetClient(table, client->slot, &current) ||
+        current.generation != client->registration.generation)
+    {
+        return SUCCESS;
+    }
+
+    beats = TableBeats(table, client->slot);
+    if (beats != client->seen_beats)
+    {
+        client->seen_beats = beats;
+        client->misses = 0;
+        return CONTINUE;
+    }
+
+    ++client->misses;
+    if (client->misses < client->registration.tolerance)
+    {
+        return CONTINUE;
+    }
+
+    ReviveClient(client);
+
+    return SUCCESS;
+}
+
+static void ForgetClient(void* args)
+{
+    client_t* client = (client_t*)args;
+
+    free(client->cmdline);
+    free(client->env);
+    free(client->cwd);
+    client->cmdline = NULL;
+    client->env = NULL;
+    client->cwd = NULL;
+    watched[client->slot / WORD_BITS] &= ~((uint64_t)1 << (client->slot % WORD_BITS));
+}
+
+/* the revived process claims a new slot from its own WDStart */
+static void ReviveClient(client_t* client)
+{
+    char** client_argv = NULL;
+    char** client_env = NULL;
+    pid_t pid = 0;
+
+    printf("[Daemon] Client (PID: %d, slot: %d) is unresponsive. Restarting...\n",
+           client->registration.pid, client->slot);
+
+    kill(client->registration.pid, SIGKILL);
+    TableRelease(table, client->slot, client->registration.generation);
+
+    if (NULL == client->cmdline || NULL == client->env || NULL == client->cwd)
+    {
+        fprintf(stderr, "[Daemon] No command line of PID %d, not restarted\n", client->registration.pid);
+        return;
+    }
+
+    pid = fork();
+    if (0 == pid)
+    {
+        /* an ignored SIGCHLD survives exec */
+        signal(SIGCHLD, SIG_DFL);
+        client_argv = SplitNulls(client->cmdline, client->cmdline_len);
+        client_env = SplitNulls(client->env, client->env_len);
+        if (NULL != client_argv && NULL != client_env && 0 == chdir(client->cwd))
+        {
+            execvpe(client_argv[0], client_argv, client_env);
+        }
+        _exit(EXEC_FAILED_STATUS);
+    }
+    else if (pid < 0)
+    {
+        fprintf(stderr, "[Daemon] Failed to restart PID %d\n", client->registration.pid);
+    }
+}
+
+static char* ReadProcFile(pid_t pid, const char* file, size_t* length)
+{
+    char path[PROC_PATH_LEN];
+    size_t capacity = READ_CHUNK;
+    char* buffer = NULL;
+    char* grown = NULL;
+    ssize_t bytes = 0;
+    int fd = -1;
+
+    sprintf(path, "/proc/%d/%s", pid, file);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    buffer = (char*)malloc(capacity + 1);
+    if (-1 == fd || NULL == buffer)
+    {
+        free(buffer);
+        if (-1 != fd)
+        {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    *length = 0;
+    while ((bytes = read(fd, buffer + *length, capacity - *length)) > 0)
+    {
+        *length += (size_t)bytes;
+        if (*length == capacity)
+        {
+            capacity *= 2;
+            grown = (char*)realloc(buffer, capacity + 1);
+            if (NULL == grown)
+            {
+                bytes = -1;
+                break;
+            }
+            buffer = grown;
+        }
+    }
+
+    close(fd);
+    if (bytes < 0 || 0 == *length)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    /* the last string may miss its terminator - kept for every client, so trimmed */
+    buffer[*length] = '\0';
+    grown = (char*)realloc(buffer, *length + 1);
+
+    return (NULL == grown) ? buffer : grown;
+}
+
+/* NULL terminated array of the NUL separated strings in buffer */
+static char** SplitNulls(char* buffer, size_t length)
+{
+    char** strings = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    for (i = 0; i < length; ++i)
+    {
+        count += ('\0' == buffer[i]);
+    }
+
+    strings = (char**)malloc((count + 2) * sizeof(char*));
+    if (NULL == strings)
+    {
+        return NULL;
+    }
+
+    count = 0;
+    for (i = 0; i < length; i += strlen(buffer + i) + 1)
+    {
+        strings[count++] = buffer + i;
+    }
+    strings[count] = NULL;
+
+    return strings;
+}
+
+static void HandleStop(int sig)
+{
+    (void)sig;
+    is_stopping = TRUE;
+}
@@ -0,0 +1,174 @@
+#define _GNU_SOURCE
+#include <stdio.h>      /* printf, fprintf, fopen, fdopen */
+#include <stdlib.h>     /* atoi, getenv */
+#include <string.h>     /* strcmp, strlen, strcpy */
+#include <signal.h>     /* sigaction, SIGTERM, SIGINT, SIGPIPE */
+#include <unistd.h>     /* unlink, close */
+#include <time.h>       /* nanosleep */
+#include <sys/socket.h> /* socket, bind, listen, accept */
+#include <sys/un.h>     /* struct sockaddr_un */
+
+#include "wd_common.h"  /* shared objects API */
+#include "wd_metrics.h" /* metrics page API */
+
+#define DEFAULT_PERIOD_SEC (10)
+#define LISTEN_BACKLOG (8)
+#define PATH_LEN (256)
+
+/* Prometheus text of a watchdog pair's metrics page, read from outside the
+   pair - a scrape never runs on the watchdog's own threads.
+   usage: ./wd_exporter.out [page]                      print once
+          ./wd_exporter.out page file <path> [seconds]  rewrite path every period
+          ./wd_exporter.out page socket <path>          serve every connection on a unix socket
+   page defaults to WD_METRICS_ENV */
+
+static volatile sig_atomic_t is_stopping = FALSE;
+
+static int ExportToFile(const metrics_t* metrics, const char* path, int period_sec);
+static int ExportToSocket(const metrics_t* metrics, const char* path);
+static void HandleStop(int sig);
+
+int main(int argc, char** argv)
+{
+    const char* name = (argc > 1) ? argv[1] : getenv(METRICS_ENV);
+    const char* mode = (argc > 2) ? argv[2] : NULL;
+    metrics_t* metrics = NULL;
+    struct sigaction stop = {0};
+    int status = 0;
+
+    if (NULL == name || (NULL != mode && argc < 4))
+    {
+        fprintf(stderr, "usage: %s page [file <path> [seconds] | socket <path>]\n", argv[0]);
+        return 1;
+    }
+
+    metrics = MetricsOpen(name, FALSE);
+    if (NULL == metrics)
+    {
+        fprintf(stderr, "[Exporter] No metrics page %s\n", name);
+        return 1;
+    }
+
+    /* no SA_RESTART - a stop breaks the sleep or the accept */
+    stop.sa_handler = HandleStop;
+    sigaction(SIGTERM, &stop, NULL);
+    sigaction(SIGINT, &stop, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (NULL == mode)
+    {
+        status = MetricsPrint(metrics, stdout);
+    }
+    else if (0 == strcmp(mode, "file"))
+    {
+        status = ExportToFile(metrics, argv[3], (argc > 4) ? atoi(argv[4]) : DEFAULT_PERIOD_SEC);
+    }
+    else if (0 == strcmp(mode, "socket"))
+    {
+        status = ExportToSocket(metrics, argv[3]);
+    }
+    else
+    {
+        fprintf(stderr, "[Exporter] Unknown mode %s\n", mode);
+        status = FAIL;
+    }
+
+    MetricsClose(metrics, NULL);
+
+    return (SUCCESS == status) ? 0 : 1;
+}
+
+/* written aside and renamed - a collector never reads half a file */
+static int ExportToFile(const metrics_t* metrics, const char* path, int period_sec)
+{
+    struct timespec period = {(0 < period_sec) ? period_sec : DEFAULT_PERIOD_SEC, 0};
+    char temp_path[PATH_LEN];
+    FILE* file = NULL;
+    int status = SUCCESS;
+
+    if (strlen(path) + sizeof(".tmp") > sizeof(temp_path))
+    {
+        return FAIL;
+    }
+    sprintf(temp_path, "%s.tmp", path);
+
+    while (!is_stopping && SUCCESS == status)
+    {
+        file = fopen(temp_path, "w");
+        status = (NULL == file) ? FAIL : MetricsPrint(metrics, file);
+        if (NULL != file && (0 != fclose(file) || SUCCESS != status || 0 != rename(temp_path, path)))
+        {
+            status = FAIL;
+        }
+
+        nanosleep(&period, NULL);
+    }
+
+    if (SUCCESS != status)
+    {
+        fprintf(stderr, "[Exporter] Failed to write %s\n", path);
+    }
+
+    return status;
+}
+
+static int ExportToSocket(const metrics_t* metrics, const char* path)
+{
+    struct sockaddr_un address = {0};
+    FILE* scrape = NULL;
+    int server = -1;
+    int client = -1;
+
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return FAIL;
+    }
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(path);
+    if (-1 == server || 0 != bind(server, (struct sockaddr*)&address, sizeof(address)) ||
+        0 != listen(server, LISTEN_BACKLOG))
+    {
+        fprintf(stderr, "[Exporter] Failed to listen on %s\n", path);
+        if (-1 != server)
+        {
+            close(server);
+        }
+        return FAIL;
+    }
+
+    printf("[Exporter] Serving metrics on %s\n", path);
+    fflush(stdout);
+
+    /* one scrape per connection: the text, then the socket is closed */
+    while (!is_stopping)
+    {
+        client = accept4(server, NULL, NULL, SOCK_CLOEXEC);
+        if (-1 == client)
+        {
+            continue;
+        }
+
+        scrape = fdopen(client, "w");
+        if (NULL == scrape)
+        {
+            close(client);
+            continue;
+        }
+        MetricsPrint(metrics, scrape);
+        fclose(scrape);
+    }
+
+    close(server);
+    unlink(path);
+
+    return SUCCESS;
+}
+
+static void HandleStop(int sig)
+{
+    (void)sig;
+    is_stopping = TRUE;
+}
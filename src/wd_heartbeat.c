@@ -0,0 +1,146 @@
+#define _GNU_SOURCE
+#include <stdatomic.h>   /* atomic_fetch_add, atomic_load */
+#include <fcntl.h>       /* O_CREAT, O_RDWR */
+#include <unistd.h>      /* ftruncate, close, syscall */
+#include <time.h>        /* clock_gettime */
+#include <sys/mman.h>    /* shm_open, mmap */
+#include <sys/stat.h>    /* S_IRUSR, S_IWUSR */
+#include <sys/syscall.h> /* SYS_futex */
+#include <linux/futex.h> /* FUTEX_WAIT, FUTEX_WAKE */
+
+#include "wd_heartbeat.h" /* API */
+
+#define NSEC_PER_SEC (1000000000L)
+#define CACHE_LINE (64)
+#define SIDES (2)
+
+/* one cache line per side - each process only writes its own */
+typedef struct heartbeat_counter
+{
+    _Alignas(CACHE_LINE) _Atomic uint32_t beats; /* futex word, wraps */
+    _Atomic uint32_t waiters;                     /* peers parked on beats */
+    _Atomic uint64_t last_ns;
+} heartbeat_counter_t;
+
+struct heartbeat
+{
+    heartbeat_counter_t sides[SIDES];
+};
+
+static uint64_t NowNs(void);
+
+heartbeat_t* HeartbeatOpen(const char* name, int is_owner)
+{
+    heartbeat_t* heartbeat = NULL;
+    int fd = -1;
+
+    if (is_owner)
+    {
+        /* a region left by a crashed owner must not leak its counters */
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+        if (-1 != fd && 0 != ftruncate(fd, sizeof(heartbeat_t)))
+        {
+            close(fd);
+            shm_unlink(name);
+            return NULL;
+        }
+    }
+    else
+    {
+        fd = shm_open(name, O_RDWR, 0);
+    }
+
+    if (-1 == fd)
+    {
+        return NULL;
+    }
+
+    heartbeat = (heartbeat_t*)mmap(NULL, sizeof(heartbeat_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return (MAP_FAILED == heartbeat) ? NULL : heartbeat;
+}
+
+void HeartbeatClose(heartbeat_t* heartbeat, const char* name)
+{
+    munmap(heartbeat, sizeof(heartbeat_t));
+    if (NULL != name)
+    {
+        shm_unlink(name);
+    }
+}
+
+void HeartbeatBeat(heartbeat_t* heartbeat, heartbeat_side_t side)
+{
+    heartbeat_counter_t* counter = &heartbeat->sides[side];
+
+    atomic_store_explicit(&counter->last_ns, NowNs(), memory_order_relaxed);
+    atomic_fetch_add(&counter->beats, 1);
+
+    /* ordered after the increment - a peer that parks later sees the new count */
+    if (0 != atomic_load(&counter->waiters))
+    {
+        syscall(SYS_futex, &counter->beats, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+    }
+}
+
+void HeartbeatWake(heartbeat_t* heartbeat, heartbeat_side_t side)
+{
+    heartbeat_counter_t* counter = &heartbeat->sides[side];
+
+    /* last_ns is left alone - it only ever dates a real beat */
+    atomic_fetch_add(&counter->beats, 1);
+    syscall(SYS_futex, &counter->beats, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+int HeartbeatWait(heartbeat_t* heartbeat, heartbeat_side_t side, uint32_t* seen, size_t interval_sec)
+{
+    return HeartbeatWaitUntil(heartbeat, side, seen, NowNs() + (uint64_t)interval_sec * NSEC_PER_SEC);
+}
+
+int HeartbeatWaitUntil(heartbeat_t* heartbeat, heartbeat_side_t side, uint32_t* seen, uint64_t deadline)
+{
+    heartbeat_counter_t* counter = &heartbeat->sides[side];
+    struct timespec remaining = {0};
+    uint32_t beats = 0;
+    uint64_t now = 0;
+
+    while (1)
+    {
+        beats = atomic_load(&counter->beats);
+        if (beats != *seen)
+        {
+            *seen = beats;
+            return 1;
+        }
+
+        now = NowNs();
+        if (now >= deadline)
+        {
+            return 0;
+        }
+
+        remaining.tv_sec = (time_t)((deadline - now) / NSEC_PER_SEC);
+        remaining.tv_nsec = (long)((deadline - now) % NSEC_PER_SEC);
+
+        /* returns at once (EAGAIN) if a beat landed since the load above */
+        atomic_fetch_add(&counter->waiters, 1);
+        syscall(SYS_futex, &counter->beats, FUTEX_WAIT, beats, &remaining, NULL, 0);
+        atomic_fetch_sub(&counter->waiters, 1);
+    }
+}
+
+uint64_t HeartbeatLastNs(const heartbeat_t* heartbeat, heartbeat_side_t side)
+{
+    return atomic_load_explicit(&heartbeat->sides[side].last_ns, memory_order_relaxed);
+}
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
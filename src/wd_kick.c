@@ -0,0 +1,135 @@
+#define _GNU_SOURCE
+#include <stdatomic.h>   /* atomic_store_explicit, atomic_compare_exchange_strong */
+#include <string.h>      /* strncpy, memcpy */
+#include <fcntl.h>       /* O_CREAT, O_RDWR */
+#include <unistd.h>      /* ftruncate, close, syscall */
+#include <sys/mman.h>    /* shm_open, mmap */
+#include <sys/stat.h>    /* S_IRUSR, S_IWUSR */
+#include <sys/syscall.h> /* SYS_gettid */
+
+#include "wd_kick.h" /* API */
+
+#define CACHE_LINE (64)
+
+typedef enum slot_state
+{
+    SLOT_FREE = 0,
+    SLOT_CLAIMING,
+    SLOT_USED
+} slot_state_t;
+
+/* kicks is written by the owning thread only - nothing else on its line changes after the claim */
+struct kick_slot
+{
+    _Alignas(CACHE_LINE) _Atomic uint64_t kicks;
+    _Atomic uint32_t state;
+    _Atomic uint64_t generation;
+    uint64_t deadline_ns;
+    int tid;
+    char name[KICK_NAME_LEN];
+};
+
+struct kick_table
+{
+    kick_slot_t slots[KICK_SLOTS];
+};
+
+kick_table_t* KickOpen(const char* name, int is_owner)
+{
+    kick_table_t* table = NULL;
+    int fd = -1;
+
+    if (is_owner)
+    {
+        /* a restarted process registers its threads again */
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+        if (-1 != fd && 0 != ftruncate(fd, sizeof(kick_table_t)))
+        {
+            close(fd);
+            shm_unlink(name);
+            return NULL;
+        }
+    }
+    else
+    {
+        fd = shm_open(name, O_RDWR, 0);
+    }
+
+    if (-1 == fd)
+    {
+        return NULL;
+    }
+
+    table = (kick_table_t*)mmap(NULL, sizeof(kick_table_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return (MAP_FAILED == table) ? NULL : table;
+}
+
+void KickClose(kick_table_t* table, const char* name)
+{
+    munmap(table, sizeof(kick_table_t));
+    if (NULL != name)
+    {
+        shm_unlink(name);
+    }
+}
+
+kick_slot_t* KickClaim(kick_table_t* table, const char* name, uint64_t deadline_ns)
+{
+    kick_slot_t* slot = NULL;
+    uint32_t expected = SLOT_FREE;
+    int i = 0;
+
+    for (i = 0; i < KICK_SLOTS; ++i)
+    {
+        slot = &table->slots[i];
+        expected = SLOT_FREE;
+        if (atomic_compare_exchange_strong(&slot->state, &expected, SLOT_CLAIMING))
+        {
+            slot->deadline_ns = deadline_ns;
+            slot->tid = (int)syscall(SYS_gettid);
+            strncpy(slot->name, (NULL != name) ? name : "", KICK_NAME_LEN - 1);
+            slot->name[KICK_NAME_LEN - 1] = '\0';
+            atomic_store_explicit(&slot->kicks, 0, memory_order_relaxed);
+            atomic_fetch_add(&slot->generation, 1);
+
+            /* the watchdog reads the fields above only once it sees SLOT_USED */
+            atomic_store_explicit(&slot->state, SLOT_USED, memory_order_release);
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+void KickRelease(kick_slot_t* slot)
+{
+    atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_release);
+}
+
+void Kick(kick_slot_t* slot)
+{
+    /* a single writer - a load and a store, no locked instruction */
+    atomic_store_explicit(&slot->kicks, atomic_load_explicit(&slot->kicks, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+int KickScan(const kick_table_t* table, int index, kick_state_t* state)
+{
+    kick_slot_t* slot = (kick_slot_t*)&table->slots[index];
+
+    if (SLOT_USED != atomic_load_explicit(&slot->state, memory_order_acquire))
+    {
+        return 0;
+    }
+
+    state->generation = atomic_load(&slot->generation);
+    state->kicks = atomic_load_explicit(&slot->kicks, memory_order_relaxed);
+    state->deadline_ns = slot->deadline_ns;
+    state->tid = slot->tid;
+    memcpy(state->name, slot->name, KICK_NAME_LEN);
+
+    return 1;
+}
@@ -0,0 +1,284 @@
+#define _GNU_SOURCE
+#include <stdio.h>       /* snprintf */
+#include <stdlib.h>      /* realloc */
+#include <string.h>      /* memcmp, memcpy */
+#include <stdatomic.h>   /* atomic_fetch_add_explicit, atomic_thread_fence */
+#include <fcntl.h>       /* open, O_CREAT, O_EXCL */
+#include <unistd.h>      /* ftruncate, close, syscall */
+#include <time.h>        /* clock_gettime */
+#include <sys/mman.h>    /* mmap */
+#include <sys/stat.h>    /* fstat, S_IRUSR, S_IWUSR */
+#include <sys/syscall.h> /* SYS_gettid */
+
+#include "wd_log.h" /* API */
+
+#define NSEC_PER_SEC (1000000000L)
+#define LOG_MAGIC "WDLOG\0\0\0"
+#define LOG_VERSION (1)
+#define LOG_RINGS (16)    /* threads of a process that get a ring */
+#define LOG_RECORDS (512) /* per ring, a power of 2 */
+#define PATH_LEN (256)
+
+/* seq is index + 1 once the record is complete, 0 while it is written */
+typedef struct log_record
+{
+    _Atomic uint64_t seq;
+    uint64_t time_ns;
+    int64_t args[2];
+    uint16_t event;
+    uint8_t level;
+} log_record_t;
+
+/* written by one thread, and by signal handlers interrupting it - an index
+   is taken with an atomic add, so a nested write gets the next one */
+typedef struct log_ring
+{
+    _Atomic uint64_t head;
+    _Atomic int32_t tid;
+    log_record_t records[LOG_RECORDS];
+} log_ring_t;
+
+typedef struct log_file
+{
+    char magic[8];
+    uint32_t version;
+    int32_t pid;
+    int32_t is_watchdog;
+    _Atomic uint32_t rings_taken;
+    _Atomic uint64_t dropped; /* records of threads without a ring */
+    log_ring_t rings[LOG_RINGS];
+} log_file_t;
+
+int log_level_g = LOG_OFF;
+
+static log_file_t* log_file = NULL;
+static __thread log_ring_t* thread_ring = NULL;
+
+static const char* formats[LOG_EVENTS] = {
+    "Sending heartbeat",
+    "Sending ping signal (PID: %ld)",
+    "Starting ping response check (Interval: %ld, Tolerance: %ld)",
+    "Received ping response",
+    "No response. Remaining tolerance: %ld",
+    "Peer exited",
+    "Peer is unresponsive. Stopping scheduler...",
+    "Received stop signal (%ld). Cleaning up resources...",
+    "Peer suspected after %ld ms without a beat (phi threshold %ld/1000)",
+    "Thread %ld made no progress for %ld ms"
+};
+
+static log_ring_t* TakeRing(void);
+
+int LogOpen(const char* prefix, int is_watchdog, log_level_t level)
+{
+    char path[PATH_LEN];
+    struct timespec now = {0};
+    log_file_t* file = NULL;
+    int fd = -1;
+
+    if (NULL != log_file)
+    {
+        return 0;
+    }
+
+    /* an exec'd process may get the pid of the one before - the start time keeps both logs */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (PATH_LEN <= snprintf(path, PATH_LEN, "%s.%d.%lu", prefix, getpid(),
+                             (unsigned long)now.tv_sec * NSEC_PER_SEC + now.tv_nsec))
+    {
+        return -1;
+    }
+
+    fd = open(path, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (-1 == fd)
+    {
+        return -1;
+    }
+
+    if (0 != ftruncate(fd, sizeof(log_file_t)))
+    {
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    file = (log_file_t*)mmap(NULL, sizeof(log_file_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == file)
+    {
+        unlink(path);
+        return -1;
+    }
+
+    file->version = LOG_VERSION;
+    file->pid = getpid();
+    file->is_watchdog = is_watchdog;
+    memcpy(file->magic, LOG_MAGIC, sizeof(file->magic));
+
+    log_file = file;
+    log_level_g = level;
+
+    return 0;
+}
+
+void LogWrite(log_level_t level, log_event_t event, int64_t arg0, int64_t arg1)
+{
+    log_ring_t* ring = thread_ring;
+    log_record_t* record = NULL;
+    struct timespec now = {0};
+    uint64_t index = 0;
+
+    if (NULL == ring)
+    {
+        ring = TakeRing();
+        if (NULL == ring)
+        {
+            return;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    index = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    record = &ring->records[index & (LOG_RECORDS - 1)];
+
+    /* a reader never takes a half written record for the one overwritten */
+    atomic_store_explicit(&record->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    record->time_ns = (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->event = (uint16_t)event;
+    record->level = (uint8_t)level;
+
+    atomic_store_explicit(&record->seq, index + 1, memory_order_release);
+}
+
+int LogRead(const char* path, log_entry_t** entries, size_t* count, uint64_t* lost)
+{
+    const log_file_t* file = NULL;
+    const log_ring_t* ring = NULL;
+    const log_record_t* record = NULL;
+    log_entry_t* grown = NULL;
+    log_entry_t entry = {0};
+    struct stat info = {0};
+    uint64_t head = 0;
+    uint64_t index = 0;
+    uint32_t rings = 0;
+    uint32_t i = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (-1 == fd)
+    {
+        return -1;
+    }
+
+    if (0 != fstat(fd, &info) || (size_t)info.st_size != sizeof(log_file_t))
+    {
+        close(fd);
+        return -1;
+    }
+
+    file = (const log_file_t*)mmap(NULL, sizeof(log_file_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == file)
+    {
+        return -1;
+    }
+
+    if (0 != memcmp(file->magic, LOG_MAGIC, sizeof(file->magic)) || LOG_VERSION != file->version)
+    {
+        munmap((void*)file, sizeof(log_file_t));
+        return -1;
+    }
+
+    entry.pid = file->pid;
+    entry.is_watchdog = file->is_watchdog;
+    *lost = atomic_load(&file->dropped);
+
+    rings = atomic_load(&file->rings_taken);
+    rings = (rings < LOG_RINGS) ? rings : LOG_RINGS;
+
+    for (i = 0; i < rings; ++i)
+    {
+        ring = &file->rings[i];
+        head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        entry.tid = atomic_load(&ring->tid);
+
+        index = (head > LOG_RECORDS) ? head - LOG_RECORDS : 0;
+        *lost += index;
+
+        if (head == index)
+        {
+            continue;
+        }
+
+        grown = (log_entry_t*)realloc(*entries, (*count + (head - index)) * sizeof(log_entry_t));
+        if (NULL == grown)
+        {
+            munmap((void*)file, sizeof(log_file_t));
+            return -1;
+        }
+        *entries = grown;
+
+        for (; index < head; ++index)
+        {
+            record = &ring->records[index & (LOG_RECORDS - 1)];
+
+            /* the log of a live process - a record being written or rewritten is skipped */
+            if (index + 1 != atomic_load_explicit(&record->seq, memory_order_acquire))
+            {
+                ++*lost;
+                continue;
+            }
+
+            entry.time_ns = record->time_ns;
+            entry.args[0] = record->args[0];
+            entry.args[1] = record->args[1];
+            entry.event = (log_event_t)record->event;
+            entry.level = (log_level_t)record->level;
+
+            atomic_thread_fence(memory_order_acquire);
+            if (index + 1 != atomic_load_explicit(&record->seq, memory_order_relaxed) || LOG_EVENTS <= entry.event)
+            {
+                ++*lost;
+                continue;
+            }
+
+            (*entries)[(*count)++] = entry;
+        }
+    }
+
+    munmap((void*)file, sizeof(log_file_t));
+
+    return 0;
+}
+
+const char* LogFormat(log_event_t event)
+{
+    return (event < LOG_EVENTS) ? formats[event] : "Unknown event";
+}
+
+/* first write of the thread - also from a signal handler, so only atomics and a syscall */
+static log_ring_t* TakeRing(void)
+{
+    uint32_t taken = 0;
+
+    if (NULL == log_file)
+    {
+        return NULL;
+    }
+
+    taken = atomic_fetch_add(&log_file->rings_taken, 1);
+    if (LOG_RINGS <= taken)
+    {
+        atomic_fetch_add_explicit(&log_file->dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    thread_ring = &log_file->rings[taken];
+    atomic_store(&thread_ring->tid, (int32_t)syscall(SYS_gettid));
+
+    return thread_ring;
+}
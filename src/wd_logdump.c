@@ -0,0 +1,67 @@
+#include <stdio.h>  /* printf, fprintf */
+#include <stdlib.h> /* qsort, free */
+
+#include "wd_common.h" /* shared objects API */
+#include "wd_log.h"    /* flight log API */
+
+/* Text of watchdog flight logs, merged in time order - the monotonic stamps
+   of the user process and its watchdogs are on the same clock.
+   usage: ./wd_logdump.out <log file>...   (the files WD_LOG_ENV prefixes) */
+
+static const char* level_names[LOG_OFF] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+static int CompareTime(const void* a, const void* b);
+
+int main(int argc, char** argv)
+{
+    log_entry_t* entries = NULL;
+    log_entry_t* entry = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    uint64_t lost = 0;
+    int file = 0;
+    int status = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <log file>...\n", argv[0]);
+        return 1;
+    }
+
+    for (file = 1; file < argc; ++file)
+    {
+        if (SUCCESS != LogRead(argv[file], &entries, &count, &lost))
+        {
+            fprintf(stderr, "[Logdump] %s is not a watchdog log\n", argv[file]);
+            status = 1;
+        }
+        else if (0 != lost)
+        {
+            fprintf(stderr, "[Logdump] %s: %lu records overwritten or dropped\n", argv[file], lost);
+        }
+    }
+
+    qsort(entries, count, sizeof(log_entry_t), CompareTime);
+
+    for (i = 0; i < count; ++i)
+    {
+        entry = &entries[i];
+        printf("%lu.%09lu %-5s %d/%d [%s] ", entry->time_ns / 1000000000UL, entry->time_ns % 1000000000UL,
+               level_names[entry->level < LOG_OFF ? entry->level : LOG_ERROR], entry->pid, entry->tid,
+               entry->is_watchdog ? "Watchdog" : "User");
+        printf(LogFormat(entry->event), (long)entry->args[0], (long)entry->args[1]);
+        printf("\n");
+    }
+
+    free(entries);
+
+    return status;
+}
+
+static int CompareTime(const void* a, const void* b)
+{
+    uint64_t left = ((const log_entry_t*)a)->time_ns;
+    uint64_t right = ((const log_entry_t*)b)->time_ns;
+
+    return (left > right) - (left < right);
+}
@@ -0,0 +1,210 @@
+#define _GNU_SOURCE
+#include <stdatomic.h> /* atomic_fetch_add_explicit, atomic_exchange */
+#include <fcntl.h>     /* O_CREAT, O_RDWR, O_RDONLY */
+#include <unistd.h>    /* ftruncate, close */
+#include <time.h>      /* clock_gettime */
+#include <sys/mman.h>  /* shm_open, mmap */
+#include <sys/stat.h>  /* fstat, S_IRUSR, S_IWUSR */
+
+#include "wd_metrics.h" /* API */
+
+#define NSEC_PER_SEC (1000000000L)
+#define NSEC_PER_USEC (1000)
+#define CACHE_LINE (64)
+#define SIDES (2)
+#define METRICS_VERSION (2)
+
+/* written by one process at a time - the side it belongs to */
+typedef struct metrics_block
+{
+    _Alignas(CACHE_LINE) _Atomic uint64_t counters[METRICS_COUNTERS];
+    _Atomic uint64_t last_restart_ns;
+    _Atomic uint64_t restart_begin_ns; /* 0 when no restart is under way */
+    _Atomic uint64_t latency_buckets[METRICS_BUCKETS];
+    _Atomic uint64_t latency_sum_ns;
+} metrics_block_t;
+
+struct metrics
+{
+    _Atomic uint32_t version;
+    metrics_block_t sides[SIDES];
+};
+
+static const char* side_names[SIDES] = {"user", "watchdog"};
+
+static const char* counter_names[METRICS_COUNTERS] = {
+    "wd_pings_sent_total",
+    "wd_pings_received_total",
+    "wd_missed_windows_total",
+    "wd_restarts_total",
+    "wd_restart_seconds_total",
+    "wd_thread_stalls_total"
+};
+
+static const char* counter_help[METRICS_COUNTERS] = {
+    "Heartbeats sent by the side.",
+    "Check windows that saw a heartbeat of the peer.",
+    "Check windows that ended without a heartbeat of the peer.",
+    "Peers the side started again.",
+    "Time from a failed peer found to the new peer monitoring.",
+    "Registered threads of the user process found without a kick past their deadline."
+};
+
+static uint64_t NowNs(void);
+
+metrics_t* MetricsOpen(const char* name, int is_writer)
+{
+    metrics_t* metrics = NULL;
+    struct stat page = {0};
+    int fd = shm_open(name, is_writer ? O_CREAT | O_RDWR : O_RDONLY, S_IRUSR | S_IWUSR);
+
+    if (-1 == fd)
+    {
+        return NULL;
+    }
+
+    /* never truncated once sized - the counters of earlier processes stay */
+    if (0 != fstat(fd, &page) ||
+        ((size_t)page.st_size < sizeof(metrics_t) && (!is_writer || 0 != ftruncate(fd, sizeof(metrics_t)))))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    metrics = (metrics_t*)mmap(NULL, sizeof(metrics_t), is_writer ? PROT_READ | PROT_WRITE : PROT_READ,
+                               MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == metrics)
+    {
+        return NULL;
+    }
+
+    if (is_writer)
+    {
+        atomic_store(&metrics->version, METRICS_VERSION);
+    }
+    else if (METRICS_VERSION != atomic_load(&metrics->version))
+    {
+        munmap(metrics, sizeof(metrics_t));
+        return NULL;
+    }
+
+    return metrics;
+}
+
+void MetricsClose(metrics_t* metrics, const char* name)
+{
+    munmap(metrics, sizeof(metrics_t));
+    if (NULL != name)
+    {
+        shm_unlink(name);
+    }
+}
+
+void MetricsAdd(metrics_t* metrics, metrics_side_t side, metrics_counter_t counter, uint64_t value)
+{
+    atomic_fetch_add_explicit(&metrics->sides[side].counters[counter], value, memory_order_relaxed);
+}
+
+void MetricsObserveLatency(metrics_t* metrics, metrics_side_t side, uint64_t latency_ns)
+{
+    metrics_block_t* block = &metrics->sides[side];
+    uint64_t us = latency_ns / NSEC_PER_USEC;
+    int bucket = (us <= 1) ? 0 : 64 - __builtin_clzll(us - 1);
+
+    if (bucket >= METRICS_BUCKETS)
+    {
+        bucket = METRICS_BUCKETS - 1;
+    }
+
+    atomic_fetch_add_explicit(&block->latency_buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&block->latency_sum_ns, latency_ns, memory_order_relaxed);
+}
+
+void MetricsRestartBegin(metrics_t* metrics, metrics_side_t side)
+{
+    MetricsAdd(metrics, side, METRICS_RESTARTS, 1);
+    atomic_store_explicit(&metrics->sides[side].restart_begin_ns, NowNs(), memory_order_relaxed);
+}
+
+void MetricsRestartDone(metrics_t* metrics, metrics_side_t side)
+{
+    metrics_block_t* block = &metrics->sides[side];
+    uint64_t begin = atomic_exchange(&block->restart_begin_ns, 0);
+    uint64_t duration = 0;
+
+    if (0 != begin)
+    {
+        duration = NowNs() - begin;
+        atomic_store_explicit(&block->last_restart_ns, duration, memory_order_relaxed);
+        MetricsAdd(metrics, side, METRICS_RESTART_NS, duration);
+    }
+}
+
+int MetricsPrint(const metrics_t* metrics, FILE* out)
+{
+    const metrics_block_t* block = NULL;
+    uint64_t value = 0;
+    uint64_t cumulative = 0;
+    int counter = 0;
+    int side = 0;
+    int bucket = 0;
+
+    for (counter = 0; counter < METRICS_COUNTERS; ++counter)
+    {
+        fprintf(out, "# HELP %s %s\n# TYPE %s counter\n", counter_names[counter], counter_help[counter],
+                counter_names[counter]);
+        for (side = 0; side < SIDES; ++side)
+        {
+            value = atomic_load_explicit(&metrics->sides[side].counters[counter], memory_order_relaxed);
+            if (METRICS_RESTART_NS == counter)
+            {
+                fprintf(out, "%s{side=\"%s\"} %.9f\n", counter_names[counter], side_names[side],
+                        (double)value / NSEC_PER_SEC);
+            }
+            else
+            {
+                fprintf(out, "%s{side=\"%s\"} %lu\n", counter_names[counter], side_names[side], value);
+            }
+        }
+    }
+
+    fprintf(out, "# HELP wd_last_restart_seconds Duration of the latest restart by the side.\n"
+                 "# TYPE wd_last_restart_seconds gauge\n");
+    for (side = 0; side < SIDES; ++side)
+    {
+        value = atomic_load_explicit(&metrics->sides[side].last_restart_ns, memory_order_relaxed);
+        fprintf(out, "wd_last_restart_seconds{side=\"%s\"} %.9f\n", side_names[side], (double)value / NSEC_PER_SEC);
+    }
+
+    fprintf(out, "# HELP wd_heartbeat_latency_seconds Time from a heartbeat of the peer to the side noticing it.\n"
+                 "# TYPE wd_heartbeat_latency_seconds histogram\n");
+    for (side = 0; side < SIDES; ++side)
+    {
+        block = &metrics->sides[side];
+        cumulative = 0;
+        for (bucket = 0; bucket < METRICS_BUCKETS - 1; ++bucket)
+        {
+            cumulative += atomic_load_explicit(&block->latency_buckets[bucket], memory_order_relaxed);
+            fprintf(out, "wd_heartbeat_latency_seconds_bucket{side=\"%s\",le=\"%.6f\"} %lu\n", side_names[side],
+                    (double)(1UL << bucket) / (NSEC_PER_SEC / NSEC_PER_USEC), cumulative);
+        }
+        /* the count is the buckets as read here - consistent with them under concurrent updates */
+        cumulative += atomic_load_explicit(&block->latency_buckets[bucket], memory_order_relaxed);
+        fprintf(out, "wd_heartbeat_latency_seconds_bucket{side=\"%s\",le=\"+Inf\"} %lu\n", side_names[side], cumulative);
+        fprintf(out, "wd_heartbeat_latency_seconds_sum{side=\"%s\"} %.9f\n", side_names[side],
+                (double)atomic_load_explicit(&block->latency_sum_ns, memory_order_relaxed) / NSEC_PER_SEC);
+        fprintf(out, "wd_heartbeat_latency_seconds_count{side=\"%s\"} %lu\n", side_names[side], cumulative);
+    }
+
+    return ferror(out) ? -1 : 0;
+}
+
+static uint64_t NowNs(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * NSEC_PER_SEC + (uint64_t)now.tv_nsec;
+}
@@ -0,0 +1,133 @@
+#include <math.h>   /* erfc, log10, sqrt, M_SQRT1_2 */
+#include <string.h> /* memset */
+
+#include "wd_phi.h" /* API */
+
+#define MIN_STDDEV_PART (10) /* min stddev is 1/10 of the expected interval */
+#define SEARCH_STEPS (64)
+#define SEARCH_MAX_STDDEVS (40.0) /* erfc is 0 in doubles long before */
+
+static void AddSample(phi_detector_t* detector, uint64_t sample);
+static void Model(const phi_detector_t* detector, double* mean, double* stddev);
+static double PhiOf(double deviations);
+
+void PhiInit(phi_detector_t* detector, uint64_t expected_ns, uint64_t now_ns)
+{
+    memset(detector, 0, sizeof(phi_detector_t));
+    detector->min_stddev_ns = expected_ns / MIN_STDDEV_PART;
+    detector->last_ns = now_ns;
+
+    /* a first guess of mean expected_ns and stddev expected_ns / 4, replaced as beats come in */
+    AddSample(detector, expected_ns - expected_ns / 4);
+    AddSample(detector, expected_ns + expected_ns / 4);
+}
+
+void PhiArrival(phi_detector_t* detector, uint64_t arrival_ns, uint32_t beats)
+{
+    uint64_t gap = 0;
+    uint32_t i = 0;
+
+    if (arrival_ns <= detector->last_ns || 0 == beats)
+    {
+        return;
+    }
+
+    /* the start to the first beat is no interval of the peer */
+    if (0 != detector->arrivals++)
+    {
+        /* beats seen together share the gap since the previous arrival */
+        beats = (beats < PHI_WINDOW) ? beats : PHI_WINDOW;
+        gap = (arrival_ns - detector->last_ns) / beats;
+        for (i = 0; i < beats; ++i)
+        {
+            AddSample(detector, gap);
+        }
+    }
+
+    detector->last_ns = arrival_ns;
+}
+
+double Phi(const phi_detector_t* detector, uint64_t now_ns)
+{
+    double mean = 0;
+    double stddev = 0;
+    double silence = (now_ns > detector->last_ns) ? (double)(now_ns - detector->last_ns) : 0;
+
+    Model(detector, &mean, &stddev);
+
+    return PhiOf((silence - mean) / stddev);
+}
+
+uint64_t PhiSuspectAt(const phi_detector_t* detector, double threshold)
+{
+    double mean = 0;
+    double stddev = 0;
+    double low = -SEARCH_MAX_STDDEVS;
+    double high = SEARCH_MAX_STDDEVS;
+    double middle = 0;
+    double silence = 0;
+    int step = 0;
+
+    Model(detector, &mean, &stddev);
+
+    /* phi only grows with the silence - bisected in stddevs from the mean */
+    for (step = 0; step < SEARCH_STEPS; ++step)
+    {
+        middle = (low + high) / 2;
+        if (PhiOf(middle) < threshold)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    silence = mean + high * stddev;
+
+    return detector->last_ns + ((silence > 0) ? (uint64_t)silence : 0);
+}
+
+static void AddSample(phi_detector_t* detector, uint64_t sample)
+{
+    detector->samples[detector->next] = sample;
+    detector->next = (detector->next + 1) % PHI_WINDOW;
+    if (detector->count < PHI_WINDOW)
+    {
+        ++detector->count;
+    }
+}
+
+/* recomputed from the window - no drift of running sums */
+static void Model(const phi_detector_t* detector, double* mean, double* stddev)
+{
+    double sum = 0;
+    double squares = 0;
+    size_t i = 0;
+
+    for (i = 0; i < detector->count; ++i)
+    {
+        sum += (double)detector->samples[i];
+    }
+    *mean = sum / detector->count;
+
+    for (i = 0; i < detector->count; ++i)
+    {
+        squares += ((double)detector->samples[i] - *mean) * ((double)detector->samples[i] - *mean);
+    }
+    *stddev = sqrt(squares / detector->count);
+
+    if (*stddev < (double)detector->min_stddev_ns)
+    {
+        *stddev = (double)detector->min_stddev_ns;
+    }
+}
+
+/* -log10 of the normal tail beyond deviations stddevs */
+static double PhiOf(double deviations)
+{
+    double tail = 0.5 * erfc(deviations * M_SQRT1_2);
+
+    return (0 < tail) ? -log10(tail) : HUGE_VAL;
+}
@@ -0,0 +1,148 @@
+#define _GNU_SOURCE
+#include <stdatomic.h> /* atomic_fetch_add, atomic_compare_exchange_weak */
+#include <fcntl.h>     /* O_CREAT, O_RDWR */
+#include <unistd.h>    /* ftruncate, close */
+#include <sys/mman.h>  /* shm_open, mmap */
+#include <sys/stat.h>  /* S_IRUSR, S_IWUSR */
+
+#include "wd_table.h" /* API */
+
+#define CACHE_LINE (64)
+#define WORD_BITS (64)
+
+/* one cache line per client - a beat never bounces another client's line */
+typedef struct table_slot
+{
+    _Alignas(CACHE_LINE) _Atomic uint32_t beats;
+    _Atomic uint32_t generation; /* odd while claimed */
+    _Atomic pid_t pid;
+    _Atomic unsigned int tolerance;
+    _Atomic uint64_t interval_ns;
+} table_slot_t;
+
+struct table
+{
+    _Atomic uint64_t claimed[TABLE_WORDS];
+    table_slot_t slots[TABLE_CAPACITY];
+};
+
+table_t* TableOpen(const char* name, int is_owner)
+{
+    table_t* table = NULL;
+    int fd = -1;
+
+    if (is_owner)
+    {
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_RDWR, S_IRUSR | S_IWUSR);
+        if (-1 != fd && 0 != ftruncate(fd, sizeof(table_t)))
+        {
+            close(fd);
+            shm_unlink(name);
+            return NULL;
+        }
+    }
+    else
+    {
+        fd = shm_open(name, O_RDWR, 0);
+    }
+
+    if (-1 == fd)
+    {
+        return NULL;
+    }
+
+    table = (table_t*)mmap(NULL, sizeof(table_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return (MAP_FAILED == table) ? NULL : table;
+}
+
+void TableClose(table_t* table, const char* name)
+{
+    munmap(table, sizeof(table_t));
+    if (NULL != name)
+    {
+        shm_unlink(name);
+    }
+}
+
+int TableClaim(table_t* table, pid_t pid, uint64_t interval_ns, unsigned int tolerance, uint32_t* generation)
+{
+    table_slot_t* slot = NULL;
+    uint64_t word = 0;
+    size_t i = 0;
+    int bit = 0;
+
+    for (i = 0; i < TABLE_WORDS; ++i)
+    {
+        word = atomic_load(&table->claimed[i]);
+        while (UINT64_MAX != word)
+        {
+            bit = __builtin_ctzll(~word);
+            /* a failed exchange reloads word, another client may have taken the bit */
+            if (atomic_compare_exchange_weak(&table->claimed[i], &word, word | ((uint64_t)1 << bit)))
+            {
+                slot = &table->slots[i * WORD_BITS + bit];
+                atomic_store_explicit(&slot->pid, pid, memory_order_relaxed);
+                atomic_store_explicit(&slot->tolerance, tolerance, memory_order_relaxed);
+                atomic_store_explicit(&slot->interval_ns, interval_ns, memory_order_relaxed);
+                /* publishes the registration above */
+                *generation = atomic_fetch_add(&slot->generation, 1) + 1;
+
+                return (int)(i * WORD_BITS + bit);
+            }
+        }
+    }
+
+    return TABLE_NO_SLOT;
+}
+
+int TableRelease(table_t* table, int slot, uint32_t generation)
+{
+    /* the client and the daemon may both release the same claim */
+    if (!atomic_compare_exchange_strong(&table->slots[slot].generation, &generation, generation + 1))
+    {
+        return 1;
+    }
+
+    atomic_fetch_and(&table->claimed[slot / WORD_BITS], ~((uint64_t)1 << (slot % WORD_BITS)));
+
+    return 0;
+}
+
+void TableBeat(table_t* table, int slot)
+{
+    atomic_fetch_add_explicit(&table->slots[slot].beats, 1, memory_order_relaxed);
+}
+
+uint32_t TableBeats(const table_t* table, int slot)
+{
+    return atomic_load_explicit(&table->slots[slot].beats, memory_order_relaxed);
+}
+
+uint64_t TableClaimedWord(const table_t* table, size_t word)
+{
+    return atomic_load(&table->claimed[word]);
+}
+
+int TableGetClient(const table_t* table, int slot, table_client_t* client)
+{
+    const table_slot_t* entry = &table->slots[slot];
+    uint32_t generation = atomic_load(&entry->generation);
+
+    if (0 == (generation & 1))
+    {
+        return 1;
+    }
+
+    client->pid = atomic_load_explicit(&entry->pid, memory_order_relaxed);
+    client->tolerance = atomic_load_explicit(&entry->tolerance, memory_order_relaxed);
+    client->interval_ns = atomic_load_explicit(&entry->interval_ns, memory_order_relaxed);
+    client->generation = generation;
+
+    /* released and claimed again while reading - the fields may be mixed */
+    atomic_thread_fence(memory_order_acquire);
+
+    return (generation == atomic_load_explicit(&entry->generation, memory_order_relaxed)) ? 0 : 1;
+}
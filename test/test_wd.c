@@ -10,16 +10,22 @@ int FibonacciIterative(int elemnet_index);
 int main(int argc, const char** argv)
 {
     size_t i = 0;
-    WDStart(argc, argv, 1, 5);
+    char* interval = getenv("WD_INTERVAL");
+    char* tolerance = getenv("WD_TOLERANCE");
+
+    WDStart(argc, argv, (NULL != interval) ? atoi(interval) : 1, (NULL != tolerance) ? atoi(tolerance) : 5);
+    WDRegisterThread("main", 5000);
     printf("Start Critical Code:\n");
     
     for (i = 0; i < 15; i++)
     {
         sleep(2);
         printf("%d\n", FibonacciIterative(i));
+        WDKick();
     }
 
     printf("End Critical Code:\n");
+    WDUnregisterThread();
     WDStop();
     
     return 0;